@@ -1,4 +1,5 @@
 /// the code of the class is copied from: https://doc.qt.io/qt-6.2/qtwidgets-widgets-codeeditor-example.html
+#include <algorithm>
 #include <string>
 #include <sstream>
 #include <QPainter>
@@ -8,6 +9,7 @@
 #include <QApplication>
 #include <QToolTip>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QMimeData>
 #include <QFileInfo>
 #include <QImageReader>
@@ -24,13 +26,15 @@
 #include "CodeEditor.h"
 #include "widgets/LineNumberArea.h"
 #include "utils/STCSyntaxHighlighter.h"
+#include "utils/StcDocumentModel.h"
 #include "ui/cppcompilerdialog.h"
-#include "utils/DiffCalculation.h"
 #include "types/CodeBlock.h"
 #include "utils/FileEncodingHandler.h"
 #include "stcSyntaxPatterns.h"
 #include "StripCppComments/CommentStripper.h"
 #include "widgets/StcTablesCreator.h"
+#include "utils/HandlerTimings.h"
+#include "utils/Tracing.h"
 #include <QIcon>
 
 namespace
@@ -218,7 +222,8 @@ QString rtrim(const QString& str)
 
 
 CodeEditor::CodeEditor(QWidget *parent)
-    : QPlainTextEdit(parent), networkManager{new QNetworkAccessManager(this)}, lineNumberArea{new LineNumberArea(this)}, fileEncodingHandler{std::make_unique<FileEncodingHandler>()}
+    : QPlainTextEdit(parent), networkManager{new QNetworkAccessManager(this)}, lineNumberArea{new LineNumberArea(this)}, fileEncodingHandler{std::make_unique<FileEncodingHandler>()},
+    stcModel{new StcDocumentModel(document(), this)}
 {
     setAcceptDrops(true);
     setMouseTracking(true);
@@ -226,23 +231,32 @@ CodeEditor::CodeEditor(QWidget *parent)
 
     registerShortcuts();
 
+    progressiveLoadTimer.setInterval(0); // next batch as soon as pending events were processed
+
+    suggestionsPrefetchTimer.setSingleShot(true);
+    suggestionsPrefetchTimer.setInterval(500); // ms of cursor staying in place
+
     connectSignalsWithSlots();
 
 
     updateLineNumberAreaWidth(0);
     highlightCurrentLine();
 
+    lineDiff.clearOriginal(document());
+
     STCSyntaxHighlighter *highlighter = new STCSyntaxHighlighter(document()); // it does not leak
+    updateHighlightedViewport(); // the rest of document is highlighted in background
 }
 
 void CodeEditor::newEmptyFile()
 {
+    abortProgressiveLoad();
     clear();
     setFileName("");
 
     document()->setModified(false);
 
-    originalLines.clear();
+    lineDiff.clearOriginal(document());
     modifiedLines.clear();
 
     fileModificationTime = {};
@@ -251,6 +265,7 @@ void CodeEditor::newEmptyFile()
     currentLine = -1;
 
     codeBlocks = {};
+    unclosedCodeTag = {};
 
     fileEncodingHandler = std::make_unique<FileEncodingHandler>();
 
@@ -292,11 +307,16 @@ void CodeEditor::connectSignalsWithSlots()
     connect(&fileWatcher, &QFileSystemWatcher::fileChanged, this, &CodeEditor::fileChanged);
 
     connect(this, &CodeEditor::textChanged, this, [this]() {
+        if (isLoadingInProgress())
+            return;
         this->lastChangeTime = QDateTime::currentDateTime();
         updateDiffWithOriginal();
     });
     connect(this, &CodeEditor::cursorPositionChanged, this, &CodeEditor::onCursorPositionChanged);
-    connect(document(), &QTextDocument::contentsChange, this, &CodeEditor::onContentsChange);
+    connect(this, &CodeEditor::cursorPositionChanged, &suggestionsPrefetchTimer, qOverload<>(&QTimer::start));
+    connect(&progressiveLoadTimer, &QTimer::timeout, this, &CodeEditor::insertNextLoadBatch);
+    connect(&suggestionsPrefetchTimer, &QTimer::timeout, this, &CodeEditor::prefetchSpellingSuggestionsNearCursor);
+    connect(stcModel, &StcDocumentModel::contentsChange, this, &CodeEditor::onContentsChange);
 }
 
 int CodeEditor::lineNumberAreaWidth()
@@ -315,6 +335,11 @@ bool CodeEditor::noUnsavedChanges() const
         return false;
     }
 
+    if (isLoadingInProgress()) // the document is read only until loaded
+    {
+        return true;
+    }
+
     const auto currentlyVisibleText = toPlainText();
     if (getFileName().isEmpty())
     {
@@ -395,6 +420,10 @@ void CodeEditor::goToLineAndOffset(int lineNumber, int linePosition)
 
 void CodeEditor::onScrollChanged(int)
 {
+    updateHighlightedViewport();
+    if (!searchHighlightPositions.empty())
+        highlightCurrentLine(); // search highlights are only for the viewport
+
     const int total = blockCount();
     const int firstVisible = cursorForPosition(QPoint(0, 0)).block().blockNumber() + 1;
     const int lastVisible = cursorForPosition(QPoint(0, height() - 1)).block().blockNumber() + 1;
@@ -443,6 +472,23 @@ void CodeEditor::resizeEvent(QResizeEvent *e)
 
     QRect cr = contentsRect();
     lineNumberArea->setGeometry(QRect(cr.left(), cr.top(), lineNumberAreaWidth(), cr.height()));
+
+    updateHighlightedViewport();
+    if (!searchHighlightPositions.empty())
+        highlightCurrentLine();
+}
+
+void CodeEditor::updateHighlightedViewport()
+{
+    auto* highlighter = qobject_cast<STCSyntaxHighlighter*>(document()->findChild<QSyntaxHighlighter*>());
+    if (!highlighter)
+        return;
+
+    const int firstVisible = firstVisibleBlock().blockNumber();
+    const int lastVisible = cursorForPosition(QPoint(0, viewport()->height() - 1)).block().blockNumber();
+    const int margin = lastVisible - firstVisible + 1; // one screen above and below, so scrolling shows highlighted text at once
+
+    highlighter->setVisibleBlocks(firstVisible - margin, lastVisible + margin);
 }
 
 void CodeEditor::reloadFromFile(bool discardChanges)
@@ -452,31 +498,33 @@ void CodeEditor::reloadFromFile(bool discardChanges)
 
     if (loadFileContentDistargingCurrentContent(getFileName()))
     {
-        // restore cursor position
-        QTextCursor cursor = cursor4Line(currentLineBeforeReloading + 1); // +1 because lines are being counted from 1
-        cursor.movePosition(QTextCursor::Right, QTextCursor::MoveAnchor, currentColumnBeforeReloading);
-        setTextCursor(cursor);
-        ensureCursorVisible();
+        whenContentLoaded([this, currentLineBeforeReloading, currentColumnBeforeReloading]() {
+            // restore cursor position
+            QTextCursor cursor = cursor4Line(currentLineBeforeReloading + 1); // +1 because lines are being counted from 1
+            cursor.movePosition(QTextCursor::Right, QTextCursor::MoveAnchor, currentColumnBeforeReloading);
+            setTextCursor(cursor);
+            ensureCursorVisible();
+        });
     }
 }
 
 bool CodeEditor::loadFileContentDistargingCurrentContent(const QString& fileName)
 {
-    try
-    {
-        const auto fileContent = fileEncodingHandler->loadFile(fileName);
-        setPlainText(fileContent);
-
-        document()->setModified(false);
-
-        trackOriginalVersionOfFile(fileName);
+    TRACE_SCOPE("file", "CodeEditor::loadFileContentDistargingCurrentContent");
+    constexpr qint64 progressiveLoadMinFileSize = 512 * 1024; // bytes, smaller files are loaded in a blink anyway
 
-        setFileName(fileName);
+    abortProgressiveLoad();
 
-        analizeEntireDocumentDetectingCodeBlocks();
-
-        emit contentReloaded();
+    try
+    {
+        if (QFileInfo(fileName).size() < progressiveLoadMinFileSize)
+        {
+            loadFileContentStreaming(fileName);
+            finishLoading(fileName);
+            return true;
+        }
 
+        startProgressiveLoad(fileName, fileEncodingHandler->openForDecoding(fileName));
         return true;
     }
     catch (const std::exception& e)
@@ -488,6 +536,12 @@ bool CodeEditor::loadFileContentDistargingCurrentContent(const QString& fileName
 
 bool CodeEditor::saveEntireContent2File(const QString &fileName)
 {
+    TRACE_SCOPE("file", "CodeEditor::saveEntireContent2File");
+    while (isLoadingInProgress()) // the whole file has to be in the document before saving
+    {
+        insertNextLoadBatch();
+    }
+
     QFile outputFile(fileName);
     outputFile.open(QIODeviceBase::WriteOnly);
     setFileName(fileName);
@@ -500,9 +554,144 @@ bool CodeEditor::saveEntireContent2File(const QString &fileName)
     }
     return false;
 }
+void CodeEditor::loadFileContentStreaming(const QString& fileName)
+{
+    // the same as setPlainText(), but the decoded chunks go straight into the document without building a whole QString first
+    QTextDocument* doc = document();
+    QTextCursor cursor(doc);
+    bool cleared = false;
+    auto clearOnce = [&]() {
+        if (std::exchange(cleared, true))
+            return;
+        doc->setUndoRedoEnabled(false);
+        doc->clear();
+        cursor = QTextCursor(doc);
+        cursor.beginEditBlock(); // the document and its listeners see only one change
+    };
+
+    fileEncodingHandler->loadFile(fileName, [&](QStringView chunk) {
+        clearOnce();
+        cursor.insertText(chunk.toString());
+    });
+    clearOnce(); // empty file
+
+    cursor.endEditBlock();
+    doc->setUndoRedoEnabled(true);
+
+    moveCursor(QTextCursor::Start);
+}
+
+void CodeEditor::startProgressiveLoad(const QString& fileName, std::unique_ptr<IncrementalFileDecoder> decoder)
+{
+    QTextDocument* doc = document();
+    doc->setUndoRedoEnabled(false);
+    doc->clear();
+    setReadOnly(true); // the original version of file is known when everything is loaded, so no edits before
+
+    progressiveLoad = ProgressiveLoad{ .fileName = fileName, .decoder = std::move(decoder) };
+
+    insertNextLoadBatch(); // the first screens are visible at once
+    moveCursor(QTextCursor::Start);
+
+    if (isLoadingInProgress())
+        progressiveLoadTimer.start();
+}
+
+void CodeEditor::insertNextLoadBatch()
+{
+    TRACE_SCOPE("file", "CodeEditor::insertNextLoadBatch");
+    constexpr qsizetype maxBatchLength = 16 * 1024; // characters (and bytes decoded at once), cut at line end if possible
+    constexpr qint64 timeBudgetMs = 15; // the editor still reacts on scrolling and typing between batches
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QTextCursor cursor(document());
+    cursor.movePosition(QTextCursor::End);
+    cursor.beginEditBlock(); // highlighter and panels see one change per batch
+
+    auto& load = *progressiveLoad;
+    const auto everythingInserted = [&load] {
+        return load.decoder->atEnd() && load.decodedRest.isEmpty();
+    };
+    while (!everythingInserted() && timer.elapsed() < timeBudgetMs)
+    {
+        if (load.decodedRest.size() < maxBatchLength && !load.decoder->atEnd())
+            load.decodedRest += load.decoder->decodeNext(maxBatchLength);
+
+        const QStringView rest = load.decodedRest;
+        qsizetype length = std::min(maxBatchLength, rest.size());
+        if (length < rest.size() || !load.decoder->atEnd()) // more text follows the batch
+        {
+            if (const qsizetype lineEnd = rest.first(length).lastIndexOf(u'\n'); lineEnd >= 0)
+                length = lineEnd + 1;
+            else if (length > 0 && rest[length - 1] == u'\r') // a long line, but "\r\n" would become two line breaks
+                --length;
+        }
+
+        cursor.insertText(rest.first(length).toString());
+        load.decodedRest.remove(0, length);
+    }
+
+    cursor.endEditBlock();
+
+    if (!everythingInserted())
+    {
+        emit loadingProgress(static_cast<int>(100 * load.decoder->decodedBytes() / std::max<qsizetype>(1, load.decoder->size())));
+        return;
+    }
+
+    const QString fileName = load.fileName;
+    auto actionsWhenLoaded = std::move(load.actionsWhenLoaded);
+    abortProgressiveLoad();
+
+    finishLoading(fileName);
+    for (const auto& action : actionsWhenLoaded)
+    {
+        action();
+    }
+}
+
+void CodeEditor::abortProgressiveLoad()
+{
+    if (!isLoadingInProgress())
+        return;
+
+    progressiveLoadTimer.stop();
+    progressiveLoad.reset();
+
+    document()->setUndoRedoEnabled(true);
+    setReadOnly(false);
+    emit loadingProgress(100);
+}
+
+void CodeEditor::finishLoading(const QString& fileName)
+{
+    TRACE_SCOPE("file", "CodeEditor::finishLoading");
+    document()->setModified(false);
+
+    trackOriginalVersionOfFile(fileName);
+
+    setFileName(fileName);
+
+    analizeEntireDocumentDetectingCodeBlocks();
+
+    updateDiffWithOriginal();
+
+    emit contentReloaded();
+}
+
+void CodeEditor::whenContentLoaded(const std::function<void()>& action)
+{
+    if (isLoadingInProgress())
+        progressiveLoad->actionsWhenLoaded.push_back(action);
+    else
+        action();
+}
+
 void CodeEditor::trackOriginalVersionOfFile(const QString& fileName)
 {
-    originalLines = toPlainText().split('\n');
+    lineDiff.resetOriginal(document());
     modifiedLines.clear();
     fileModificationTime = QFileInfo(fileName).lastModified();
     lastChangeTime = QDateTime(); // reset
@@ -1746,7 +1935,7 @@ QTextCursor CodeEditor::cursor4Line(int lineNumber) const
 
 void CodeEditor::highlightCurrentLine()
 {
-    QList<QTextEdit::ExtraSelection> extraSelections = persistentSearchHighlights;
+    QList<QTextEdit::ExtraSelection> extraSelections = visibleSearchHighlights();
 
     if (!isReadOnly())
     {
@@ -1816,6 +2005,7 @@ void CodeEditor::lineNumberAreaPaintEvent(QPaintEvent *event)
 
 void CodeEditor::keyPressEvent(QKeyEvent* event)
 {
+    HANDLER_TIMING("CodeEditor::keyPressEvent"); // own time is mostly editing and layout done by QPlainTextEdit
     if (event->modifiers() & Qt::ControlModifier
         && event->modifiers() & Qt::ShiftModifier
         && event->key() == Qt::Key_V)
@@ -1922,9 +2112,12 @@ void CodeEditor::fetchAndInsertTitle(const QString& url, int insertedPos)
 {
     QUrl qurl(url);
     QNetworkRequest request(qurl);
+    [[maybe_unused]] const auto requestStart = Tracing::Clock::now();
     QNetworkReply* reply = networkManager->get(request);
 
     connect(reply, &QNetworkReply::finished, this, [=, this]() {
+        TRACE_ASYNC("network", "link title request", requestStart);
+        TRACE_SCOPE("network", "CodeEditor: link title reply");
         reply->deleteLater();
 
         QTextDocument* doc = this->document();
@@ -2382,9 +2575,12 @@ void CodeEditor::showWebLinkPreview(const QString& url, const QPoint& globalPos)
     QToolTip::showText(globalPos, "Loading preview…", this);
 
     QNetworkRequest request{QUrl(url)};
+    [[maybe_unused]] const auto requestStart = Tracing::Clock::now();
     QNetworkReply* reply = networkManager->get(request);
 
     connect(reply, &QNetworkReply::finished, this, [=, this]() {
+        TRACE_ASYNC("network", "web link preview request", requestStart);
+        TRACE_SCOPE("network", "CodeEditor: web link preview reply");
         reply->deleteLater();
 
         if (reply->error() != QNetworkReply::NoError) {
@@ -2444,31 +2640,25 @@ void CodeEditor::decreaseFontSize()
 
 std::optional<CodeBlock> CodeEditor::selectEnclosingCodeBlock(int cursorPos)
 {
-    if (auto codeInfo = getCodeTagAtPosition(cursorPos))
+    if (const CodeBlock* block = findCodeBlockAt(cursorPos))
     {
-        for (const auto& block : codeBlocks)
-        {
-            if (block.tag == codeInfo->tag && block.cursor.selectionStart() == codeInfo->position)
-            {
-                CodeBlock codeOnlyBlock = block;
+        CodeBlock codeOnlyBlock = *block;
 
-                QString blockText = block.cursor.selectedText();
+        QString blockText = block->cursor.selectedText();
 
-                // Detecting code by removing STC tags:
-                QRegularExpression tagPattern(QString("^\\[%1\\](.*)\\[\\/%1\\]$")
-                    .arg(QRegularExpression::escape(block.tag)));
+        // Detecting code by removing STC tags:
+        QRegularExpression tagPattern(QString("^\\[%1\\](.*)\\[\\/%1\\]$")
+            .arg(QRegularExpression::escape(block->tag)));
 
-                auto match = tagPattern.match(blockText);
-                if (match.hasMatch())
-                {
-                    QTextCursor codeCursor = block.cursor;
-                    codeCursor.setPosition(block.cursor.selectionStart() + match.capturedStart(1));
-                    codeCursor.setPosition(block.cursor.selectionStart() + match.capturedEnd(1), QTextCursor::KeepAnchor);
+        auto match = tagPattern.match(blockText);
+        if (match.hasMatch())
+        {
+            QTextCursor codeCursor = block->cursor;
+            codeCursor.setPosition(block->cursor.selectionStart() + match.capturedStart(1));
+            codeCursor.setPosition(block->cursor.selectionStart() + match.capturedEnd(1), QTextCursor::KeepAnchor);
 
-                    codeOnlyBlock.cursor = codeCursor;
-                    return codeOnlyBlock;
-                }
-            }
+            codeOnlyBlock.cursor = codeCursor;
+            return codeOnlyBlock;
         }
     }
 
@@ -2499,8 +2689,8 @@ void CodeEditor::wheelEvent(QWheelEvent* event)
 
 void CodeEditor::updateDiffWithOriginal()
 {
-    const QStringList currentLines = toPlainText().split('\n');
-    const QSet<int> newDiff = DiffCalculation::calculateModifiedLines(originalLines, currentLines);
+    HANDLER_TIMING("CodeEditor::updateDiffWithOriginal");
+    const QSet<int> newDiff = lineDiff.calculateModifiedLines(document());
 
     if (newDiff != modifiedLines)
     {
@@ -2521,7 +2711,7 @@ void CodeEditor::updateDiffWithOriginal()
 
 void CodeEditor::markAsSaved()
 {
-    originalLines = toPlainText().split('\n');
+    lineDiff.resetOriginal(document());
     modifiedLines.clear();
     lastChangeTime = {};
     fileModificationTime = QFileInfo(getFileName()).lastModified();
@@ -2636,11 +2826,42 @@ void CodeEditor::addSpellingSuggestionsIfAvailable(QMenu* menu, const QPoint& po
     if (!highlighter)
         return;
 
-    const QStringList suggestions = highlighter->getSpellChecker().getSuggestions(word);
+    SpellCheckService& spellCheckService = highlighter->getSpellCheckService();
+    QMenu* spellingMenu = menu->addMenu(QString::fromUtf8("📝") + tr("Spelling suggestions"));
+
+    if (auto suggestions = spellCheckService.cachedSuggestions(word))
+    {
+        fillSpellingSuggestionsMenu(spellingMenu, wordCursor, *suggestions);
+        return;
+    }
+
+    // Nuspell needs even a second for some words, the menu is shown at once and filled when suggestions are ready
+    spellingMenu->addAction(QString::fromUtf8("⏳") + tr("Looking for suggestions..."))->setEnabled(false);
+
+    connect(&spellCheckService, &SpellCheckService::suggestionsReady, spellingMenu,
+            [this, spellingMenu, word, wordCursor](const QString& readyWord, const QStringList& suggestions) {
+        if (readyWord != word)
+            return;
+
+        spellingMenu->clear();
+        fillSpellingSuggestionsMenu(spellingMenu, wordCursor, suggestions);
+    });
+    connect(spellingMenu, &QObject::destroyed, &spellCheckService, [this, &spellCheckService, word]() {
+        if (!prefetchedSuggestionsWords.contains(word))
+            spellCheckService.cancelSuggestions(word); // the menu was closed before suggestions were ready
+    });
+
+    spellCheckService.requestSuggestions(word);
+}
+
+void CodeEditor::fillSpellingSuggestionsMenu(QMenu* spellingMenu, const QTextCursor& wordCursor, const QStringList& suggestions)
+{
     if (suggestions.isEmpty())
+    {
+        spellingMenu->addAction(tr("No suggestions"))->setEnabled(false);
         return;
+    }
 
-    QMenu* spellingMenu = menu->addMenu(QString::fromUtf8("📝") + tr("Spelling suggestions"));
     for (const QString& suggestion : suggestions)
     {
         QAction* act = spellingMenu->addAction(suggestion);
@@ -2653,6 +2874,57 @@ void CodeEditor::addSpellingSuggestionsIfAvailable(QMenu* menu, const QPoint& po
     }
     spellingMenu->addSeparator();
 }
+
+void CodeEditor::prefetchSpellingSuggestionsNearCursor()
+{
+    constexpr int maxWordsToPrefetch = 3;
+
+    auto* highlighter = qobject_cast<STCSyntaxHighlighter*>(document()->findChild<QSyntaxHighlighter*>());
+    if (!highlighter)
+        return;
+    SpellCheckService& spellCheckService = highlighter->getSpellCheckService();
+
+    const QTextCursor cursor = textCursor();
+    const QString text = cursor.block().text();
+    const int posInBlock = cursor.positionInBlock();
+
+    QList<QPair<int, QString>> misspelledWords; // distance from the cursor, word
+    auto matches = stc::syntax::wordWithPolishCharactersRe.globalMatch(text);
+    while (matches.hasNext())
+    {
+        const QRegularExpressionMatch match = matches.next();
+        const QString word = match.captured();
+        if (spellCheckService.verdict(word) == SpellCheckService::Verdict::Misspelled) // only already checked words, no waiting here
+        {
+            const int start = match.capturedStart();
+            const int end = match.capturedEnd();
+            const int distance = std::max({ 0, start - posInBlock, posInBlock - end });
+            misspelledWords.append({ distance, word });
+        }
+    }
+    std::sort(misspelledWords.begin(), misspelledWords.end());
+
+    QStringList wordsToPrefetch;
+    for (const auto& [distance, word] : std::as_const(misspelledWords))
+    {
+        if (wordsToPrefetch.size() == maxWordsToPrefetch)
+            break;
+        if (!wordsToPrefetch.contains(word))
+            wordsToPrefetch.append(word);
+    }
+
+    for (const QString& word : std::as_const(prefetchedSuggestionsWords))
+    {
+        if (!wordsToPrefetch.contains(word))
+            spellCheckService.cancelSuggestions(word); // the cursor went away before the worker started
+    }
+    for (const QString& word : std::as_const(wordsToPrefetch))
+    {
+        spellCheckService.prefetchSuggestions(word);
+    }
+    prefetchedSuggestionsWords = wordsToPrefetch;
+}
+
 std::optional<QPair<QString, QTextCursor>> CodeEditor::getMisspelledWordAtPosition(const QPoint& pos)
 {
     QTextCursor cursor = cursorForPosition(pos);
@@ -2679,7 +2951,7 @@ std::optional<QPair<QString, QTextCursor>> CodeEditor::getMisspelledWordAtPositi
             if (!highlighter)
                 return std::nullopt;
 
-            if (!highlighter->getSpellChecker().isCorrect(word))
+            if (!highlighter->getSpellCheckService().isCorrect(word))
             {
                 return QPair<QString, QTextCursor>{ word, wordCursor };
             }
@@ -2695,78 +2967,145 @@ std::optional<QPair<QString, QTextCursor>> CodeEditor::getMisspelledWordAtPositi
 
 std::optional<CodeEditor::CodeBlockInfo> CodeEditor::getCodeTagAtPosition(int position) const
 {
-    for (const auto& block : codeBlocks)
+    if (const CodeBlock* block = findCodeBlockAt(position))
     {
-        if (position >= block.cursor.selectionStart() && position <= block.cursor.selectionEnd())
-        {
-            return CodeBlockInfo{block.tag, block.cursor.selectionStart()};
-        }
+        return CodeBlockInfo{block->tag, block->cursor.selectionStart()};
     }
     return std::nullopt;
 }
 
+const CodeBlock* CodeEditor::findCodeBlockAt(int position) const
+{
+    // code blocks do not overlap and cursors keep their order when the text is edited, so they are sorted all the time
+    auto after = std::upper_bound(codeBlocks.cbegin(), codeBlocks.cend(), position, [](int position, const CodeBlock& block) {
+        return position < block.cursor.selectionStart();
+    });
+    if (after == codeBlocks.cbegin())
+        return nullptr;
+
+    const CodeBlock& candidate = *std::prev(after);
+    return position <= candidate.cursor.selectionEnd() ? &candidate : nullptr;
+}
+
 void CodeEditor::analizeEntireDocumentDetectingCodeBlocks()
 {
     codeBlocks = parseAllCodeBlocks();
     emit codeBlocksChanged();
 }
 
-void CodeEditor::onContentsChange(int position, int charsRemoved, int charsAdded)
+void CodeEditor::updateCodeBlocksAfterChange(int position, int charsAdded)
 {
-    handleCodeBlockDetectionOnChange(position);
+    const int changeEnd = position + charsAdded;
+
+    // blocks ending before the change are paired the same way as before, so tags are paired again from the first one after them
+    auto firstAffected = std::lower_bound(codeBlocks.begin(), codeBlocks.end(), position, [](const CodeBlock& block, int position) {
+        return block.cursor.selectionEnd() < position;
+    });
+    const qsizetype firstAffectedIndex = firstAffected - codeBlocks.begin();
+
+    int scanFrom = position;
+    if (firstAffected != codeBlocks.end())
+        scanFrom = std::min(scanFrom, firstAffected->cursor.selectionStart());
+    if (!unclosedCodeTag.isNull())
+        scanFrom = std::min(scanFrom, unclosedCodeTag.position()); // the change may be inside of not closed code
+
+    // after the change the pairing goes as before as soon as a new block is the same as a known one
+    qsizetype resynchronizedIndex = -1;
+    QVector<CodeBlock> changedBlocks = parseCodeBlocks(scanFrom, [&](const CodeBlock& block) {
+        const int start = block.cursor.selectionStart();
+        if (start < changeEnd)
+            return false;
+
+        auto known = std::lower_bound(codeBlocks.cbegin() + firstAffectedIndex, codeBlocks.cend(), start, [](const CodeBlock& block, int start) {
+            return block.cursor.selectionStart() < start;
+        });
+        if (known == codeBlocks.cend() || known->cursor.selectionStart() != start || known->cursor.selectionEnd() != block.cursor.selectionEnd()
+            || known->tag != block.tag || known->language != block.language)
+        {
+            return false;
+        }
+
+        resynchronizedIndex = known - codeBlocks.cbegin();
+        return true;
+    });
+
+    if (resynchronizedIndex >= 0)
+        changedBlocks.append(codeBlocks.mid(resynchronizedIndex));
+
+    codeBlocks.resize(firstAffectedIndex);
+    codeBlocks.append(changedBlocks);
+    emit codeBlocksChanged();
 }
 
-void CodeEditor::handleCodeBlockDetectionOnChange(int position) // emit codeBlocksChanged
+void CodeEditor::onContentsChange(int position, int charsRemoved, int charsAdded)
 {
-    QTextBlock block = document()->findBlock(position);
-    if (!block.isValid())
-    {
-        analizeEntireDocumentDetectingCodeBlocks();
-        return;
-    }
+    HANDLER_TIMING("CodeEditor::onContentsChange");
+    shiftSearchHighlights(position, charsRemoved, charsAdded);
 
-    const QString line = block.text();
+    if (isLoadingInProgress()) // everything is analyzed once, when the file is loaded
+        return;
 
-    static const QRegularExpression openTagRe(R"(\[(cpp|code|py|log)(\s+src\s*=\s*"[^"]*")?\])", QRegularExpression::CaseInsensitiveOption);
-    static const QRegularExpression closeTagRe(R"(\[/\s*(cpp|code|py|log)\s*\])", QRegularExpression::CaseInsensitiveOption);
+    lineDiff.onContentsChange(document(), position, charsRemoved, charsAdded);
 
-    bool lineHasOpen = openTagRe.match(line).hasMatch();
-    bool lineHasClose = closeTagRe.match(line).hasMatch();
+    handleCodeBlockDetectionOnChange(position, charsAdded);
+}
 
-    if (lineHasOpen || lineHasClose)
+void CodeEditor::handleCodeBlockDetectionOnChange(int position, int charsAdded) // emit codeBlocksChanged
+{
+    if (stcModel->lastChangeTouchedCodeTags())
     {
-        analizeEntireDocumentDetectingCodeBlocks();
+        updateCodeBlocksAfterChange(position, charsAdded);
     }
-    else
+    else if (isInsideCode(position))
     {
-        if (isInsideCode(position))
-        {
-            emit codeBlocksChanged();
-        }
+        emit codeBlocksChanged();
     }
 }
 
 QVector<CodeBlock> CodeEditor::parseAllCodeBlocks()
+{
+    return parseCodeBlocks(0, [](const CodeBlock&) { return false; });
+}
+
+QVector<CodeBlock> CodeEditor::parseCodeBlocks(int fromPosition, const std::function<bool(const CodeBlock&)>& isAlreadyKnown)
 {
     QVector<CodeBlock> result;
-    QString text = toPlainText();
+    bool stopped = false;
 
-    QRegularExpression tagRe(R"__(\[(cpp|code|py|log)(\s+src\s*=\s*"([^"]*)")?\](.*?)\[/\s*\1\s*\])__",
-                             QRegularExpression::DotMatchesEverythingOption | QRegularExpression::CaseInsensitiveOption | QRegularExpression::MultilineOption);
+    std::optional<CodeBlock> openedBlock;
+    stcModel->forEachTagWhile([&](QStringView text, int blockPosition, const stc::TagToken& tag) {
+        const QStringView name = tag.name(text);
+        if (!stc::isCodeTag(name))
+            return true;
 
-    QRegularExpressionMatchIterator it = tagRe.globalMatch(text);
-    while (it.hasNext())
-    {
-        auto match = it.next();
-        QTextCursor c = textCursor();
-        c.setPosition(match.capturedStart(0));
-        c.setPosition(match.capturedEnd(0), QTextCursor::KeepAnchor);
+        if (!openedBlock)
+        {
+            const QStringView attributes = tag.attributes(text);
+            const auto language = stc::attributeValue(attributes, u"src");
+            if (tag.closing || (!attributes.trimmed().isEmpty() && !language))
+                return true;
+
+            QTextCursor c = textCursor();
+            c.setPosition(blockPosition + tag.start);
+            openedBlock = CodeBlock{ .cursor = c, .tag = name.toString().toLower(), .language = language.value_or(QStringView{}).toString().toLower() };
+        }
+        else if (tag.closing && name.compare(openedBlock->tag, Qt::CaseInsensitive) == 0)
+        {
+            openedBlock->cursor.setPosition(blockPosition + tag.end(), QTextCursor::KeepAnchor);
+            if (isAlreadyKnown(*openedBlock))
+            {
+                stopped = true;
+                return false;
+            }
+            result.append(*openedBlock);
+            openedBlock.reset();
+        }
+        return true;
+    }, fromPosition);
 
-        CodeBlock b;
-        b.cursor = c;
-        b.tag = match.captured(1).toLower();
-        b.language = match.captured(3).toLower();
-        result.append(b);
+    if (!stopped) // the rest of document was paired again
+    {
+        unclosedCodeTag = openedBlock ? openedBlock->cursor : QTextCursor();
     }
     return result;
 }
@@ -2816,9 +3155,53 @@ bool CodeEditor::tryOpenLinkAtPosition(const QString& text, int posInBlock)
     return false;
 }
 
-void CodeEditor::setSearchHighlights(const QList<QTextEdit::ExtraSelection>& highlights)
+void CodeEditor::setSearchHighlights(std::vector<int> sortedPositions, int matchLength)
 {
-    // Store persistent search highlights and update the display
-    persistentSearchHighlights = highlights;
+    searchHighlightPositions = std::move(sortedPositions);
+    searchHighlightLength = matchLength;
     highlightCurrentLine(); // This will merge and display highlights
 }
+
+QList<QTextEdit::ExtraSelection> CodeEditor::visibleSearchHighlights() const
+{
+    if (searchHighlightPositions.empty())
+        return {};
+
+    const int visibleStart = firstVisibleBlock().position();
+    const QTextBlock lastVisible = cursorForPosition(QPoint(0, viewport()->height() - 1)).block();
+    const int visibleEnd = lastVisible.position() + lastVisible.length();
+    const int documentEnd = document()->characterCount() - 1;
+
+    QList<QTextEdit::ExtraSelection> highlights;
+    auto occurrence = std::lower_bound(searchHighlightPositions.begin(), searchHighlightPositions.end(),
+                                       visibleStart - searchHighlightLength + 1);
+    for (; occurrence != searchHighlightPositions.end() && *occurrence < std::min(visibleEnd, documentEnd); ++occurrence)
+    {
+        QTextEdit::ExtraSelection selection;
+        selection.cursor = QTextCursor(document());
+        selection.cursor.setPosition(*occurrence);
+        selection.cursor.setPosition(std::min(*occurrence + searchHighlightLength, documentEnd), QTextCursor::KeepAnchor);
+        selection.format.setBackground(QColor(255, 255, 0, 80));
+        selection.format.setProperty(QTextFormat::FullWidthSelection, true);
+        highlights.append(selection);
+    }
+    return highlights;
+}
+
+void CodeEditor::shiftSearchHighlights(int position, int charsRemoved, int charsAdded)
+{
+    if (searchHighlightPositions.empty())
+        return;
+
+    const auto overlappingBegin = std::lower_bound(searchHighlightPositions.begin(), searchHighlightPositions.end(),
+                                                   position - searchHighlightLength + 1);
+    const auto overlappingEnd = std::lower_bound(overlappingBegin, searchHighlightPositions.end(), position + charsRemoved);
+    const auto following = searchHighlightPositions.erase(overlappingBegin, overlappingEnd);
+
+    if (const int shift = charsAdded - charsRemoved; shift != 0)
+    {
+        std::for_each(following, searchHighlightPositions.end(), [shift](int& occurrence) {
+            occurrence += shift;
+        });
+    }
+}
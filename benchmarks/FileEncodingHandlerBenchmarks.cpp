@@ -0,0 +1,43 @@
+#include <benchmark/benchmark.h>
+#include <QTemporaryFile>
+#include <QStringEncoder>
+#include "utils/FileEncodingHandler.h"
+#include "SampleDocuments.h"
+
+
+namespace
+{
+/// Size of the file is about 100 bytes per line
+void loadFileInEncoding(benchmark::State& state, QStringEncoder::Encoding encoding)
+{
+    QStringEncoder encoder(encoding);
+    const QByteArray content = encoder.encode(sample::makeStcLines(state.range(0)).join('\n'));
+
+    QTemporaryFile file;
+    if (!file.open() || file.write(content) != content.size() || !file.flush())
+    {
+        state.SkipWithError("Cannot write temporary file");
+        return;
+    }
+
+    FileEncodingHandler handler;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(handler.loadFile(file.fileName()));
+    }
+    state.SetBytesProcessed(state.iterations() * content.size());
+}
+
+void BM_LoadFileUtf8(benchmark::State& state)
+{
+    loadFileInEncoding(state, QStringEncoder::Utf8);
+}
+BENCHMARK(BM_LoadFileUtf8)->Arg(1'000)->Arg(10'000)->Arg(100'000)->Unit(benchmark::kMillisecond);
+
+/// Some older pages were saved in single byte encodings, they are detected and decoded too
+void BM_LoadFileLatin1(benchmark::State& state)
+{
+    loadFileInEncoding(state, QStringEncoder::Latin1);
+}
+BENCHMARK(BM_LoadFileLatin1)->Arg(1'000)->Arg(10'000)->Arg(100'000)->Unit(benchmark::kMillisecond);
+} // namespace
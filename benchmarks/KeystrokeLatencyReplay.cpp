@@ -0,0 +1,309 @@
+/// Replays an edit script against MainWindow on the offscreen platform and reports latency of keystrokes per handler.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <QApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QKeyEvent>
+#include <QStandardPaths>
+#include <QTemporaryFile>
+#include <QTextBlock>
+#include <QTimer>
+#include "ui/mainwindow.h"
+#include "CodeEditor.h"
+#include "utils/HandlerTimings.h"
+#include "utils/Tracing.h"
+#include "StcCorpus.h"
+
+using namespace std::chrono;
+
+namespace
+{
+constexpr auto frameBudget = milliseconds(16);
+
+struct Options
+{
+    std::string documentFile; // generated when empty
+    std::string scriptFile;   // generated when empty
+    corpus::DocumentOptions document{ .targetBytes = 256 * 1024 };
+    corpus::EditScriptOptions script;
+    double timeScale = 0; // 1 waits as long as the person who typed, then debounced timers fire like in real use
+    std::string traceFile; // Chrome trace of the replay when not empty
+};
+
+void printUsage(std::ostream& os)
+{
+    os << "Usage: STC_editorKeystrokeReplay [options]\n"
+          "Opens a document in MainWindow (offscreen), replays keystrokes and prints latency percentiles per handler.\n"
+          "\n"
+          "Options:\n"
+          "  --document FILE     document to edit (default: generated by stc-corpus generator)\n"
+          "  --size BYTES        size of the generated document (default: 262144)\n"
+          "  --seed N            seed of the generated document and script (default: 1)\n"
+          "  --script FILE       edit script saved by stc-corpus (default: generated)\n"
+          "  --keystrokes N      length of the generated script (default: 1000)\n"
+          "  --time-scale F      wait F times the recorded pauses between keystrokes (default: 0, no waiting)\n"
+          "  --trace FILE        save Chrome trace of the replay (when built with STC_TRACING)\n";
+}
+
+std::optional<Options> parseArguments(const QStringList& arguments)
+{
+    Options options;
+    for (qsizetype i = 1; i < arguments.size(); ++i)
+    {
+        const QString& argument = arguments[i];
+        if (argument == "-h" || argument == "--help")
+        {
+            printUsage(std::cout);
+            std::exit(0);
+        }
+        if (i + 1 >= arguments.size())
+        {
+            std::cerr << "missing value of " << argument.toStdString() << "\n";
+            return std::nullopt;
+        }
+
+        const QString value = arguments[++i];
+        bool ok = true;
+        if (argument == "--document")
+            options.documentFile = value.toStdString();
+        else if (argument == "--size")
+            options.document.targetBytes = value.toULongLong(&ok);
+        else if (argument == "--seed")
+            options.document.seed = options.script.seed = value.toULongLong(&ok);
+        else if (argument == "--script")
+            options.scriptFile = value.toStdString();
+        else if (argument == "--keystrokes")
+            options.script.keystrokes = value.toInt(&ok);
+        else if (argument == "--time-scale")
+            options.timeScale = value.toDouble(&ok);
+        else if (argument == "--trace")
+            options.traceFile = value.toStdString();
+        else
+            ok = false;
+
+        if (!ok)
+        {
+            std::cerr << "invalid option " << argument.toStdString() << " " << value.toStdString() << "\n";
+            return std::nullopt;
+        }
+    }
+    return options;
+}
+
+std::string readFile(const std::string& fileName)
+{
+    std::ifstream file(fileName, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("Cannot open " + fileName);
+    return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+}
+
+/// Like a person typing: the key goes through CodeEditor::keyPressEvent and its shortcuts
+void pressKey(CodeEditor* editor, int key, const QString& text = {})
+{
+    QKeyEvent press(QEvent::KeyPress, key, Qt::NoModifier, text);
+    QApplication::sendEvent(editor, &press);
+    QKeyEvent release(QEvent::KeyRelease, key, Qt::NoModifier, text);
+    QApplication::sendEvent(editor, &release);
+}
+
+void replayStep(CodeEditor* editor, const corpus::EditStep& step)
+{
+    using Kind = corpus::EditStep::Kind;
+
+    switch (step.kind)
+    {
+    case Kind::MoveCursor:
+    {
+        const QTextBlock block = editor->document()->findBlockByNumber(step.line);
+        QTextCursor cursor(block);
+        cursor.setPosition(block.position() + std::min(step.column, block.length() - 1));
+        editor->setTextCursor(cursor);
+        break;
+    }
+    case Kind::Type:
+    {
+        const QString text = QString::fromStdString(step.text);
+        const int key = text.size() == 1 && text[0].isLetterOrNumber() ? text[0].toUpper().unicode() : Qt::Key_unknown;
+        pressKey(editor, text == " " ? Qt::Key_Space : key, text);
+        break;
+    }
+    case Kind::Backspace:
+        pressKey(editor, Qt::Key_Backspace);
+        break;
+    case Kind::Newline:
+        pressKey(editor, Qt::Key_Return, "\r");
+        break;
+    case Kind::Paste:
+        editor->insertPlainText(QString::fromStdString(step.text));
+        break;
+    }
+}
+
+/// Work done after the pause of the person, eg. by debounced timers
+void waitProcessingEvents(milliseconds pause)
+{
+    if (pause <= milliseconds::zero())
+        return;
+
+    QEventLoop loop;
+    QTimer::singleShot(pause, &loop, &QEventLoop::quit);
+    loop.exec();
+}
+
+struct Samples
+{
+    std::vector<nanoseconds> perStep;
+    nanoseconds total{};
+
+    void add(nanoseconds duration)
+    {
+        perStep.push_back(duration);
+        total += duration;
+    }
+};
+
+double toMicroseconds(nanoseconds duration)
+{
+    return static_cast<double>(duration.count()) / 1'000.0;
+}
+
+/// nearest-rank percentile, samples are sorted
+nanoseconds percentile(const std::vector<nanoseconds>& sorted, double fraction)
+{
+    if (sorted.empty())
+        return {};
+    const auto rank = static_cast<std::size_t>(std::ceil(fraction * static_cast<double>(sorted.size())));
+    return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+}
+
+void printRow(const std::string& name, Samples samples, nanoseconds allStepsTotal)
+{
+    std::ranges::sort(samples.perStep);
+    std::printf("%-48s %8zu %6.1f%% %10.1f %10.1f %10.1f %10.1f\n", name.c_str(), samples.perStep.size(),
+                100.0 * static_cast<double>(samples.total.count()) / static_cast<double>(std::max<nanoseconds::rep>(1, allStepsTotal.count())),
+                toMicroseconds(percentile(samples.perStep, 0.50)), toMicroseconds(percentile(samples.perStep, 0.95)),
+                toMicroseconds(percentile(samples.perStep, 0.99)), toMicroseconds(samples.perStep.empty() ? nanoseconds{} : samples.perStep.back()));
+}
+
+void printTable(const std::string& title, const Samples& total, const std::map<std::string, Samples>& handlers)
+{
+    std::printf("\n%s: %zu steps, %zu over the frame budget of %lld ms\n", title.c_str(), total.perStep.size(),
+                static_cast<std::size_t>(std::ranges::count_if(total.perStep, [](nanoseconds d) { return d > frameBudget; })),
+                static_cast<long long>(frameBudget.count()));
+    std::printf("%-48s %8s %7s %10s %10s %10s %10s\n", "handler (own time, us)", "steps", "share", "p50", "p95", "p99", "max");
+
+    printRow("total", total, total.total);
+
+    std::vector<std::pair<std::string, Samples>> sorted(handlers.begin(), handlers.end());
+    std::ranges::sort(sorted, std::greater{}, [](const auto& handler) { return handler.second.total; });
+    for (const auto& [name, samples] : sorted)
+        printRow("  " + name, samples, total.total);
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QStandardPaths::setTestModeEnabled(true); // settings and recent files of the user are not touched
+
+    QApplication app(argc, argv);
+    app.setOrganizationName("Personal");
+    app.setApplicationName("Cpp0x tags editor keystroke replay");
+    Tracing::setCurrentThreadName("main");
+
+    const auto options = parseArguments(app.arguments());
+    if (!options)
+    {
+        printUsage(std::cerr);
+        return 2;
+    }
+
+    try
+    {
+        const std::string document = options->documentFile.empty() ? corpus::generateDocument(options->document)
+                                                                    : readFile(options->documentFile);
+        const std::vector<corpus::EditStep> steps = options->scriptFile.empty() ? corpus::generateEditScript(document, options->script)
+                                                                                : corpus::parseEditScript(readFile(options->scriptFile));
+
+        QTemporaryFile file(QDir::tempPath() + "/keystroke-replay-XXXXXX.txt");
+        if (!file.open() || file.write(document.data(), static_cast<qint64>(document.size())) != static_cast<qint64>(document.size()))
+            throw std::runtime_error("Cannot write temporary file");
+        file.close();
+
+        MainWindow window;
+        window.resize(1280, 900);
+        window.show();
+        auto* editor = window.findChild<CodeEditor*>();
+
+        QElapsedTimer loading;
+        loading.start();
+        if (!window.loadFileContentToEditorDistargingCurrentContent(file.fileName()))
+            throw std::runtime_error("Cannot open the document in editor");
+        while (editor->isLoadingInProgress())
+            QApplication::processEvents(QEventLoop::WaitForMoreEvents);
+        QApplication::processEvents();
+        std::printf("Document: %zu bytes, %d lines, loaded in %lld ms; %zu steps to replay\n",
+                    document.size(), editor->blockCount(), static_cast<long long>(loading.elapsed()), steps.size());
+
+        Samples keystrokes, others, background;
+        std::map<std::string, Samples> keystrokeHandlers, otherHandlers, backgroundHandlers;
+
+        Tracing::clear(); // only the replay, without loading of the document
+        HandlerTimings::setEnabled(true);
+        for (const auto& step : steps)
+        {
+            waitProcessingEvents(duration_cast<milliseconds>(milliseconds(step.delayMs) * options->timeScale));
+            const auto idleTimings = HandlerTimings::take();
+            nanoseconds idleTotal{};
+            for (const auto& [name, time] : idleTimings)
+            {
+                backgroundHandlers[std::string(name)].add(duration_cast<nanoseconds>(time));
+                idleTotal += duration_cast<nanoseconds>(time);
+            }
+            if (!idleTimings.empty())
+                background.add(idleTotal);
+
+            // the event loop runs once after the key, like before the next frame: posted events, 0 ms timers and painting
+            const auto start = steady_clock::now();
+            replayStep(editor, step);
+            QApplication::processEvents();
+            const auto elapsed = duration_cast<nanoseconds>(steady_clock::now() - start);
+
+            const bool keystroke = step.kind != corpus::EditStep::Kind::MoveCursor && step.kind != corpus::EditStep::Kind::Paste;
+            (keystroke ? keystrokes : others).add(elapsed);
+            auto& handlers = keystroke ? keystrokeHandlers : otherHandlers;
+
+            nanoseconds attributed{};
+            for (const auto& [name, time] : HandlerTimings::take())
+            {
+                handlers[std::string(name)].add(duration_cast<nanoseconds>(time));
+                attributed += duration_cast<nanoseconds>(time);
+            }
+            handlers["(Qt and not measured handlers)"].add(std::max(nanoseconds{}, elapsed - attributed));
+        }
+        HandlerTimings::setEnabled(false);
+
+        if (!options->traceFile.empty() && !Tracing::saveChromeTrace(options->traceFile))
+            throw std::runtime_error("Cannot write trace to " + options->traceFile);
+
+        printTable("Keystrokes (typing, backspace, enter)", keystrokes, keystrokeHandlers);
+        printTable("Cursor moves and pastes", others, otherHandlers);
+        if (!background.perStep.empty())
+            printTable("Work between keystrokes (timers)", background, backgroundHandlers);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Replay failed: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include <benchmark/benchmark.h>
+#include <regex>
+#include <string>
+#include "checkers/PairedTagsChecker.h"
+
+
+namespace
+{
+/// Lines similar to those in articles of cpp0x.pl, repeated until the text has at least the requested number of bytes
+std::string makeStcText(std::size_t bytesCount)
+{
+    static const std::string sampleLines[] = {
+        R"([h1]Wprowadzenie do [b]szablonów[/b][/h1])",
+        R"(Szablony pozwalają pisać [i]generyczny[/i] kod, więcej w [a href="https://cpp0x.pl/kursy/" name="kursie"].)",
+        R"([div class="tip"]Pamiętaj o [u]słowie kluczowym[/u] typename.[/div])",
+        R"([cpp]template<typename T> T max(T a, T b) { return a > b ? a : b; }[/cpp])",
+        R"([img src="szablony.png" alt="diagram" opis="Instancjonowanie szablonu" autofit])",
+        R"([pkt][run]g++ -std=c++23 main.cpp[/run] kompiluje program[/pkt])",
+        R"(Zwykły akapit tekstu bez żadnych tagów, który także jest sprawdzany pod kątem pisowni.)",
+        R"([h2]Podsumowanie[/h2] [s]przekreślone[/s] oraz [tt]stała szerokość[/tt])",
+        R"()",
+    };
+
+    std::string text;
+    text.reserve(bytesCount + 128);
+    for (std::size_t i = 0; text.size() < bytesCount; ++i)
+    {
+        text += sampleLines[i % std::size(sampleLines)];
+        text += '\n';
+    }
+    return text;
+}
+
+/// How the tags were found by `PairedTagsChecker` before the hand written scanner
+void BM_ExtractTags_Regex(benchmark::State& state)
+{
+    const std::string text = makeStcText(state.range(0));
+    const std::regex tagRegex{R"(\[/?([[:alpha:]][[:alnum:]]*)([^\]]*?)\])"};
+
+    for (auto _ : state)
+    {
+        std::size_t lineStart = 0;
+        while (lineStart < text.size())
+        {
+            const std::size_t lineEnd = std::min(text.find('\n', lineStart), text.size());
+            for (std::cregex_iterator it(text.data() + lineStart, text.data() + lineEnd, tagRegex), end; it != end; ++it)
+            {
+                benchmark::DoNotOptimize(it->position(0));
+            }
+            lineStart = lineEnd + 1;
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_ExtractTags_Regex)->Arg(64 << 10)->Arg(1 << 20);
+
+void BM_ExtractTags_Scanner(benchmark::State& state)
+{
+    const std::string text = makeStcText(state.range(0));
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(PairedTagsChecker::extractTags(text));
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_ExtractTags_Scanner)->Arg(64 << 10)->Arg(1 << 20)->Arg(16 << 20);
+
+void BM_CheckTags(benchmark::State& state)
+{
+    const std::string text = makeStcText(state.range(0));
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(PairedTagsChecker::checkTags(text));
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_CheckTags)->Arg(64 << 10)->Arg(1 << 20)->Arg(16 << 20);
+} // namespace
@@ -0,0 +1,158 @@
+#include <benchmark/benchmark.h>
+#include <QGuiApplication>
+#include <QTextDocument>
+#include <QRegularExpression>
+#include "utils/STCSyntaxHighlighter.h"
+#include "utils/StcTagScanner.h"
+#include "stcSyntaxPatterns.h"
+#include "SampleDocuments.h"
+
+
+namespace
+{
+/// A long [cpp] listing, like in articles with complete programs
+QStringList makeCppListingLines(int linesCount)
+{
+    static const QStringList sampleLines = {
+        R"(#include <vector>)",
+        R"(template<typename T> T sum(const std::vector<T>& values) // sums all the values)",
+        R"({)",
+        R"(    T result = {};)",
+        R"(    for (const auto& value : values) { result += value; } /* range-based for */)",
+        R"(    std::cout << "Sum: " << result << '\n';)",
+        R"(    return result;)",
+        R"(})",
+    };
+
+    QStringList lines = { "[cpp]" };
+    lines.reserve(linesCount + 2);
+    for (int i = 0; i < linesCount; ++i)
+    {
+        lines.append(sampleLines[i % sampleLines.size()]);
+    }
+    lines.append("[/cpp]");
+    return lines;
+}
+
+/// Patterns applied to every line by the stages of `STCSyntaxHighlighter::highlightBlock` before `stc::TagScanner` was introduced
+QList<QRegularExpression> regexCascade()
+{
+    using namespace stc::syntax;
+
+    QList<QRegularExpression> patterns = {
+        divOpenRe, divCloseRe,
+        pktOpenRe, pktCloseRe, csvOpenRe, csvCloseRe, runTagRe,
+        divOpenRe, divCloseRe,
+        codeBlockOpenRe, codeCloseRe, cppCloseRe, pythonCloseRe,
+        baseFormatting_boldItalicUnderlineStrikeRe, boldCloseRe, italicCloseRe, underlineCloseRe, strikeOutCloseRe,
+        anchorRe, imgRe,
+        QRegularExpression(R"(\[\/?\w+.*?\])"),
+    };
+    for (const char* header : { "h1", "h2", "h3", "h4" })
+    {
+        patterns.append(QRegularExpression(QStringLiteral(R"(\[(%1)\](.*?)\[/\1\])").arg(header)));
+    }
+    return patterns;
+}
+
+void BM_FindTags_RegexCascade(benchmark::State& state)
+{
+    const QStringList lines = sample::makeStcLines(state.range(0));
+    const QList<QRegularExpression> patterns = regexCascade();
+
+    for (auto _ : state)
+    {
+        for (const QString& line : lines)
+        {
+            for (const QRegularExpression& pattern : patterns)
+            {
+                auto it = pattern.globalMatch(line);
+                while (it.hasNext())
+                {
+                    benchmark::DoNotOptimize(it.next().capturedStart());
+                }
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * lines.size());
+}
+BENCHMARK(BM_FindTags_RegexCascade)->Arg(1'000)->Arg(10'000);
+
+void BM_FindTags_TagScanner(benchmark::State& state)
+{
+    const QStringList lines = sample::makeStcLines(state.range(0));
+
+    for (auto _ : state)
+    {
+        for (const QString& line : lines)
+        {
+            stc::TagScanner scanner(line);
+            while (auto tag = scanner.next())
+            {
+                benchmark::DoNotOptimize(tag->start);
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * lines.size());
+}
+BENCHMARK(BM_FindTags_TagScanner)->Arg(1'000)->Arg(10'000);
+
+void BM_RehighlightDocument(benchmark::State& state)
+{
+    QTextDocument document;
+    document.setPlainText(sample::makeStcLines(state.range(0)).join('\n'));
+    auto* highlighter = new STCSyntaxHighlighter(&document); // owned by the document
+
+    for (auto _ : state)
+    {
+        highlighter->rehighlight();
+    }
+    state.SetItemsProcessed(state.iterations() * document.blockCount());
+}
+BENCHMARK(BM_RehighlightDocument)->Arg(1'000)->Arg(10'000)->Unit(benchmark::kMillisecond);
+
+void BM_RehighlightCppListing(benchmark::State& state)
+{
+    QTextDocument document;
+    document.setPlainText(makeCppListingLines(state.range(0)).join('\n'));
+    auto* highlighter = new STCSyntaxHighlighter(&document); // owned by the document
+
+    for (auto _ : state)
+    {
+        highlighter->rehighlight();
+    }
+    state.SetItemsProcessed(state.iterations() * document.blockCount());
+}
+BENCHMARK(BM_RehighlightCppListing)->Arg(1'000)->Arg(10'000)->Unit(benchmark::kMillisecond);
+
+/// Time until the text is inserted and the first screen highlighted, the rest waits for the event loop
+void BM_SetTextHighlightingVisibleBlocksFirst(benchmark::State& state)
+{
+    const QString text = sample::makeStcLines(state.range(0)).join('\n');
+    QTextDocument document;
+    auto* highlighter = new STCSyntaxHighlighter(&document); // owned by the document
+    highlighter->setVisibleBlocks(0, 60);
+
+    for (auto _ : state)
+    {
+        document.setPlainText(text);
+    }
+    state.SetItemsProcessed(state.iterations() * document.blockCount());
+}
+BENCHMARK(BM_SetTextHighlightingVisibleBlocksFirst)->Arg(1'000)->Arg(10'000)->Unit(benchmark::kMillisecond);
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv); // fonts are needed to lay out the highlighted document
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,48 @@
+#include "SampleDocuments.h"
+
+namespace sample
+{
+QStringList makeStcLines(int linesCount)
+{
+    static const QStringList sampleLines = {
+        R"([h1]Wprowadzenie do [b]szablonów[/b][/h1])",
+        R"(Szablony pozwalają pisać [i]generyczny[/i] kod, więcej w [a href="https://cpp0x.pl/kursy/" name="kursie"].)",
+        R"([div class="tip"]Pamiętaj o [u]słowie kluczowym[/u] typename.[/div])",
+        R"([cpp]template<typename T> T max(T a, T b) { return a > b ? a : b; }[/cpp])",
+        R"([img src="szablony.png" alt="diagram" opis="Instancjonowanie szablonu" autofit])",
+        R"([pkt][run]g++ -std=c++23 main.cpp[/run] kompiluje program[/pkt])",
+        R"(Zwykły akapit tekstu bez żadnych tagów, który także jest sprawdzany pod kątem pisowni.)",
+        R"([h2]Podsumowanie[/h2] [s]przekreślone[/s] oraz [tt]stała szerokość[/tt])",
+        R"()",
+    };
+
+    QStringList lines;
+    lines.reserve(linesCount);
+    for (int i = 0; i < linesCount; ++i)
+    {
+        lines.append(sampleLines[i % sampleLines.size()]);
+    }
+    return lines;
+}
+
+QStringList makeEditedLines(const QStringList& lines, int everyNthLine)
+{
+    QStringList edited = lines;
+    for (qsizetype i = everyNthLine / 2; i < edited.size(); i += everyNthLine)
+    {
+        switch ((i / everyNthLine) % 3)
+        {
+        case 0:
+            edited[i].insert(edited[i].size() / 2, QStringLiteral(" [b]poprawka[/b]"));
+            break;
+        case 1:
+            edited.insert(i, QStringLiteral("Nowy akapit dopisany w trakcie redakcji."));
+            break;
+        default:
+            edited.removeAt(i);
+            break;
+        }
+    }
+    return edited;
+}
+} // namespace sample
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <QStringList>
+
+namespace sample
+{
+/// Lines similar to those in articles of cpp0x.pl, repeated until the document has the requested number of lines
+QStringList makeStcLines(int linesCount);
+
+/// Copy of the lines with every n-th line changed a bit, like after a session of editing
+QStringList makeEditedLines(const QStringList& lines, int everyNthLine);
+} // namespace sample
@@ -0,0 +1,730 @@
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include "StcCorpus.h"
+
+using namespace std::string_view_literals;
+
+namespace corpus
+{
+namespace
+{
+/// Only the engine is used from <random>: distributions give different numbers with different standard libraries.
+class Random
+{
+public:
+    explicit Random(std::uint64_t seed)
+        : engine(seed)
+    {}
+
+    std::size_t below(std::size_t n)
+    {
+        return static_cast<std::size_t>(engine() % n);
+    }
+
+    int between(int min, int max)
+    {
+        return min + static_cast<int>(below(static_cast<std::size_t>(max - min + 1)));
+    }
+
+    bool chance(double probability)
+    {
+        return static_cast<double>(engine() >> 11) * 0x1.0p-53 < probability;
+    }
+
+    template <typename Items>
+    const auto& pick(const Items& items)
+    {
+        return items[below(std::size(items))];
+    }
+
+    std::size_t weighted(std::span<const double> weights)
+    {
+        double total = 0;
+        for (double weight : weights)
+            total += std::max(0.0, weight);
+        if (total <= 0)
+            return 0;
+
+        double point = static_cast<double>(engine() >> 11) * 0x1.0p-53 * total;
+        for (std::size_t i = 0; i < weights.size(); ++i)
+        {
+            point -= std::max(0.0, weights[i]);
+            if (point < 0)
+                return i;
+        }
+        return weights.size() - 1;
+    }
+
+private:
+    std::mt19937_64 engine;
+};
+
+constexpr std::array polishWords = {
+    "program"sv, "funkcja"sv, "zmienna"sv, "wartość"sv, "szablon"sv, "klasa"sv, "obiekt"sv, "wskaźnik"sv, "referencja"sv,
+    "kompilator"sv, "tablica"sv, "pętla"sv, "warunek"sv, "kod"sv, "błąd"sv, "pamięć"sv, "typ"sv, "argument"sv, "wynik"sv,
+    "biblioteka"sv, "kontener"sv, "iterator"sv, "algorytm"sv, "wyjątek"sv, "deklaracja"sv, "definicja"sv, "przykład"sv,
+    "należy"sv, "można"sv, "jest"sv, "będzie"sv, "został"sv, "pozwala"sv, "zwraca"sv, "przyjmuje"sv, "tworzy"sv,
+    "używamy"sv, "pamiętaj"sv, "zauważ"sv, "który"sv, "która"sv, "które"sv, "oraz"sv, "jednak"sv, "dlatego"sv, "także"sv,
+    "się"sv, "nie"sv, "jak"sv, "gdy"sv, "dla"sv, "przez"sv, "między"sv, "każdy"sv, "prosty"sv, "ważny"sv, "standardowy"sv,
+    "własny"sv, "źródłowy"sv, "dynamiczny"sv, "stały"sv, "łańcuch"sv, "znaków"sv, "liczb"sv, "całkowitych"sv, "w"sv,
+    "i"sv, "z"sv, "na"sv, "do"sv, "to"sv, "że"sv, "po"sv, "od"sv, "przed"sv, "również"sv, "ćwiczenie"sv, "żądanie"sv,
+};
+
+constexpr std::array cppLines = {
+    "#include <iostream>"sv, "#include <vector>"sv, "#include <string>"sv, "using namespace std;"sv, ""sv,
+    "int main()"sv, "{"sv, "}"sv, "    int tab[10] = {};"sv, "    for (int i = 0; i < 10; ++i)"sv, "        tab[i] = i * i;"sv,
+    "    std::vector<int> liczby{1, 2, 3};"sv, "    cout << \"Wynik: \" << tab[3] << endl; // wypisanie"sv,
+    "    std::string tekst = \"[b]to nie jest tag[/b]\";"sv, "    /* komentarz"sv, "       w wielu liniach */"sv,
+    "template <typename T>"sv, "T maksimum(T a, T b) { return a > b ? a : b; }"sv, "    auto [x, y] = para;"sv,
+    "    if (liczby.empty()) return 1;"sv, "    return 0;"sv, "struct Punkt { double x, y; };"sv,
+};
+
+constexpr std::array inlineTags = { "b"sv, "i"sv, "u"sv, "s"sv, "tt"sv, "run"sv };
+constexpr std::array divClasses = { ""sv, R"( class="tip")"sv, R"( class="uwaga")"sv };
+
+struct Utf8Replacement
+{
+    std::string_view from, to;
+};
+/// The most common misspelling of Polish: a letter without its diacritic
+constexpr Utf8Replacement withoutDiacritics[] = {
+    { "ą", "a" }, { "ę", "e" }, { "ł", "l" }, { "ó", "o" }, { "ś", "s" },
+    { "ż", "z" }, { "ź", "z" }, { "ć", "c" }, { "ń", "n" },
+};
+
+std::string misspelled(std::string word, Random& random)
+{
+    if (random.chance(0.5))
+    {
+        for (const auto& [from, to] : withoutDiacritics)
+        {
+            if (const auto position = word.find(from); position != std::string::npos)
+                return word.replace(position, from.size(), to);
+        }
+    }
+
+    // swapped or doubled ASCII letters, like when typing too fast
+    for (std::size_t tries = 0; tries < 4 && word.size() >= 2; ++tries)
+    {
+        const std::size_t i = random.below(word.size() - 1);
+        if (static_cast<unsigned char>(word[i]) < 0x80 && static_cast<unsigned char>(word[i + 1]) < 0x80 && word[i] != word[i + 1])
+        {
+            std::swap(word[i], word[i + 1]);
+            return word;
+        }
+    }
+    if (!word.empty() && static_cast<unsigned char>(word.back()) < 0x80)
+        word += word.back();
+    return word;
+}
+
+class DocumentGenerator
+{
+public:
+    explicit DocumentGenerator(const DocumentOptions& options)
+        : options(options), random(options.seed)
+    {}
+
+    std::string generate()
+    {
+        while (text.size() < options.targetBytes)
+        {
+            block(0);
+        }
+        return std::move(text);
+    }
+
+private:
+    enum BlockKind
+    {
+        Paragraph, Header, Div, Cpp, Csv, Pkt, Image
+    };
+
+    std::string word()
+    {
+        std::string w{ random.pick(polishWords) };
+        return random.chance(options.misspellingRate) ? misspelled(std::move(w), random) : w;
+    }
+
+    std::string words(int count)
+    {
+        std::string result;
+        for (int i = 0; i < count; ++i)
+        {
+            if (i > 0)
+                result += ' ';
+            result += word();
+        }
+        return result;
+    }
+
+    std::string sentence()
+    {
+        std::string result = words(random.between(4, 14));
+        if (!result.empty() && result[0] >= 'a' && result[0] <= 'z')
+            result[0] = static_cast<char>(result[0] - 'a' + 'A');
+
+        if (random.chance(options.mix.inlineTags))
+        {
+            const std::string taggedWords = words(random.between(1, 3));
+            if (random.chance(0.25))
+            {
+                result += std::string(R"( [a href="https://cpp0x.pl/kursy/)") + std::to_string(random.between(1, 999))
+                          + R"(" name=")" + taggedWords + R"("])";
+            }
+            else
+            {
+                const std::string tag{ random.pick(inlineTags) };
+                result += " [" + tag + "]" + taggedWords + "[/" + tag + "]";
+            }
+            result += ' ' + words(random.between(1, 5));
+        }
+        return result + '.';
+    }
+
+    void line(std::string_view content)
+    {
+        text += content;
+        text += '\n';
+    }
+
+    void block(int depth)
+    {
+        const auto& mix = options.mix;
+        const std::array weights = {
+            mix.paragraph, mix.header, depth < options.maxNestingDepth ? mix.div : 0.0, mix.cpp, mix.csv, mix.pkt, mix.image
+        };
+
+        switch (random.weighted(weights))
+        {
+        case Paragraph:
+        {
+            std::string paragraph;
+            for (int i = random.between(1, 5); i > 0; --i)
+                paragraph += sentence() + (i > 1 ? " " : "");
+            line(paragraph);
+            break;
+        }
+        case Header:
+        {
+            const std::string level = "h" + std::to_string(random.between(1, 4));
+            line("[" + level + "]" + words(random.between(2, 6)) + "[/" + level + "]");
+            break;
+        }
+        case Div:
+            line("[div" + std::string(random.pick(divClasses)) + "]");
+            for (int i = random.between(1, 4); i > 0; --i)
+                block(depth + 1);
+            line("[/div]");
+            break;
+        case Cpp:
+            line("[cpp]");
+            for (int i = random.between(5, 30); i > 0; --i)
+                line(random.pick(cppLines));
+            line("[/cpp]");
+            break;
+        case Csv:
+        {
+            const bool extended = random.chance(0.3);
+            const int columns = random.between(2, 5);
+            line(extended ? "[csv ext]" : "[csv]");
+            for (int row = random.between(3, 9); row > 0; --row)
+            {
+                std::string cells;
+                for (int column = 0; column < columns; ++column)
+                {
+                    const std::string cell = extended && random.chance(0.3) ? "[run]" + word() + "()[/run]" : words(random.between(1, 3));
+                    cells += (column > 0 ? ";" : "") + cell;
+                }
+                line(cells);
+            }
+            line("[/csv]");
+            break;
+        }
+        case Pkt:
+            line("[pkt]");
+            for (int i = random.between(2, 6); i > 0; --i)
+                line(words(random.between(2, 8)));
+            line("[/pkt]");
+            break;
+        case Image:
+        {
+            const std::string name = "obrazek_" + std::to_string(random.between(1, 500));
+            line(R"([img src="obrazki/)" + name + R"(.png" alt=")" + words(2) + R"(" opis=")" + words(random.between(2, 6)) + R"("])");
+            break;
+        }
+        }
+
+        if (depth == 0 && random.chance(0.5))
+            line("");
+    }
+
+    const DocumentOptions& options;
+    Random random;
+    std::string text;
+};
+
+std::u32string toUtf32(std::string_view utf8)
+{
+    std::u32string result;
+    result.reserve(utf8.size());
+    for (std::size_t i = 0; i < utf8.size();)
+    {
+        const auto lead = static_cast<unsigned char>(utf8[i]);
+        const int length = lead < 0x80 ? 1 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : 4;
+        char32_t codePoint = length == 1 ? lead : lead & (0x3F >> (length - 1));
+        for (int j = 1; j < length && i + j < utf8.size(); ++j)
+            codePoint = (codePoint << 6) | (static_cast<unsigned char>(utf8[i + j]) & 0x3F);
+        result += codePoint;
+        i += length;
+    }
+    return result;
+}
+
+std::string toUtf8(std::u32string_view utf32)
+{
+    std::string result;
+    result.reserve(utf32.size());
+    for (char32_t c : utf32)
+    {
+        if (c < 0x80)
+        {
+            result += static_cast<char>(c);
+        }
+        else if (c < 0x800)
+        {
+            result += static_cast<char>(0xC0 | (c >> 6));
+            result += static_cast<char>(0x80 | (c & 0x3F));
+        }
+        else if (c < 0x10000)
+        {
+            result += static_cast<char>(0xE0 | (c >> 12));
+            result += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            result += static_cast<char>(0x80 | (c & 0x3F));
+        }
+        else
+        {
+            result += static_cast<char>(0xF0 | (c >> 18));
+            result += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+            result += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            result += static_cast<char>(0x80 | (c & 0x3F));
+        }
+    }
+    return result;
+}
+
+/// Document split by lines, edited the same way as QTextDocument is by keystrokes
+class EditedText
+{
+public:
+    explicit EditedText(std::string_view text)
+    {
+        std::size_t lineStart = 0;
+        for (auto lineEnd = text.find('\n'); ; lineEnd = text.find('\n', lineStart))
+        {
+            lines.push_back(toUtf32(text.substr(lineStart, lineEnd == std::string_view::npos ? std::string_view::npos : lineEnd - lineStart)));
+            if (lineEnd == std::string_view::npos)
+                break;
+            lineStart = lineEnd + 1;
+        }
+    }
+
+    void apply(const EditStep& step)
+    {
+        switch (step.kind)
+        {
+        case EditStep::Kind::MoveCursor:
+            if (step.line < 0 || step.line >= static_cast<int>(lines.size())
+                || step.column < 0 || step.column > static_cast<int>(lines[step.line].size()))
+            {
+                throw std::runtime_error("Cursor moved outside of the document: " + std::to_string(step.line) + ":" + std::to_string(step.column));
+            }
+            line = step.line;
+            column = step.column;
+            break;
+        case EditStep::Kind::Type:
+        case EditStep::Kind::Paste:
+            for (char32_t c : toUtf32(step.text))
+                insert(c);
+            break;
+        case EditStep::Kind::Newline:
+            insert(U'\n');
+            break;
+        case EditStep::Kind::Backspace:
+            if (column > 0)
+            {
+                lines[line].erase(--column, 1);
+            }
+            else if (line > 0)
+            {
+                column = static_cast<int>(lines[line - 1].size());
+                lines[line - 1] += lines[line];
+                lines.erase(lines.begin() + line--);
+            }
+            break;
+        }
+    }
+
+    std::string text() const
+    {
+        std::string result;
+        for (std::size_t i = 0; i < lines.size(); ++i)
+        {
+            if (i > 0)
+                result += '\n';
+            result += toUtf8(lines[i]);
+        }
+        return result;
+    }
+
+    int lineCount() const
+    {
+        return static_cast<int>(lines.size());
+    }
+
+    int lineLength(int lineNumber) const
+    {
+        return static_cast<int>(lines[lineNumber].size());
+    }
+
+    std::u32string_view lineText(int lineNumber) const
+    {
+        return lines[lineNumber];
+    }
+
+    int cursorLine() const
+    {
+        return line;
+    }
+
+    int cursorColumn() const
+    {
+        return column;
+    }
+
+private:
+    void insert(char32_t c)
+    {
+        if (c == U'\n')
+        {
+            lines.insert(lines.begin() + line + 1, lines[line].substr(column));
+            lines[line].erase(column);
+            ++line;
+            column = 0;
+        }
+        else
+        {
+            lines[line].insert(column++, 1, c);
+        }
+    }
+
+    std::vector<std::u32string> lines;
+    int line = 0;
+    int column = 0;
+};
+
+class EditScriptGenerator
+{
+public:
+    EditScriptGenerator(const std::string& document, const EditScriptOptions& options)
+        : options(options), random(options.seed), text(document)
+    {}
+
+    std::vector<EditStep> generate()
+    {
+        while (static_cast<int>(steps.size()) < options.keystrokes)
+        {
+            switch (random.weighted(std::array{ 6.0, 2.0, 1.5, 1.0, 0.3 }))
+            {
+            case 0: appendSentence(); break;
+            case 1: insertInlineTag(); break;
+            case 2: deleteWithBackspace(); break;
+            case 3: startNewParagraph(); break;
+            case 4: pasteListing(); break;
+            }
+        }
+        return std::move(steps);
+    }
+
+private:
+    void add(EditStep step)
+    {
+        text.apply(step);
+        steps.push_back(std::move(step));
+    }
+
+    void moveTo(int line, int column)
+    {
+        if (line != text.cursorLine() || column != text.cursorColumn())
+            add({ .kind = EditStep::Kind::MoveCursor, .delayMs = random.between(400, 3'000), .line = line, .column = column });
+    }
+
+    void moveToEndOfRandomLine()
+    {
+        const int line = static_cast<int>(random.below(text.lineCount()));
+        moveTo(line, text.lineLength(line));
+    }
+
+    /// Somewhere after a space, like when the user clicks between words
+    void moveToRandomWordBoundary()
+    {
+        const int line = static_cast<int>(random.below(text.lineCount()));
+        const auto lineText = text.lineText(line);
+        auto space = lineText.find(U' ', random.below(lineText.size() + 1));
+        moveTo(line, space == std::u32string_view::npos ? static_cast<int>(lineText.size()) : static_cast<int>(space + 1));
+    }
+
+    /// Keystrokes are faster inside of words than between them
+    void type(std::string_view utf8)
+    {
+        for (char32_t c : toUtf32(utf8))
+        {
+            const int delay = c == U' ' ? random.between(120, 450) : random.between(50, 180);
+            add({ .kind = EditStep::Kind::Type, .delayMs = delay, .text = toUtf8(std::u32string(1, c)) });
+        }
+    }
+
+    void backspaces(int count)
+    {
+        for (int i = 0; i < count; ++i)
+            add({ .kind = EditStep::Kind::Backspace, .delayMs = random.between(40, 120) });
+    }
+
+    /// Misspelled words are often noticed and corrected at once
+    void typeWord()
+    {
+        const std::string word{ random.pick(polishWords) };
+        if (!random.chance(options.misspellingRate))
+        {
+            type(word);
+            return;
+        }
+
+        const std::string typo = misspelled(word, random);
+        type(typo);
+        if (random.chance(0.6))
+        {
+            add({ .kind = EditStep::Kind::Backspace, .delayMs = random.between(300, 900) }); // noticing the typo takes a while
+            backspaces(static_cast<int>(toUtf32(typo).size()) - 1);
+            type(word);
+        }
+    }
+
+    void typeWords(int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            if (i > 0)
+                type(" ");
+            typeWord();
+        }
+    }
+
+    void appendSentence()
+    {
+        moveToEndOfRandomLine();
+        type(" ");
+        typeWords(random.between(3, 12));
+        type(".");
+    }
+
+    void insertInlineTag()
+    {
+        moveToRandomWordBoundary();
+        const std::string tag{ random.pick(inlineTags) };
+        type("[" + tag + "]");
+        typeWords(random.between(1, 3));
+        type("[/" + tag + "] ");
+    }
+
+    void deleteWithBackspace()
+    {
+        moveToRandomWordBoundary();
+        backspaces(random.between(1, 15));
+    }
+
+    void startNewParagraph()
+    {
+        moveToEndOfRandomLine();
+        add({ .kind = EditStep::Kind::Newline, .delayMs = random.between(150, 600) });
+        add({ .kind = EditStep::Kind::Newline, .delayMs = random.between(80, 200) });
+        typeWords(random.between(5, 15));
+        type(".");
+    }
+
+    void pasteListing()
+    {
+        moveToEndOfRandomLine();
+        add({ .kind = EditStep::Kind::Newline, .delayMs = random.between(150, 600) });
+
+        std::string listing = "[cpp]\n";
+        for (int i = random.between(3, 15); i > 0; --i)
+            listing += std::string(random.pick(cppLines)) + '\n';
+        listing += "[/cpp]";
+        add({ .kind = EditStep::Kind::Paste, .delayMs = random.between(500, 2'000), .text = listing });
+    }
+
+    const EditScriptOptions& options;
+    Random random;
+    EditedText text;
+    std::vector<EditStep> steps;
+};
+
+std::string escaped(std::string_view text)
+{
+    std::string result;
+    result.reserve(text.size());
+    for (char c : text)
+    {
+        switch (c)
+        {
+        case '\\': result += "\\\\"; break;
+        case '\n': result += "\\n"; break;
+        case '\t': result += "\\t"; break;
+        default: result += c;
+        }
+    }
+    return result;
+}
+
+std::string unescaped(std::string_view text, int lineNumber)
+{
+    std::string result;
+    result.reserve(text.size());
+    for (std::size_t i = 0; i < text.size(); ++i)
+    {
+        if (text[i] != '\\')
+        {
+            result += text[i];
+            continue;
+        }
+        if (++i >= text.size())
+            throw std::runtime_error("Edit script line " + std::to_string(lineNumber) + ": unfinished escape sequence");
+
+        switch (text[i])
+        {
+        case '\\': result += '\\'; break;
+        case 'n': result += '\n'; break;
+        case 't': result += '\t'; break;
+        default: throw std::runtime_error("Edit script line " + std::to_string(lineNumber) + ": unknown escape sequence");
+        }
+    }
+    return result;
+}
+
+std::string_view nextField(std::string_view& rest)
+{
+    const auto end = std::min(rest.find(' '), rest.size());
+    const auto field = rest.substr(0, end);
+    rest.remove_prefix(std::min(end + 1, rest.size()));
+    return field;
+}
+
+int toInt(std::string_view field, int lineNumber)
+{
+    int value = 0;
+    const auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+    if (error != std::errc{} || end != field.data() + field.size())
+        throw std::runtime_error("Edit script line " + std::to_string(lineNumber) + ": expected a number, got '" + std::string(field) + "'");
+    return value;
+}
+} // namespace
+
+std::string generateDocument(const DocumentOptions& options)
+{
+    return DocumentGenerator(options).generate();
+}
+
+std::vector<EditStep> generateEditScript(const std::string& document, const EditScriptOptions& options)
+{
+    return EditScriptGenerator(document, options).generate();
+}
+
+std::string applyEditScript(const std::string& document, const std::vector<EditStep>& steps)
+{
+    EditedText text(document);
+    for (const auto& step : steps)
+        text.apply(step);
+    return text.text();
+}
+
+std::string editScriptToText(const std::vector<EditStep>& steps)
+{
+    std::string result;
+    for (const auto& step : steps)
+    {
+        result += std::to_string(step.delayMs);
+        switch (step.kind)
+        {
+        case EditStep::Kind::MoveCursor:
+            result += " move " + std::to_string(step.line) + " " + std::to_string(step.column);
+            break;
+        case EditStep::Kind::Type:
+            result += " type " + escaped(step.text);
+            break;
+        case EditStep::Kind::Backspace:
+            result += " backspace";
+            break;
+        case EditStep::Kind::Newline:
+            result += " newline";
+            break;
+        case EditStep::Kind::Paste:
+            result += " paste " + escaped(step.text);
+            break;
+        }
+        result += '\n';
+    }
+    return result;
+}
+
+std::vector<EditStep> parseEditScript(std::string_view text)
+{
+    std::vector<EditStep> steps;
+
+    int lineNumber = 0;
+    while (!text.empty())
+    {
+        ++lineNumber;
+        const auto lineEnd = std::min(text.find('\n'), text.size());
+        std::string_view rest = text.substr(0, lineEnd);
+        text.remove_prefix(std::min(lineEnd + 1, text.size()));
+
+        if (rest.empty() || rest.starts_with('#'))
+            continue;
+
+        EditStep step{ .kind = EditStep::Kind::Type };
+        step.delayMs = toInt(nextField(rest), lineNumber);
+
+        const auto command = nextField(rest);
+        if (command == "move")
+        {
+            step.kind = EditStep::Kind::MoveCursor;
+            step.line = toInt(nextField(rest), lineNumber);
+            step.column = toInt(nextField(rest), lineNumber);
+        }
+        else if (command == "type" || command == "paste")
+        {
+            step.kind = command == "type" ? EditStep::Kind::Type : EditStep::Kind::Paste;
+            step.text = unescaped(rest, lineNumber);
+        }
+        else if (command == "backspace")
+        {
+            step.kind = EditStep::Kind::Backspace;
+        }
+        else if (command == "newline")
+        {
+            step.kind = EditStep::Kind::Newline;
+        }
+        else
+        {
+            throw std::runtime_error("Edit script line " + std::to_string(lineNumber) + ": unknown command '" + std::string(command) + "'");
+        }
+        steps.push_back(std::move(step));
+    }
+    return steps;
+}
+} // namespace corpus
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Generates realistic STC documents and edit scripts for performance testing, the same seed gives the same output.
+ *
+ * Documents look like cpp0x.pl articles: Polish prose with some misspellings, inline tags, headers,
+ * nested `[div]` blocks, `[cpp]` listings, `[csv]` tables and `[pkt]` lists. Generated tags are always correctly closed.
+ *
+ * Edit scripts are sequences of keystrokes of a person writing and correcting such a document,
+ * to be replayed against `CodeEditor`. Positions are lines and columns in characters (code points),
+ * which for Polish text are the same as positions in QString.
+ */
+namespace corpus
+{
+/// Relative weights of blocks of the document, 0 disables a kind of block
+struct TagMix
+{
+    double paragraph = 10;
+    double header = 2;
+    double div = 2;      // [div], [div class="tip"] or [div class="uwaga"] with nested blocks
+    double cpp = 2;      // [cpp] listing
+    double csv = 1;      // [csv] table
+    double pkt = 1;      // [pkt] list
+    double image = 1;    // [img] in a separate line
+
+    /// Weight of inline tags ([b], [i], [a href], [run]...) per sentence of a paragraph
+    double inlineTags = 0.4;
+};
+
+struct DocumentOptions
+{
+    std::uint64_t seed = 1;
+    std::size_t targetBytes = 64 * 1024; // the document ends with the first block exceeding it
+    int maxNestingDepth = 2;             // of [div] blocks
+    double misspellingRate = 0.03;       // fraction of misspelled words
+    TagMix mix;
+};
+
+std::string generateDocument(const DocumentOptions& options);
+
+struct EditStep
+{
+    enum class Kind
+    {
+        MoveCursor, // to line and column
+        Type,       // one keystroke inserting text (usually a single character)
+        Backspace,
+        Newline,
+        Paste       // text inserted at once, may contain new lines
+    };
+
+    Kind kind;
+    int delayMs = 0; // pause before the step, like between keystrokes of a person
+    int line = 0;    // for MoveCursor, counted from 0
+    int column = 0;
+    std::string text; // for Type and Paste, UTF-8
+
+    bool operator==(const EditStep&) const = default;
+};
+
+struct EditScriptOptions
+{
+    std::uint64_t seed = 1;
+    int keystrokes = 1'000; // approximate number of steps
+    double misspellingRate = 0.05;
+};
+
+/// Edits are simulated on a copy of the document, so every step is valid for the document at that moment.
+std::vector<EditStep> generateEditScript(const std::string& document, const EditScriptOptions& options);
+
+/// Applies steps to the document the way the editor would do, returns the final text.
+std::string applyEditScript(const std::string& document, const std::vector<EditStep>& steps);
+
+/// One step per line: "<delayMs> move <line> <column>", "<delayMs> type <text>", "<delayMs> backspace",
+/// "<delayMs> newline", "<delayMs> paste <text>", text is escaped with \n, \t and \\.
+std::string editScriptToText(const std::vector<EditStep>& steps);
+
+/// Throws std::runtime_error with the line number if the script is malformed.
+std::vector<EditStep> parseEditScript(std::string_view text);
+} // namespace corpus
@@ -0,0 +1,41 @@
+#include <benchmark/benchmark.h>
+#include "utils/StcHtmlRenderer.h"
+#include "StcCorpus.h"
+
+
+namespace
+{
+std::string makeDocument(std::int64_t bytes)
+{
+    return corpus::generateDocument({ .seed = 7, .targetBytes = static_cast<std::size_t>(bytes) });
+}
+
+void BM_RenderWholeDocument(benchmark::State& state)
+{
+    const std::string document = makeDocument(state.range(0));
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(StcHtmlRenderer::toHtml(document));
+    }
+    state.SetBytesProcessed(state.iterations() * document.size());
+}
+BENCHMARK(BM_RenderWholeDocument)->Arg(64 * 1024)->Arg(1024 * 1024)->Unit(benchmark::kMillisecond);
+
+/// Typing in the middle of the document: only the section with the cursor is rendered again
+void BM_RenderIncrementallyAfterKeystroke(benchmark::State& state)
+{
+    std::string document = makeDocument(state.range(0));
+    StcHtmlRenderer::IncrementalRenderer renderer;
+    renderer.update(document);
+
+    std::size_t cursor = document.find(' ', document.size() / 2);
+    for (auto _ : state)
+    {
+        document.insert(cursor++, 1, 'x');
+        benchmark::DoNotOptimize(renderer.update(document));
+    }
+    state.SetBytesProcessed(state.iterations() * document.size());
+}
+BENCHMARK(BM_RenderIncrementallyAfterKeystroke)->Arg(64 * 1024)->Arg(1024 * 1024)->Unit(benchmark::kMillisecond);
+} // namespace
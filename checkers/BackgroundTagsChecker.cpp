@@ -0,0 +1,67 @@
+#include <QTextDocument>
+#include "BackgroundTagsChecker.h"
+#include "utils/HandlerTimings.h"
+
+
+namespace
+{
+constexpr int debounceMilliseconds = 400;
+} // namespace
+
+
+BackgroundTagsChecker::BackgroundTagsChecker(QTextDocument* document, QObject* parent)
+    : QObject(parent), document(document)
+{
+    worker.setMaxThreadCount(1);
+
+    debounceTimer.setSingleShot(true);
+    debounceTimer.setInterval(debounceMilliseconds);
+    connect(&debounceTimer, &QTimer::timeout, this, &BackgroundTagsChecker::startCheck);
+
+    connect(document, &QTextDocument::contentsChanged, this, &BackgroundTagsChecker::onDocumentChanged);
+}
+
+BackgroundTagsChecker::~BackgroundTagsChecker()
+{
+    worker.clear();
+    worker.waitForDone(); // the result is posted to this object
+}
+
+void BackgroundTagsChecker::setEnabled(bool enabled)
+{
+    this->enabled = enabled;
+    if (enabled)
+    {
+        startCheck();
+    }
+    else
+    {
+        debounceTimer.stop();
+        worker.clear();
+        ++documentVersion; // a check being computed is not needed anymore
+    }
+}
+
+void BackgroundTagsChecker::onDocumentChanged()
+{
+    ++documentVersion;
+    if (enabled)
+        debounceTimer.start();
+}
+
+void BackgroundTagsChecker::startCheck()
+{
+    HANDLER_TIMING("BackgroundTagsChecker::startCheck");
+    debounceTimer.stop();
+    worker.clear(); // a snapshot waiting for the worker is older than this one
+
+    // QTextDocument can be read only from its thread, the conversion to UTF-8 and the check are done by the worker
+    worker.start([this, text = document->toPlainText(), version = documentVersion] {
+        auto errors = PairedTagsChecker::checkTags(text.toStdString());
+
+        QMetaObject::invokeMethod(this, [this, errors = std::move(errors), version] {
+            if (version == documentVersion)
+                emit tagsChecked(errors);
+        }, Qt::QueuedConnection);
+    });
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <QObject>
+#include <QThreadPool>
+#include <QTimer>
+#include "checkers/PairedTagsChecker.h"
+
+class QTextDocument;
+
+/**
+ * @brief Checks if tags of the document are closed while the user types, without blocking the GUI thread.
+ *
+ * Edits are debounced, then a snapshot of the text is checked by a worker thread.
+ * When the document was changed before the result arrived the result is dropped, the next check is already scheduled.
+ */
+class BackgroundTagsChecker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BackgroundTagsChecker(QTextDocument* document, QObject* parent = nullptr);
+    ~BackgroundTagsChecker();
+
+    /// When enabled the document is checked at once and after every edit.
+    void setEnabled(bool enabled);
+    bool isEnabled() const
+    {
+        return enabled;
+    }
+
+signals:
+    void tagsChecked(const std::vector<PairedTagsChecker::TagError>& errors);
+
+private:
+    void onDocumentChanged();
+    void startCheck();
+
+    QTextDocument* document;
+    bool enabled = false;
+
+    std::uint64_t documentVersion = 0; // incremented on every edit, results of older versions are stale
+    QTimer debounceTimer;
+    QThreadPool worker;
+};
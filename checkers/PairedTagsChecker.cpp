@@ -1,103 +1,72 @@
 #include <algorithm>
 #include <vector>
-#include <regex>
 #include <format>
 #include <stack>
 #include "PairedTagsChecker.h"
 using namespace std;
 
+using PairedTagsChecker::Tag;
+
 namespace
 {
-const std::regex tagRegex{R"(\[/?([[:alpha:]][[:alnum:]]*)([^\]]*?)\])"};
-} // namespace
+/// the same as [[:alpha:]] of std::regex in "C" locale
+bool isAlpha(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
 
-struct Tag
+bool isAlnum(char c)
 {
-    std::string tagShortname;
-    std::string tagFull;
-    std::vector<std::string> attributes;
-    unsigned line{}, startingPositionInLine{};
+    return isAlpha(c) || (c >= '0' && c <= '9');
+}
 
-    std::string toString() const
-    {
-        return format("{}.{}: Tag({}: {}: {})", line, startingPositionInLine, tagShortname, tagFull, attributes2String());
-    }
-    std::string attributes2String() const
+void extractTagsFromLine(std::string_view line, int lineNumber, std::vector<Tag>& tags)
+{
+    for (std::string_view::size_type start = line.find('['); start != std::string_view::npos; start = line.find('[', start))
     {
-        std::string attributesAsString;
-        for (const auto& attribute : attributes)
+        auto nameStart = start + 1;
+        if (nameStart < line.size() && line[nameStart] == '/')
+            ++nameStart;
+
+        if (nameStart >= line.size() || !isAlpha(line[nameStart]))
         {
-            attributesAsString += ">" + attribute + "< ";
+            ++start;
+            continue;
         }
-        return attributesAsString;
-    }
 
-    bool isOpening() const
-    {
-        return ! isClosing();
-    }
-    bool isClosing() const
-    {
-        return tagFull[1] == '/'; // TODO: consider using regex
-    }
-};
+        auto nameEnd = nameStart + 1;
+        while (nameEnd < line.size() && isAlnum(line[nameEnd]))
+            ++nameEnd;
 
-std::vector<std::string_view> splitLines(const std::string& text)
-{
-    std::vector<std::string_view> lines;
-    std::string::size_type start = 0;
-    std::string::size_type end;
+        const auto end = line.find(']', nameEnd); // attributes are everything up to the first ']'
+        if (end == std::string_view::npos)
+            return; // none of the following '[' has its ']' either
 
-    while ((end = text.find('\n', start)) != std::string::npos)
-    {
-        lines.emplace_back(text.data() + start, end - start);
+        tags.push_back(Tag{
+            .tagShortname = line.substr(nameStart, nameEnd - nameStart),
+            .tagFull = line.substr(start, end + 1 - start),
+            .line = lineNumber,
+            .startingPositionInLine = static_cast<int>(start)
+        });
         start = end + 1;
     }
-    lines.emplace_back(text.data() + start, text.size() - start);
-
-    return lines;
 }
+} // namespace
 
-std::vector<Tag> extractTags(const std::vector<std::string_view>& lines)
+std::vector<Tag> PairedTagsChecker::extractTags(std::string_view text)
 {
     std::vector<Tag> tags;
 
-    for (int lineNumber = 0; lineNumber < lines.size(); ++lineNumber)
+    int lineNumber = 1;
+    std::string_view::size_type lineStart = 0;
+    for (auto lineEnd = text.find('\n'); ; lineEnd = text.find('\n', lineStart), ++lineNumber)
     {
-        std::string lineStr{lines[lineNumber]};
-        auto searchStart = lineStr.cbegin();
+        const auto length = (lineEnd == std::string_view::npos ? text.size() : lineEnd) - lineStart;
+        extractTagsFromLine(text.substr(lineStart, length), lineNumber, tags);
 
-        while (searchStart != lineStr.cend())
-        {
-            std::smatch match;
-            if (std::regex_search(searchStart, lineStr.cend(), match, tagRegex))
-            {
-                Tag tag;
-                tag.tagFull = match[0];
-                tag.tagShortname = match[1];
-
-                std::string attributesStr = match[2];
-                std::regex attrRegex{R"(\s*([[:alpha:]]+)=['"]?([^'"]+)['"]?)"};
-                std::smatch attrMatch;
-
-                auto attrSearchStart = attributesStr.cbegin();
-                while (std::regex_search(attrSearchStart, attributesStr.cend(), attrMatch, attrRegex))
-                {
-                    tag.attributes.emplace_back(attrMatch[1].str() + "=" + attrMatch[2].str());
-                    attrSearchStart = attrMatch.suffix().first;
-                }
-
-                tag.line = lineNumber + 1;
-                tag.startingPositionInLine = match.position(0);
-                tags.emplace_back(std::move(tag));
-
-                searchStart = match.suffix().first;
-            }
-            else
-            {
-                break;
-            }
-        }
+        if (lineEnd == std::string_view::npos)
+            break;
+        lineStart = lineEnd + 1;
     }
 
     return tags;
@@ -183,8 +152,7 @@ std::vector<PairedTagsChecker::TagError> checkIfAllTagsAreClosed(const std::vect
 
 std::vector<PairedTagsChecker::TagError> PairedTagsChecker::checkTags(const std::string& text)
 {
-    const auto lines = splitLines(text);
-    const auto tags = extractTags(lines);
+    const auto tags = extractTags(text);
 
     return checkIfAllTagsAreClosed(tags);
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <tuple>
 #include <vector>
 
 namespace PairedTagsChecker
@@ -16,5 +18,25 @@ struct TagError
     }
 };
 
+struct Tag
+{
+    std::string_view tagShortname;
+    std::string_view tagFull;
+    int line{}, startingPositionInLine{};
+
+    bool isOpening() const
+    {
+        return ! isClosing();
+    }
+    bool isClosing() const
+    {
+        return tagFull[1] == '/';
+    }
+};
+
+/// Finds `[name attributes]` and `[/name]` in every line, the same as `\[/?([[:alpha:]][[:alnum:]]*)([^\]]*?)\]` would do.
+/// Returned views point into the text, lines and positions (in bytes) are counted like in TagError.
+std::vector<Tag> extractTags(std::string_view text);
+
 std::vector<TagError> checkTags(const std::string& text);
 };
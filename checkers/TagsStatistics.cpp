@@ -0,0 +1,298 @@
+#include <algorithm>
+#include <utility>
+#include "TagsStatistics.h"
+#include "PairedTagsChecker.h"
+
+using TagsStatistics::ChunkCounts;
+using TagsStatistics::Counts;
+using TagsStatistics::TagRecord;
+
+namespace
+{
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+char toLower(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool equalsIgnoringCase(std::string_view a, std::string_view b)
+{
+    return std::ranges::equal(a, b, {}, toLower, toLower);
+}
+
+bool isCodeTag(std::string_view tagName)
+{
+    for (std::string_view codeTag : { "cpp", "code", "py", "log" })
+    {
+        if (equalsIgnoringCase(tagName, codeTag))
+            return true;
+    }
+    return false;
+}
+
+bool isWordCharacter(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+bool hasText(std::string_view text)
+{
+    return !std::ranges::all_of(text, isSpace);
+}
+
+std::string_view trimmed(std::string_view text)
+{
+    while (!text.empty() && isSpace(text.front()))
+        text.remove_prefix(1);
+    while (!text.empty() && isSpace(text.back()))
+        text.remove_suffix(1);
+    return text;
+}
+
+std::string lowercase(std::string_view text)
+{
+    std::string lower(text);
+    std::ranges::transform(lower, lower.begin(), toLower);
+    return lower;
+}
+
+/// "TODO" as a whole word (not next to a letter, digit or "_"), case insensitive
+bool containsTodo(std::string_view line)
+{
+    constexpr std::string_view todo = "todo";
+    for (std::size_t start = 0; start + todo.size() <= line.size(); ++start)
+    {
+        const std::size_t end = start + todo.size();
+        if (equalsIgnoringCase(line.substr(start, todo.size()), todo)
+            && (start == 0 || !isWordCharacter(line[start - 1])) && (end == line.size() || !isWordCharacter(line[end])))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string codeLanguage(std::string_view codeTagName, std::string_view tagFull)
+{
+    if (codeTagName == "cpp")
+        return "C++";
+    if (codeTagName == "py")
+        return "Python";
+    if (codeTagName == "code")
+    {
+        const std::string_view src = trimmed(TagsStatistics::attributeValue(tagFull, "src").value_or(""));
+        if (equalsIgnoringCase(src, "c++"))
+            return "C++";
+        return src.empty() ? "code" : std::string(src);
+    }
+    return std::string(codeTagName);
+}
+
+std::optional<TagRecord::Kind> countedKind(std::string_view tagName)
+{
+    constexpr std::pair<std::string_view, TagRecord::Kind> counted[] = {
+        { "h1", TagRecord::Kind::H1 },     { "h2", TagRecord::Kind::H2 },   { "h3", TagRecord::Kind::H3 },
+        { "h4", TagRecord::Kind::H4 },     { "a", TagRecord::Kind::Link },  { "div", TagRecord::Kind::Div },
+        { "img", TagRecord::Kind::Image }, { "csv", TagRecord::Kind::Table }
+    };
+    for (const auto& [name, kind] : counted)
+    {
+        if (equalsIgnoringCase(tagName, name))
+            return kind;
+    }
+    return std::nullopt;
+}
+
+void countLine(std::string_view line, int lineNumber, ChunkCounts& chunk)
+{
+    Counts& counts = chunk.counts;
+    bool insideWord = false;
+    for (char c : line)
+    {
+        if ((static_cast<unsigned char>(c) & 0xC0) != 0x80) // not a continuation byte of UTF-8
+            ++counts.charCount;
+
+        const bool space = isSpace(c);
+        if (!space && !insideWord)
+            ++counts.wordCount;
+        insideWord = !space;
+    }
+    counts.todoCount += containsTodo(line);
+
+    for (const auto& tag : PairedTagsChecker::extractTags(line))
+    {
+        const auto name = tag.tagShortname;
+        if (isCodeTag(name))
+        {
+            const auto tagStart = static_cast<std::size_t>(tag.startingPositionInLine);
+            TagRecord record{ .kind = TagRecord::Kind::Code, .closing = tag.isClosing(), .line = lineNumber, .codeTagName = lowercase(name) };
+            record.textBefore = hasText(line.substr(0, tagStart));
+            record.textAfter = hasText(line.substr(tagStart + tag.tagFull.size()));
+            if (!record.closing)
+                record.codeLanguage = codeLanguage(record.codeTagName, tag.tagFull);
+            chunk.tags.push_back(std::move(record));
+            continue;
+        }
+
+        const auto kind = countedKind(name);
+        if (tag.isClosing() || !kind)
+            continue;
+        if (*kind == TagRecord::Kind::Link || *kind == TagRecord::Kind::Image)
+        {
+            const auto target = TagsStatistics::attributeValue(tag.tagFull, *kind == TagRecord::Kind::Link ? "href" : "src");
+            if (!target || target->empty())
+                continue;
+        }
+        chunk.tags.push_back({ .kind = *kind, .line = lineNumber });
+    }
+}
+} // namespace
+
+Counts& Counts::operator+=(const Counts& other)
+{
+    lineCount += other.lineCount;
+    charCount += other.charCount;
+    wordCount += other.wordCount;
+    h1Count += other.h1Count;
+    h2Count += other.h2Count;
+    h3Count += other.h3Count;
+    h4Count += other.h4Count;
+    cppCodeCount += other.cppCodeCount;
+    linkCount += other.linkCount;
+    divCount += other.divCount;
+    imageCount += other.imageCount;
+    tableCount += other.tableCount;
+    todoCount += other.todoCount;
+    for (const auto& [language, lines] : other.codeLinesPerLanguage)
+        codeLinesPerLanguage[language] += lines;
+    return *this;
+}
+
+ChunkCounts TagsStatistics::countChunk(std::string_view chunk)
+{
+    ChunkCounts counts;
+    int lineNumber = 0;
+    for (std::size_t lineStart = 0; lineStart < chunk.size(); ++lineNumber)
+    {
+        std::size_t lineEnd = chunk.find('\n', lineStart);
+        if (lineEnd == std::string_view::npos)
+        {
+            lineEnd = chunk.size();
+        }
+        else
+        {
+            ++counts.newLines;
+            ++counts.counts.charCount;
+        }
+
+        countLine(chunk.substr(lineStart, lineEnd - lineStart), lineNumber, counts);
+        lineStart = lineEnd + 1;
+    }
+    return counts;
+}
+
+using TagsStatistics::Accumulator;
+
+void Accumulator::add(const ChunkCounts& chunk)
+{
+    counts.charCount += chunk.counts.charCount;
+    counts.wordCount += chunk.counts.wordCount;
+    counts.todoCount += chunk.counts.todoCount;
+
+    for (const TagRecord& tag : chunk.tags)
+    {
+        const int line = linesBefore + tag.line;
+        if (!openedCodeTag.empty())
+        {
+            if (tag.closing && tag.codeTagName == openedCodeTag)
+                closeCodeBlock(tag.textBefore ? line : line - 1);
+            continue;
+        }
+        if (tag.closing)
+            continue;
+
+        switch (tag.kind)
+        {
+        case TagRecord::Kind::H1: ++counts.h1Count; break;
+        case TagRecord::Kind::H2: ++counts.h2Count; break;
+        case TagRecord::Kind::H3: ++counts.h3Count; break;
+        case TagRecord::Kind::H4: ++counts.h4Count; break;
+        case TagRecord::Kind::Link: ++counts.linkCount; break;
+        case TagRecord::Kind::Div: ++counts.divCount; break;
+        case TagRecord::Kind::Image: ++counts.imageCount; break;
+        case TagRecord::Kind::Table: ++counts.tableCount; break;
+        case TagRecord::Kind::Code:
+            openedCodeTag = tag.codeTagName;
+            openedCodeLanguage = tag.codeLanguage;
+            firstCodeLine = tag.textAfter ? line : line + 1;
+            counts.cppCodeCount += tag.codeLanguage == "C++";
+            break;
+        }
+    }
+
+    linesBefore += chunk.newLines;
+}
+
+Counts Accumulator::finish() &&
+{
+    if (!openedCodeTag.empty()) // not closed till the end of the text
+        closeCodeBlock(linesBefore);
+    counts.lineCount = linesBefore + 1;
+    return std::move(counts);
+}
+
+void Accumulator::closeCodeBlock(int lastCodeLine)
+{
+    counts.codeLinesPerLanguage[openedCodeLanguage] += std::max(0, lastCodeLine - firstCodeLine + 1);
+    openedCodeTag.clear();
+}
+
+Counts TagsStatistics::count(std::string_view text)
+{
+    Accumulator accumulator;
+    accumulator.add(countChunk(text));
+    return std::move(accumulator).finish();
+}
+
+std::optional<std::string_view> TagsStatistics::attributeValue(std::string_view tagFull, std::string_view attributeName)
+{
+    const auto isNameAt = [&](std::size_t position) {
+        return equalsIgnoringCase(tagFull.substr(position, attributeName.size()), attributeName);
+    };
+
+    for (std::size_t nameStart = 1; nameStart + attributeName.size() <= tagFull.size(); ++nameStart)
+    {
+        if (!isSpace(tagFull[nameStart - 1]) || !isNameAt(nameStart))
+            continue;
+
+        auto i = nameStart + attributeName.size();
+        while (i < tagFull.size() && isSpace(tagFull[i]))
+            ++i;
+        if (i >= tagFull.size() || tagFull[i] != '=')
+            continue;
+        ++i;
+        while (i < tagFull.size() && isSpace(tagFull[i]))
+            ++i;
+
+        const auto valueEndOfTag = tagFull.ends_with(']') ? tagFull.size() - 1 : tagFull.size();
+        if (i >= valueEndOfTag)
+            return std::string_view{};
+
+        const char quote = tagFull[i];
+        if (quote == '"' || quote == '\'')
+        {
+            const auto valueEnd = std::min(tagFull.find(quote, i + 1), valueEndOfTag);
+            return tagFull.substr(i + 1, valueEnd - i - 1);
+        }
+
+        auto valueEnd = i;
+        while (valueEnd < valueEndOfTag && !isSpace(tagFull[valueEnd]))
+            ++valueEnd;
+        return tagFull.substr(i, valueEnd - i);
+    }
+    return std::nullopt;
+}
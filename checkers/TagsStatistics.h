@@ -0,0 +1,98 @@
+#pragma once
+
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief The counters of `DocumentStatisticsResult`, but computed from UTF-8 text without Qt, eg. for command line tools.
+ *
+ * A long text can be counted in chunks ending at ends of lines, in parallel, then the chunks are added in the order
+ * of the text. Whether tags of a chunk are inside of code is known only then, so a chunk keeps its tags for later.
+ */
+namespace TagsStatistics
+{
+struct Counts
+{
+    int lineCount = 0;
+    int charCount = 0; // code points
+    int wordCount = 0;
+
+    int h1Count = 0;
+    int h2Count = 0;
+    int h3Count = 0;
+    int h4Count = 0;
+
+    int cppCodeCount = 0;
+    int linkCount = 0;
+    int divCount = 0;
+    int imageCount = 0;
+    int tableCount = 0; // [csv]
+    int todoCount = 0;  // lines with TODO
+
+    std::map<std::string, int> codeLinesPerLanguage; // eg. "C++", "Python", or src of [code]
+
+    Counts& operator+=(const Counts& other);
+    bool operator==(const Counts& other) const = default;
+};
+
+/// A tag which may be counted (or a code tag), the line is counted from the beginning of its chunk
+struct TagRecord
+{
+    enum class Kind
+    {
+        H1,
+        H2,
+        H3,
+        H4,
+        Link,
+        Div,
+        Image,
+        Table,
+        Code
+    };
+
+    Kind kind = Kind::Code;
+    bool closing = false; // only code tags are recorded when closing
+    int line = 0;
+    std::string codeTagName;  // lowercase
+    std::string codeLanguage; // of opening code tags
+    bool textBefore = false;  // non whitespace text in the line before or after a code tag decides if the line is a line of code
+    bool textAfter = false;
+};
+
+struct ChunkCounts
+{
+    int newLines = 0;
+    Counts counts; // of characters, words and TODOs only
+    std::vector<TagRecord> tags;
+};
+
+ChunkCounts countChunk(std::string_view chunk);
+
+/// Adds chunks in the order of the text, then gives the counts of all of it
+class Accumulator
+{
+public:
+    void add(const ChunkCounts& chunk);
+
+    Counts finish() &&;
+
+private:
+    void closeCodeBlock(int lastCodeLine);
+
+    Counts counts;
+    int linesBefore = 0;       // lines of the already added chunks
+    std::string openedCodeTag; // tags inside of code are not STC
+    std::string openedCodeLanguage;
+    int firstCodeLine = 0;
+};
+
+/// All of the text as one chunk
+Counts count(std::string_view text);
+
+/// Value of `name="value"` (or with '' or without quotes) from the text of a tag, like `stc::attributeValue`.
+std::optional<std::string_view> attributeValue(std::string_view tagFull, std::string_view attributeName);
+};
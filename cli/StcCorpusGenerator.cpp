@@ -0,0 +1,225 @@
+/// stc-corpus: generates reproducible STC documents (and edit scripts replaying typing into them) for performance testing.
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "benchmarks/StcCorpus.h"
+
+namespace
+{
+struct Options
+{
+    corpus::DocumentOptions document;
+    std::optional<corpus::EditScriptOptions> editScript;
+    std::string outputFile;     // stdout when empty
+    std::string editScriptFile;
+};
+
+void printUsage(std::ostream& os)
+{
+    os << "Usage: stc-corpus [options]\n"
+          "Generates an STC document, the same options and seed always give the same document.\n"
+          "\n"
+          "Options:\n"
+          "  --seed N                 seed of the generator (default: 1)\n"
+          "  --size N[K|M]            size of the document in bytes, eg. 1K, 50M (default: 64K)\n"
+          "  --depth N                maximal nesting of [div] blocks (default: 2)\n"
+          "  --misspellings R         fraction of misspelled words (default: 0.03)\n"
+          "  --mix kind=W,...         weights of blocks: paragraph, header, div, cpp, csv, pkt, image, inline\n"
+          "  -o FILE                  write the document to the file instead of standard output\n"
+          "  --edit-script FILE       write also a script of keystrokes editing the document\n"
+          "  --keystrokes N           length of the edit script (default: 1000)\n"
+          "  -h, --help               show this help\n";
+}
+
+template <typename Number>
+std::optional<Number> parseNumber(std::string_view text)
+{
+    Number value{};
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc{} || end != text.data() + text.size())
+        return std::nullopt;
+    return value;
+}
+
+std::optional<std::size_t> parseSize(std::string_view text)
+{
+    std::size_t multiplier = 1;
+    if (text.ends_with('K') || text.ends_with('k'))
+        multiplier = 1024;
+    else if (text.ends_with('M') || text.ends_with('m'))
+        multiplier = 1024 * 1024;
+    if (multiplier > 1)
+        text.remove_suffix(1);
+
+    const auto size = parseNumber<std::size_t>(text);
+    return size ? std::optional(*size * multiplier) : std::nullopt;
+}
+
+bool parseMix(std::string_view text, corpus::TagMix& mix)
+{
+    while (!text.empty())
+    {
+        const auto itemEnd = std::min(text.find(','), text.size());
+        const auto item = text.substr(0, itemEnd);
+        text.remove_prefix(std::min(itemEnd + 1, text.size()));
+
+        const auto equals = item.find('=');
+        if (equals == std::string_view::npos)
+            return false;
+        const auto name = item.substr(0, equals);
+        const auto weight = parseNumber<double>(item.substr(equals + 1));
+        if (!weight || *weight < 0)
+            return false;
+
+        if (name == "paragraph") mix.paragraph = *weight;
+        else if (name == "header") mix.header = *weight;
+        else if (name == "div") mix.div = *weight;
+        else if (name == "cpp") mix.cpp = *weight;
+        else if (name == "csv") mix.csv = *weight;
+        else if (name == "pkt") mix.pkt = *weight;
+        else if (name == "image") mix.image = *weight;
+        else if (name == "inline") mix.inlineTags = *weight;
+        else return false;
+    }
+    return true;
+}
+
+std::optional<Options> parseArguments(int argc, char* argv[])
+{
+    Options options;
+    int keystrokes = corpus::EditScriptOptions{}.keystrokes;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view argument = argv[i];
+        if (argument == "-h" || argument == "--help")
+        {
+            printUsage(std::cout);
+            std::exit(0);
+        }
+
+        // all the other options have a value
+        static constexpr std::array<std::string_view, 8> optionsWithValue = { "--seed", "--size", "--depth", "--misspellings", "--mix", "-o", "--edit-script", "--keystrokes" };
+        if (std::ranges::find(optionsWithValue, argument) == optionsWithValue.end())
+        {
+            std::cerr << "stc-corpus: unknown option " << argument << "\n";
+            return std::nullopt;
+        }
+        if (i + 1 >= argc)
+        {
+            std::cerr << "stc-corpus: missing value of " << argument << "\n";
+            return std::nullopt;
+        }
+
+        const std::string_view value = argv[++i];
+        const auto invalid = [&argument, &value] {
+            std::cerr << "stc-corpus: invalid value of " << argument << ": '" << value << "'\n";
+            return std::nullopt;
+        };
+
+        if (argument == "--seed")
+        {
+            const auto seed = parseNumber<std::uint64_t>(value);
+            if (!seed)
+                return invalid();
+            options.document.seed = *seed;
+        }
+        else if (argument == "--size")
+        {
+            const auto size = parseSize(value);
+            if (!size)
+                return invalid();
+            options.document.targetBytes = *size;
+        }
+        else if (argument == "--depth")
+        {
+            const auto depth = parseNumber<int>(value);
+            if (!depth || *depth < 0)
+                return invalid();
+            options.document.maxNestingDepth = *depth;
+        }
+        else if (argument == "--misspellings")
+        {
+            const auto rate = parseNumber<double>(value);
+            if (!rate || *rate < 0 || *rate > 1)
+                return invalid();
+            options.document.misspellingRate = *rate;
+        }
+        else if (argument == "--mix")
+        {
+            if (!parseMix(value, options.document.mix))
+                return invalid();
+        }
+        else if (argument == "-o")
+        {
+            if (value.empty())
+                return invalid();
+            options.outputFile = value;
+        }
+        else if (argument == "--edit-script")
+        {
+            if (value.empty())
+                return invalid();
+            options.editScriptFile = value;
+        }
+        else if (argument == "--keystrokes")
+        {
+            const auto count = parseNumber<int>(value);
+            if (!count || *count < 0)
+                return invalid();
+            keystrokes = *count;
+        }
+    }
+
+    if (!options.editScriptFile.empty())
+    {
+        options.editScript = corpus::EditScriptOptions{
+            .seed = options.document.seed,
+            .keystrokes = keystrokes,
+            .misspellingRate = options.document.misspellingRate,
+        };
+    }
+    return options;
+}
+
+bool writeFile(const std::string& fileName, const std::string& content)
+{
+    std::ofstream file(fileName, std::ios::binary);
+    if (!file.write(content.data(), static_cast<std::streamsize>(content.size())))
+    {
+        std::cerr << "stc-corpus: cannot write " << fileName << "\n";
+        return false;
+    }
+    return true;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const auto options = parseArguments(argc, argv);
+    if (!options)
+    {
+        printUsage(std::cerr);
+        return 2;
+    }
+
+    const std::string document = corpus::generateDocument(options->document);
+    if (options->outputFile.empty())
+        std::cout.write(document.data(), static_cast<std::streamsize>(document.size()));
+    else if (!writeFile(options->outputFile, document))
+        return 1;
+
+    if (options->editScript)
+    {
+        const auto steps = corpus::generateEditScript(document, *options->editScript);
+        if (!writeFile(options->editScriptFile, "# stc-corpus edit script, seed " + std::to_string(options->editScript->seed) + "\n"
+                                                    + corpus::editScriptToText(steps)))
+            return 1;
+    }
+    return 0;
+}
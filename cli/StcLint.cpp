@@ -0,0 +1,394 @@
+/// stc-lint: checks STC files of a whole directory tree without GUI, diagnostics are printed in a machine-readable format.
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "checkers/PairedTagsChecker.h"
+#include "checkers/TagsStatistics.h"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+enum class OutputFormat
+{
+    Gcc,  // path:line:column: error: message, understood by editors and CI annotations
+    Json  // one JSON object per file (JSON Lines)
+};
+
+struct Options
+{
+    std::vector<fs::path> paths;
+    std::set<std::string> extensions = { ".stc", ".txt" };
+    unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+    OutputFormat format = OutputFormat::Gcc;
+    bool statistics = false;
+};
+
+struct FileReport
+{
+    std::vector<PairedTagsChecker::TagError> errors;
+    TagsStatistics::Counts counts;
+    std::string readError;
+};
+
+/**
+ * @brief Runs tasks of known indices on threads which steal work from each other.
+ *
+ * Every thread starts with its own queue, takes tasks from its front and, when its queue is empty,
+ * steals from the back of the queues of other threads. So one thread busy with a huge file does not delay the others.
+ */
+class WorkStealingPool
+{
+public:
+    explicit WorkStealingPool(unsigned threadsCount)
+        : queues(std::max(1u, threadsCount))
+    {}
+
+    /// Tasks are given to the threads in turns, so the tasks sorted from the biggest are spread evenly.
+    void run(std::size_t tasksCount, const std::function<void(std::size_t)>& task)
+    {
+        for (std::size_t i = 0; i < tasksCount; ++i)
+            queues[i % queues.size()].tasks.push_back(i);
+
+        std::vector<std::jthread> threads;
+        threads.reserve(queues.size());
+        for (std::size_t self = 0; self < queues.size(); ++self)
+        {
+            threads.emplace_back([this, self, &task] {
+                while (const auto index = nextTask(self))
+                    task(*index);
+            });
+        }
+    }
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<std::size_t> tasks;
+    };
+
+    std::optional<std::size_t> nextTask(std::size_t self)
+    {
+        if (auto index = takeFrom(queues[self], /*fromFront=*/true))
+            return index;
+
+        for (std::size_t offset = 1; offset < queues.size(); ++offset)
+        {
+            if (auto index = takeFrom(queues[(self + offset) % queues.size()], /*fromFront=*/false))
+                return index;
+        }
+        return std::nullopt; // no new tasks are added while running, so all the work is done
+    }
+
+    static std::optional<std::size_t> takeFrom(Queue& queue, bool fromFront)
+    {
+        std::lock_guard lock(queue.mutex);
+        if (queue.tasks.empty())
+            return std::nullopt;
+
+        std::size_t index;
+        if (fromFront)
+        {
+            index = queue.tasks.front();
+            queue.tasks.pop_front();
+        }
+        else
+        {
+            index = queue.tasks.back();
+            queue.tasks.pop_back();
+        }
+        return index;
+    }
+
+    std::vector<Queue> queues;
+};
+
+void printUsage(std::ostream& os)
+{
+    os << "Usage: stc-lint [options] [paths...]\n"
+          "Checks if tags are closed in STC files, directories are searched recursively (default: current directory).\n"
+          "\n"
+          "Options:\n"
+          "  -j, --jobs N          number of threads (default: number of cores)\n"
+          "  --format gcc|json     gcc: 'path:line:column: error: message' (default), json: one object per file\n"
+          "  --stats               print also statistics of files like in the editor's file statistics\n"
+          "  --ext .stc,.txt       extensions of files checked in directories\n"
+          "  -h, --help            show this help\n"
+          "\n"
+          "Exit status: 0 if no errors were found, 1 if there were errors, 2 on invalid usage or unreadable files.\n";
+}
+
+std::optional<Options> parseArguments(int argc, char* argv[])
+{
+    Options options;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view argument = argv[i];
+        auto value = [&]() -> std::optional<std::string_view> {
+            if (i + 1 >= argc)
+            {
+                std::cerr << "stc-lint: missing value of " << argument << "\n";
+                return std::nullopt;
+            }
+            return argv[++i];
+        };
+
+        if (argument == "-h" || argument == "--help")
+        {
+            printUsage(std::cout);
+            std::exit(0);
+        }
+        else if (argument == "-j" || argument == "--jobs")
+        {
+            const auto jobs = value();
+            if (!jobs)
+                return std::nullopt;
+            unsigned parsed = 0;
+            const auto [end, error] = std::from_chars(jobs->data(), jobs->data() + jobs->size(), parsed);
+            if (error != std::errc{} || end != jobs->data() + jobs->size() || parsed == 0)
+            {
+                std::cerr << "stc-lint: invalid number of jobs: " << *jobs << "\n";
+                return std::nullopt;
+            }
+            options.jobs = parsed;
+        }
+        else if (argument == "--format")
+        {
+            const auto format = value();
+            if (!format)
+                return std::nullopt;
+            if (format == "gcc")
+                options.format = OutputFormat::Gcc;
+            else if (format == "json")
+                options.format = OutputFormat::Json;
+            else
+            {
+                std::cerr << "stc-lint: unknown format, expected gcc or json\n";
+                return std::nullopt;
+            }
+        }
+        else if (argument == "--stats")
+        {
+            options.statistics = true;
+        }
+        else if (argument == "--ext")
+        {
+            const auto extensions = value();
+            if (!extensions)
+                return std::nullopt;
+            options.extensions.clear();
+            std::istringstream list{std::string(*extensions)};
+            for (std::string extension; std::getline(list, extension, ',');)
+            {
+                if (!extension.empty())
+                    options.extensions.insert(extension.starts_with('.') ? extension : "." + extension);
+            }
+        }
+        else if (argument.starts_with('-') && argument.size() > 1)
+        {
+            std::cerr << "stc-lint: unknown option " << argument << "\n";
+            return std::nullopt;
+        }
+        else
+        {
+            options.paths.emplace_back(argument);
+        }
+    }
+
+    if (options.paths.empty())
+        options.paths.emplace_back(".");
+    return options;
+}
+
+/// Files given explicitly are always checked, in directories only files with the extensions
+std::vector<fs::path> collectFiles(const Options& options)
+{
+    std::vector<fs::path> files;
+    for (const auto& path : options.paths)
+    {
+        std::error_code error;
+        if (!fs::is_directory(path, error))
+        {
+            files.push_back(path);
+            continue;
+        }
+
+        for (auto it = fs::recursive_directory_iterator(path, fs::directory_options::skip_permission_denied, error);
+             it != fs::recursive_directory_iterator(); it.increment(error))
+        {
+            if (error)
+                break;
+            if (it->is_regular_file(error) && options.extensions.contains(it->path().extension().string()))
+                files.push_back(it->path());
+        }
+    }
+
+    std::ranges::sort(files);
+    files.erase(std::ranges::unique(files).begin(), files.end());
+    return files;
+}
+
+FileReport checkFile(const fs::path& path, bool withStatistics)
+{
+    FileReport report;
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        report.readError = "cannot open file";
+        return report;
+    }
+    const std::string text{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+
+    report.errors = PairedTagsChecker::checkTags(text);
+    if (withStatistics)
+        report.counts = TagsStatistics::count(text);
+    return report;
+}
+
+std::string jsonEscaped(std::string_view text)
+{
+    std::string escaped;
+    escaped.reserve(text.size() + 2);
+    for (char c : text)
+    {
+        switch (c)
+        {
+        case '"': escaped += "\\\""; break;
+        case '\\': escaped += "\\\\"; break;
+        case '\n': escaped += "\\n"; break;
+        case '\r': escaped += "\\r"; break;
+        case '\t': escaped += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+                escaped += std::format("\\u{:04x}", static_cast<int>(c));
+            else
+                escaped += c;
+        }
+    }
+    return escaped;
+}
+
+std::string statisticsAsJson(const TagsStatistics::Counts& counts)
+{
+    return std::format(R"({{"lines":{},"chars":{},"words":{},"h1":{},"h2":{},"h3":{},"cppCodes":{},"links":{},"divs":{},"images":{}}})",
+                       counts.lineCount, counts.charCount, counts.wordCount, counts.h1Count, counts.h2Count, counts.h3Count,
+                       counts.cppCodeCount, counts.linkCount, counts.divCount, counts.imageCount);
+}
+
+/// Columns are counted from 1 like in compilers, positions of TagError are byte offsets counted from 0.
+std::string formatReport(const fs::path& path, const FileReport& report, const Options& options)
+{
+    const std::string fileName = path.generic_string();
+    std::string output;
+
+    if (options.format == OutputFormat::Json)
+    {
+        output = std::format(R"({{"file":"{}")", jsonEscaped(fileName));
+        if (!report.readError.empty())
+            output += std::format(R"(,"readError":"{}")", jsonEscaped(report.readError));
+
+        output += R"(,"errors":[)";
+        for (bool first = true; const auto& error : report.errors)
+        {
+            output += std::format(R"({}{{"line":{},"column":{},"message":"{}"}})", first ? "" : ",",
+                                  error.line, error.positionInLine + 1, jsonEscaped(error.errorText));
+            first = false;
+        }
+        output += "]";
+
+        if (options.statistics && report.readError.empty())
+            output += R"(,"statistics":)" + statisticsAsJson(report.counts);
+        output += "}\n";
+        return output;
+    }
+
+    if (!report.readError.empty())
+        return std::format("{}: error: {}\n", fileName, report.readError);
+
+    for (const auto& error : report.errors)
+        output += std::format("{}:{}:{}: error: {}\n", fileName, error.line, error.positionInLine + 1, error.errorText);
+
+    if (options.statistics)
+    {
+        const auto& c = report.counts;
+        output += std::format("{}: note: lines={} chars={} words={} h1={} h2={} h3={} cppCodes={} links={} divs={} images={}\n",
+                              fileName, c.lineCount, c.charCount, c.wordCount, c.h1Count, c.h2Count, c.h3Count,
+                              c.cppCodeCount, c.linkCount, c.divCount, c.imageCount);
+    }
+    return output;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::ios::sync_with_stdio(false);
+
+    const auto options = parseArguments(argc, argv);
+    if (!options)
+    {
+        printUsage(std::cerr);
+        return 2;
+    }
+
+    const auto startTime = std::chrono::steady_clock::now();
+
+    std::vector<fs::path> files = collectFiles(*options);
+
+    // the biggest files first, so none of them is left alone at the end
+    std::vector<std::uintmax_t> sizes(files.size());
+    std::vector<std::size_t> order(files.size());
+    for (std::size_t i = 0; i < files.size(); ++i)
+    {
+        std::error_code error;
+        sizes[i] = fs::file_size(files[i], error);
+        order[i] = i;
+    }
+    std::ranges::sort(order, std::greater{}, [&sizes](std::size_t i) { return sizes[i]; });
+
+    std::vector<FileReport> reports(files.size());
+    const auto threadsCount = static_cast<unsigned>(std::clamp<std::size_t>(files.size(), 1, options->jobs));
+    WorkStealingPool pool(threadsCount);
+    pool.run(order.size(), [&](std::size_t task) {
+        const std::size_t i = order[task];
+        reports[i] = checkFile(files[i], options->statistics);
+    });
+
+    // printed in the order of paths, so the output does not depend on the threads
+    std::size_t errorsCount = 0, unreadableCount = 0;
+    TagsStatistics::Counts total;
+    for (std::size_t i = 0; i < files.size(); ++i)
+    {
+        std::cout << formatReport(files[i], reports[i], *options);
+        errorsCount += reports[i].errors.size();
+        unreadableCount += !reports[i].readError.empty();
+        total += reports[i].counts;
+    }
+    std::cout.flush();
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+    std::cerr << std::format("stc-lint: {} files checked in {} ms using {} threads, {} errors",
+                             files.size(), elapsed.count(), threadsCount, errorsCount);
+    if (options->statistics)
+        std::cerr << std::format(", {} lines, {} words in total", total.lineCount, total.wordCount);
+    std::cerr << "\n";
+
+    if (unreadableCount > 0)
+        return 2;
+    return errorsCount > 0 ? 1 : 0;
+}
@@ -1,17 +1,58 @@
 #include <QApplication>
 #include <QTimer>
 #include <QDebug>
+#include <QElapsedTimer>
 #include "ui/mainwindow.h"
+#include "utils/Tracing.h"
+#include "utils/StartupReport.h"
 
 
 void setUpIcon(QApplication& a);
 
+namespace
+{
+/// Prints the time from the start of main() to the first paint of the watched window and the memory used then
+class FirstPaintReporter : public QObject
+{
+public:
+    FirstPaintReporter(const QElapsedTimer& startupTimer, Tracing::Clock::time_point startupTime, QObject *parent)
+        : QObject(parent), startupTimer(startupTimer), startupTime(startupTime)
+    {
+    }
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override
+    {
+        if (event->type() == QEvent::Paint)
+        {
+            watched->removeEventFilter(this);
+            QTimer::singleShot(0, this, [this]() { // the painted frame is flushed first
+                TRACE_ASYNC("startup", "time to first paint", startupTime);
+                qInfo().noquote() << "First paint after" << startupTimer.elapsed() << "ms,"
+                                  << QString::fromStdString(StartupReport::describeMemory());
+                deleteLater();
+            });
+        }
+        return false;
+    }
+
+private:
+    QElapsedTimer startupTimer;
+    [[maybe_unused]] Tracing::Clock::time_point startupTime;
+};
+} // namespace
+
 int main(int argc, char *argv[])
 {
+    QElapsedTimer startupTimer;
+    startupTimer.start();
+    const auto startupTime = Tracing::Clock::now();
+
     QApplication a(argc, argv);
     a.setOrganizationName("Personal");
     a.setApplicationName("Cpp0x tags editor");
     setUpIcon(a);
+    Tracing::setCurrentThreadName("main");
 
     MainWindow w;
 
@@ -42,8 +83,20 @@ int main(int argc, char *argv[])
         });
     }
 
+    // eg. STC_STARTUP_REPORT=1, the preview is not counted, it is created when it is shown for the first time
+    if (StartupReport::isEnabled())
+        w.installEventFilter(new FirstPaintReporter(startupTimer, startupTime, &w));
+
     w.show();
-    return a.exec();
+    const int exitCode = a.exec();
+
+    // eg. STC_TRACE_FILE=trace.json, when the problem happens while starting or the menu cannot be reached
+    if (const QString traceFileName = qEnvironmentVariable("STC_TRACE_FILE"); !traceFileName.isEmpty())
+    {
+        if (!Tracing::saveChromeTrace(QFile::encodeName(traceFileName).toStdString()))
+            qWarning() << "Saving trace to file '" << traceFileName << "' failed!";
+    }
+    return exitCode;
 }
 
 void setUpIcon(QApplication& a)
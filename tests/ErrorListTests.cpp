@@ -0,0 +1,72 @@
+#include <QLabel>
+#include <QTableWidget>
+#include <gtest/gtest.h>
+#include "ui/errorlist.h"
+
+namespace
+{
+class ErrorListTest : public ::testing::Test
+{
+protected:
+    using Error = ErrorList::Error;
+
+    /// Sets the errors and checks that the rows show exactly them
+    void setAndCheck(const QList<Error>& errors)
+    {
+        errorList.setErrors(errors);
+
+        ASSERT_EQ(table->rowCount(), errors.size());
+        for (int row = 0; row < table->rowCount(); ++row)
+        {
+            ASSERT_TRUE(table->item(row, 0) && table->item(row, 1) && table->item(row, 2)) << "row " << row;
+            EXPECT_EQ(table->item(row, 0)->text(), QString::number(errors[row].lineNumber)) << "row " << row;
+            EXPECT_EQ(table->item(row, 1)->text(), QString::number(errors[row].positionInLine)) << "row " << row;
+            EXPECT_EQ(table->item(row, 2)->text(), errors[row].errorText) << "row " << row;
+        }
+        EXPECT_EQ(table->isHidden(), errors.isEmpty());
+        EXPECT_EQ(label->isHidden(), !errors.isEmpty());
+    }
+
+    static Error error(int lineNumber, const QString& text = "unclosed [b]")
+    {
+        return { lineNumber, 1, text };
+    }
+
+    ErrorList errorList;
+    QTableWidget* table = errorList.findChild<QTableWidget*>();
+    QLabel* label = errorList.findChild<QLabel*>();
+};
+} // namespace
+
+TEST_F(ErrorListTest, RowsFollowErrorsChangedInTheMiddle)
+{
+    ASSERT_TRUE(table && label);
+    setAndCheck({});
+    setAndCheck({ error(1), error(5), error(9) }); // from empty
+
+    setAndCheck({ error(1), error(3), error(5), error(9) }); // inserted in the middle
+    setAndCheck({ error(1), error(3), error(9) }); // removed from the middle
+    setAndCheck({ error(1), error(4, "unclosed [i]"), error(9) }); // replaced in the middle
+    setAndCheck({ error(1), error(4, "unclosed [u]"), error(9) }); // only the text changed
+
+    setAndCheck({ error(1), error(2), error(4), error(6), error(8), error(9) }); // growing
+    setAndCheck({ error(1), error(9) }); // shrinking
+    setAndCheck({ error(0), error(1), error(9), error(10) }); // at both ends
+    setAndCheck({ error(9), error(10) });
+    setAndCheck({ error(9), error(9), error(10) }); // repeated error
+
+    setAndCheck({}); // to empty
+    setAndCheck({ error(2) });
+}
+
+TEST_F(ErrorListTest, AddedErrorsAreKeptBySetErrors)
+{
+    ASSERT_TRUE(table && label);
+    errorList.addError(3, 1, "unclosed [b]");
+    errorList.addError(7, 2, "unclosed [i]");
+    setAndCheck({ error(3), error(5), { 7, 2, "unclosed [i]" } });
+
+    errorList.clearErrors();
+    EXPECT_EQ(table->rowCount(), 0);
+    setAndCheck({ error(4) });
+}
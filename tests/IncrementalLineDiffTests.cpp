@@ -0,0 +1,146 @@
+#include <functional>
+#include <random>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <gtest/gtest.h>
+#include "utils/DiffCalculation.h"
+#include "utils/IncrementalLineDiff.h"
+
+namespace
+{
+class IncrementalLineDiffTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        QObject::connect(&document, &QTextDocument::contentsChange, [this](int position, int charsRemoved, int charsAdded) {
+            lineDiff.onContentsChange(&document, position, charsRemoved, charsAdded);
+        });
+    }
+
+    QSet<int> fullDiff() const
+    {
+        return DiffCalculation::calculateModifiedLines(lineDiff.getOriginalLines(), document.toPlainText().split('\n'));
+    }
+
+    /// Inserts the token as a new line or into a line, removes lines or joins them by the token
+    void editRandomly(std::mt19937& random, const QString& token)
+    {
+        const QTextBlock block = document.findBlockByNumber(static_cast<int>(random() % document.blockCount()));
+        const int lineLength = static_cast<int>(block.text().size());
+        const QTextBlock blockAfterRemoved = document.findBlockByNumber(block.blockNumber() + 1 + static_cast<int>(random() % 3));
+
+        QTextCursor cursor(&document);
+        switch (random() % 5)
+        {
+        case 0: // new line
+            cursor.setPosition(block.position());
+            cursor.insertText(token + '\n');
+            break;
+        case 1: // removed lines
+            if (blockAfterRemoved.isValid())
+            {
+                cursor.setPosition(block.position());
+                cursor.setPosition(blockAfterRemoved.position(), QTextCursor::KeepAnchor);
+                cursor.removeSelectedText();
+                break;
+            }
+            [[fallthrough]];
+        case 2: // joined lines
+            if (block.next().isValid())
+            {
+                cursor.setPosition(block.position() + lineLength);
+                cursor.setPosition(block.position() + lineLength + 1, QTextCursor::KeepAnchor);
+                cursor.insertText(token);
+                break;
+            }
+            [[fallthrough]];
+        default: // replaced part of a line
+            const int from = static_cast<int>(random() % (lineLength + 1));
+            cursor.setPosition(block.position() + from);
+            cursor.setPosition(block.position() + std::min(lineLength, from + static_cast<int>(random() % 6)), QTextCursor::KeepAnchor);
+            cursor.insertText(token);
+            break;
+        }
+    }
+
+    void checkRandomEdits(std::mt19937& random, const QStringList& lines, const std::function<QString(int)>& makeToken)
+    {
+        document.setPlainText(lines.join('\n'));
+        lineDiff.resetOriginal(&document);
+        ASSERT_TRUE(lineDiff.calculateModifiedLines(&document).isEmpty());
+
+        for (int edit = 0; edit < 30; ++edit)
+        {
+            editRandomly(random, makeToken(edit));
+            const QSet<int> incremental = lineDiff.calculateModifiedLines(&document);
+            const QSet<int> full = fullDiff();
+            ASSERT_EQ(incremental.size(), full.size()) << "edit " << edit;
+            ASSERT_EQ(incremental, full) << "edit " << edit;
+        }
+    }
+
+    QTextDocument document;
+    IncrementalLineDiff lineDiff;
+};
+} // namespace
+
+TEST_F(IncrementalLineDiffTest, FollowsRandomEditsLikeFullDiff)
+{
+    std::mt19937 random(1);
+    for (int round = 0; round < 50; ++round)
+    {
+        QStringList lines;
+        for (int i = 0, count = 1 + static_cast<int>(random() % 300); i < count; ++i)
+            lines.append(QString("line %1.").arg(i));
+
+        SCOPED_TRACE(round);
+        checkRandomEdits(random, lines, [](int edit) { return QString("edit %1").arg(edit); });
+    }
+}
+
+TEST_F(IncrementalLineDiffTest, FollowsRandomEditsOfRepeatedLinesLikeFullDiff)
+{
+    // lines repeat and blank ones are the most common, like in articles; edits insert the same lines again,
+    // so there are equal hashes at other positions and the text of lines with equal hashes is compared
+    const QStringList repeatedLines = { "", "", "", "[cpp]", "[/cpp]", "return 0;", "a b", QString("a%1b").arg(QChar(QChar::Nbsp)) };
+    std::mt19937 random(2);
+    for (int round = 0; round < 50; ++round)
+    {
+        QStringList lines;
+        for (int i = 0, count = 1 + static_cast<int>(random() % 300); i < count; ++i)
+            lines.append(repeatedLines[random() % repeatedLines.size()]);
+
+        SCOPED_TRACE(round);
+        checkRandomEdits(random, lines, [&random, &repeatedLines](int) { return repeatedLines[random() % repeatedLines.size()]; });
+    }
+}
+
+TEST_F(IncrementalLineDiffTest, LinesDifferingOnlyByNbspAreNotModified)
+{
+    document.setPlainText("first\na b\nlast");
+    lineDiff.resetOriginal(&document);
+
+    QTextCursor cursor(document.findBlockByNumber(1));
+    cursor.setPosition(cursor.position() + 1);
+    cursor.setPosition(cursor.position() + 1, QTextCursor::KeepAnchor);
+    cursor.insertText(QString(QChar(QChar::Nbsp))); // the same line in the saved file
+    EXPECT_TRUE(lineDiff.calculateModifiedLines(&document).isEmpty());
+
+    cursor.insertText("c");
+    EXPECT_EQ(lineDiff.calculateModifiedLines(&document), QSet<int>({ 2 }));
+}
+
+TEST_F(IncrementalLineDiffTest, ReportsEveryLineWithoutOriginal)
+{
+    document.setPlainText("a\nb\nc");
+    lineDiff.clearOriginal(&document);
+    EXPECT_EQ(lineDiff.calculateModifiedLines(&document), QSet<int>({ 1, 2, 3 }));
+
+    lineDiff.resetOriginal(&document);
+    QTextCursor cursor(&document);
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText("\nd");
+    EXPECT_EQ(lineDiff.calculateModifiedLines(&document), QSet<int>({ 4 }));
+}
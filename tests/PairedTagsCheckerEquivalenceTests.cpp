@@ -0,0 +1,109 @@
+// Hand written tag scanner has to find exactly the same tags as the regular expression used before it
+#include <random>
+#include <regex>
+#include <sstream>
+#include <gtest/gtest.h>
+#include "checkers/PairedTagsChecker.h"
+
+namespace
+{
+struct ExpectedTag
+{
+    std::string tagShortname;
+    std::string tagFull;
+    int line;
+    int startingPositionInLine;
+
+    bool operator==(const ExpectedTag&) const = default;
+};
+
+std::ostream& operator<<(std::ostream& os, const ExpectedTag& tag)
+{
+    return os << tag.line << "." << tag.startingPositionInLine << ": " << tag.tagShortname << " " << tag.tagFull;
+}
+
+/// The previous implementation of extracting tags, but with positions counted from the beginning of line
+/// (std::match_results::position was relative to the end of the previous tag in the same line).
+std::vector<ExpectedTag> extractTagsWithRegex(const std::string& text)
+{
+    static const std::regex tagRegex{R"(\[/?([[:alpha:]][[:alnum:]]*)([^\]]*?)\])"};
+
+    std::vector<ExpectedTag> tags;
+    std::istringstream input(text);
+    std::string line;
+    for (int lineNumber = 1; std::getline(input, line); ++lineNumber)
+    {
+        auto searchStart = line.cbegin();
+        std::smatch match;
+        while (std::regex_search(searchStart, line.cend(), match, tagRegex))
+        {
+            const int position = static_cast<int>(match[0].first - line.cbegin());
+            tags.push_back({ match[1], match[0], lineNumber, position });
+            searchStart = match.suffix().first;
+        }
+    }
+    return tags;
+}
+
+std::vector<ExpectedTag> extractTagsWithScanner(const std::string& text)
+{
+    std::vector<ExpectedTag> tags;
+    for (const auto& tag : PairedTagsChecker::extractTags(text))
+    {
+        tags.push_back({ std::string(tag.tagShortname), std::string(tag.tagFull), tag.line, tag.startingPositionInLine });
+    }
+    return tags;
+}
+
+void expectTheSameTags(const std::string& text)
+{
+    EXPECT_EQ(extractTagsWithRegex(text), extractTagsWithScanner(text)) << "text: >" << text << "<";
+}
+} // namespace
+
+TEST(PairedTagsCheckerEquivalenceTest, TypicalStcText)
+{
+    expectTheSameTags("[h1]Wprowadzenie[/h1]\n"
+                      "Tekst z [b]pogrubieniem[/b] i [a href=\"https://cpp0x.pl\" name=\"link\"].\n"
+                      "[div class=\"tip\"]Wskazówka[/div]\n"
+                      "[img src=\"obrazek.png\" alt='opis' autofit]\n"
+                      "[cpp]int tab[10]; tab[0] = 1;[/cpp]\n");
+}
+
+TEST(PairedTagsCheckerEquivalenceTest, ManyTagsInOneLineHavePositionsFromLineBeginning)
+{
+    const auto tags = extractTagsWithScanner("ab [b]x[/b] [i]");
+    ASSERT_EQ(tags.size(), 3);
+    EXPECT_EQ(tags[0].startingPositionInLine, 3);
+    EXPECT_EQ(tags[1].startingPositionInLine, 7);
+    EXPECT_EQ(tags[2].startingPositionInLine, 12);
+}
+
+TEST(PairedTagsCheckerEquivalenceTest, EdgeCases)
+{
+    for (const std::string text : {
+             "", "[", "]", "[]", "[/]", "[/ b]", "[ b]", "[[b]", "[b [i]", "[b", "[b]]", "[1b]", "[b1]", "[/b1 x]",
+             "[b]\n[/b]", "\n\n[b]\n", "[b\n]", "[ą]", "[bą]", "[b=ą]", "[/[/b]", "[a][b][c]", "text [b]\r\n[/b]\r\n",
+         })
+    {
+        expectTheSameTags(text);
+    }
+}
+
+TEST(PairedTagsCheckerEquivalenceTest, RandomTexts)
+{
+    const std::string alphabet[] = { "[", "[", "]", "]", "/", "b", "i", "cpp", "h1", "1", " ", "=", "\"", "'", "\n", "ą", "x" };
+    std::mt19937 generator(2024); // the same texts every run
+    std::uniform_int_distribution<std::size_t> piece(0, std::size(alphabet) - 1);
+    std::uniform_int_distribution<int> length(0, 60);
+
+    for (int i = 0; i < 5'000; ++i)
+    {
+        std::string text;
+        for (int j = length(generator); j > 0; --j)
+        {
+            text += alphabet[piece(generator)];
+        }
+        expectTheSameTags(text);
+    }
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include "utils/PreviewTransport.h"
+
+using namespace PreviewTransport;
+using namespace std::chrono_literals;
+
+TEST(PreviewTransportTest, DeltaReplacesOnlyTheChangedMiddle)
+{
+    const std::string base = "[h1]Title[/h1]\nsome text\n[b]end[/b]";
+    const std::string text = "[h1]Title[/h1]\nsome new text\n[b]end[/b]";
+
+    const TextDelta delta = makeDelta(base, text);
+    EXPECT_EQ(delta.position, 20);
+    EXPECT_EQ(delta.removedLength, 0);
+    EXPECT_EQ(delta.inserted, "new ");
+    EXPECT_EQ(applyDelta(base, delta), text);
+
+    EXPECT_EQ(applyDelta(base, makeDelta(base, "")), "");
+    EXPECT_EQ(applyDelta("", makeDelta("", text)), text);
+    EXPECT_EQ(makeDelta(text, text).inserted, "");
+    EXPECT_EQ(makeDelta(text, text).removedLength, 0);
+}
+
+TEST(PreviewTransportTest, DeltaDoesNotSplitUtf8Characters)
+{
+    // "ą" (C4 85) and "ć" (C4 87) share the first byte, "ę" (C4 99) and "ś" (C5 9B) differ in both
+    const TextDelta changedEnding = makeDelta("zaą", "zać");
+    EXPECT_EQ(changedEnding.position, 2);
+    EXPECT_EQ(changedEnding.removedLength, 2);
+    EXPECT_EQ(changedEnding.inserted, "ć");
+
+    const TextDelta changedBeginning = makeDelta("ęx", "śx");
+    EXPECT_EQ(changedBeginning.position, 0);
+    EXPECT_EQ(changedBeginning.removedLength, 2);
+    EXPECT_EQ(changedBeginning.inserted, "ś");
+}
+
+TEST(PreviewTransportTest, DeltaWhichDoesNotFitTheBaseIsRejected)
+{
+    EXPECT_EQ(applyDelta("abc", { .position = 4, .removedLength = 0, .inserted = "x" }), std::nullopt);
+    EXPECT_EQ(applyDelta("abc", { .position = 2, .removedLength = 2, .inserted = "x" }), std::nullopt);
+}
+
+TEST(PreviewTransportTest, FingerprintIsStable)
+{
+    EXPECT_EQ(textFingerprint(""), "cbf29ce484222325");
+    EXPECT_EQ(textFingerprint("a"), "af63dc4c8601ec8c");
+    EXPECT_NE(textFingerprint("[b]x[/b]"), textFingerprint("[b]y[/b]"));
+}
+
+TEST(PreviewTransportTest, HistogramPercentilesAreWithinBucketPrecision)
+{
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.percentile(0.5), 0us);
+
+    for (int millisecond = 1; millisecond <= 100; ++millisecond)
+        histogram.record(std::chrono::milliseconds(millisecond));
+
+    EXPECT_EQ(histogram.count(), 100);
+    EXPECT_GE(histogram.percentile(0.5), 50ms);
+    EXPECT_LE(histogram.percentile(0.5), 50ms * 1.2);
+    EXPECT_GE(histogram.percentile(0.95), 95ms);
+    EXPECT_LE(histogram.percentile(0.95), 100ms);
+    EXPECT_EQ(histogram.percentile(1.0), 100ms);
+
+    histogram.clear();
+    EXPECT_EQ(histogram.count(), 0);
+}
+
+TEST(PreviewTransportTest, DebounceGrowsWithLatencyAndBurstsAreLimited)
+{
+    AdaptiveDebounce debounce({ .minimumDelay = 20ms, .maximumDelay = 1000ms, .latencyFraction = 0.5 });
+    EXPECT_EQ(debounce.currentDelay(), 20ms);
+
+    for (int request = 0; request < 20; ++request)
+        debounce.addLatency(400ms);
+    EXPECT_NEAR(debounce.currentDelay().count(), 200, 2);
+
+    const auto start = AdaptiveDebounce::Clock::now();
+    const auto delay = debounce.currentDelay();
+    EXPECT_EQ(debounce.onEdit(start), delay);
+    EXPECT_EQ(debounce.onEdit(start + delay / 2), delay);
+    EXPECT_EQ(debounce.onEdit(start + delay * 3 / 2), delay / 2); // typing continues, sent two delays after the first edit
+    EXPECT_EQ(debounce.onEdit(start + delay * 3), 0ms);
+
+    debounce.onSent();
+    EXPECT_EQ(debounce.onEdit(start + delay * 3), delay);
+
+    debounce.addLatency(100000ms);
+    EXPECT_EQ(debounce.currentDelay(), 1000ms);
+}
@@ -0,0 +1,13 @@
+#include <QApplication>
+#include <gtest/gtest.h>
+
+/// Tests of classes using Qt, which need an application object (and its event loop for networking)
+int main(int argc, char* argv[])
+{
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication application(argc, argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,296 @@
+#include <algorithm>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <gtest/gtest.h>
+#include "utils/SequenceDiff.h"
+#include "pydifflib-cpp/difflib.hpp"
+
+using SequenceDiff::Opcode;
+using SequenceDiff::Tag;
+
+namespace
+{
+struct InternedLines
+{
+    std::vector<std::uint64_t> oldIds;
+    std::vector<std::uint64_t> newIds;
+};
+
+InternedLines intern(const std::vector<std::string>& oldLines, const std::vector<std::string>& newLines)
+{
+    std::unordered_map<std::string, std::uint64_t> ids;
+    InternedLines interned;
+    for (const auto& line : oldLines)
+        interned.oldIds.push_back(ids.emplace(line, ids.size()).first->second);
+    for (const auto& line : newLines)
+        interned.newIds.push_back(ids.emplace(line, ids.size()).first->second);
+    return interned;
+}
+
+std::vector<Opcode> diff(const std::vector<std::string>& oldLines, const std::vector<std::string>& newLines)
+{
+    const auto interned = intern(oldLines, newLines);
+    return SequenceDiff::computeOpcodes(interned.oldIds, interned.newIds);
+}
+
+/// Opcodes cover both sequences in order and equal ranges are really equal; returns count of lines not in equal ranges
+int checkOpcodes(const std::vector<Opcode>& opcodes, const std::vector<std::string>& oldLines, const std::vector<std::string>& newLines)
+{
+    int oldPosition = 0, newPosition = 0, changedLines = 0;
+    for (const Opcode& opcode : opcodes)
+    {
+        EXPECT_EQ(opcode.oldBegin, oldPosition);
+        EXPECT_EQ(opcode.newBegin, newPosition);
+        if (opcode.tag == Tag::Equal)
+        {
+            EXPECT_EQ(opcode.oldEnd - opcode.oldBegin, opcode.newEnd - opcode.newBegin);
+            for (int i = 0; i < opcode.oldEnd - opcode.oldBegin; ++i)
+                EXPECT_EQ(oldLines[opcode.oldBegin + i], newLines[opcode.newBegin + i]);
+        }
+        else
+        {
+            changedLines += (opcode.oldEnd - opcode.oldBegin) + (opcode.newEnd - opcode.newBegin);
+        }
+        oldPosition = opcode.oldEnd;
+        newPosition = opcode.newEnd;
+    }
+    EXPECT_EQ(oldPosition, static_cast<int>(oldLines.size()));
+    EXPECT_EQ(newPosition, static_cast<int>(newLines.size()));
+    return changedLines;
+}
+
+int longestCommonSubsequence(const std::vector<std::string>& a, const std::vector<std::string>& b)
+{
+    std::vector<std::vector<int>> lengths(a.size() + 1, std::vector<int>(b.size() + 1, 0));
+    for (std::size_t i = 1; i <= a.size(); ++i)
+        for (std::size_t j = 1; j <= b.size(); ++j)
+            lengths[i][j] = a[i - 1] == b[j - 1] ? lengths[i - 1][j - 1] + 1 : std::max(lengths[i - 1][j], lengths[i][j - 1]);
+    return lengths[a.size()][b.size()];
+}
+
+int countChangedLines(const std::vector<Opcode>& opcodes)
+{
+    int changedLines = 0;
+    for (const Opcode& opcode : opcodes)
+    {
+        if (opcode.tag != Tag::Equal)
+            changedLines += (opcode.oldEnd - opcode.oldBegin) + (opcode.newEnd - opcode.newBegin);
+    }
+    return changedLines;
+}
+
+/// Opcodes of the reference implementation of difflib's SequenceMatcher, which the editor used before
+std::vector<Opcode> diffByPydifflib(const std::vector<std::string>& oldLines, const std::vector<std::string>& newLines)
+{
+    std::vector<Opcode> opcodes;
+    for (const auto& op : pydifflib::SequenceMatcher(oldLines, newLines).get_opcodes())
+    {
+        const Tag tag = op.tag == pydifflib::tag_t::t_equal     ? Tag::Equal
+                        : op.tag == pydifflib::tag_t::t_replace ? Tag::Replace
+                        : op.tag == pydifflib::tag_t::t_delete  ? Tag::Delete
+                                                                 : Tag::Insert;
+        opcodes.push_back({ tag, static_cast<int>(op.i1), static_cast<int>(op.i2), static_cast<int>(op.j1), static_cast<int>(op.j2) });
+    }
+    return opcodes;
+}
+
+/// Edits of lines distinct in both sequences: lines are removed, inserted or replaced by new ones, never repeated
+std::vector<std::string> editDistinctLines(std::vector<std::string> lines, int edits, std::mt19937& random)
+{
+    for (int edit = 0; edit < edits; ++edit)
+    {
+        const auto position = lines.empty() ? 0 : random() % lines.size();
+        const std::string newLine = "new line " + std::to_string(edit);
+        switch (random() % 3)
+        {
+        case 0:
+            if (!lines.empty())
+                lines.erase(lines.begin() + position);
+            break;
+        case 1:
+            lines.insert(lines.begin() + position, newLine);
+            break;
+        default:
+            if (!lines.empty())
+                lines[position] = newLine;
+        }
+    }
+    return lines;
+}
+
+std::vector<std::string> numberedLines(int count, std::string_view prefix = "line ")
+{
+    std::vector<std::string> lines;
+    for (int i = 0; i < count; ++i)
+        lines.push_back(std::string(prefix) + std::to_string(i));
+    return lines;
+}
+} // namespace
+
+TEST(SequenceDiffTest, GivesOpcodesLikeDifflib)
+{
+    const auto opcodes = diff({ "a", "b", "c", "d", "e" }, { "a", "x", "c", "e", "f" });
+
+    ASSERT_EQ(opcodes.size(), 6);
+    EXPECT_EQ(opcodes[0].tag, Tag::Equal);
+    EXPECT_EQ(opcodes[1].tag, Tag::Replace);
+    EXPECT_EQ(opcodes[1].oldBegin, 1);
+    EXPECT_EQ(opcodes[1].newEnd, 2);
+    EXPECT_EQ(opcodes[2].tag, Tag::Equal);
+    EXPECT_EQ(opcodes[3].tag, Tag::Delete);
+    EXPECT_EQ(opcodes[3].oldBegin, 3);
+    EXPECT_EQ(opcodes[4].tag, Tag::Equal);
+    EXPECT_EQ(opcodes[5].tag, Tag::Insert);
+    EXPECT_EQ(opcodes[5].newBegin, 4);
+
+    EXPECT_TRUE(diff({}, {}).empty());
+    ASSERT_EQ(diff({}, { "a" }).size(), 1);
+    EXPECT_EQ(diff({}, { "a" })[0].tag, Tag::Insert);
+    ASSERT_EQ(diff({ "a", "b" }, { "a", "b" }).size(), 1);
+}
+
+TEST(SequenceDiffTest, EditScriptIsTheShortestForFewEdits)
+{
+    std::mt19937 random(25);
+    for (int round = 0; round < 200; ++round)
+    {
+        // few distinct lines, so there are many equally long alignments
+        std::vector<std::string> oldLines, newLines;
+        for (int i = 0, count = static_cast<int>(random() % 40); i < count; ++i)
+            oldLines.push_back(std::to_string(random() % 5));
+        newLines = oldLines;
+        for (int edit = 0, edits = static_cast<int>(random() % 8); edit < edits; ++edit)
+        {
+            const auto position = newLines.empty() ? 0 : random() % newLines.size();
+            if (random() % 2 && !newLines.empty())
+                newLines.erase(newLines.begin() + position);
+            else
+                newLines.insert(newLines.begin() + position, std::to_string(random() % 7));
+        }
+
+        const int changed = checkOpcodes(diff(oldLines, newLines), oldLines, newLines);
+        const int shortest = static_cast<int>(oldLines.size() + newLines.size()) - 2 * longestCommonSubsequence(oldLines, newLines);
+        ASSERT_EQ(changed, shortest) << "round " << round;
+    }
+}
+
+TEST(SequenceDiffTest, GivesTheSameOpcodesAsDifflibForDistinctLines)
+{
+    std::mt19937 random(25);
+    for (int round = 0; round < 200; ++round)
+    {
+        // up to over `maxEditsForMyers` edits, so patience diff is checked as well
+        const auto oldLines = numberedLines(static_cast<int>(random() % 2'000));
+        const auto newLines = editDistinctLines(oldLines, static_cast<int>(random() % 400), random);
+
+        ASSERT_EQ(diff(oldLines, newLines), diffByPydifflib(oldLines, newLines)) << "round " << round;
+    }
+}
+
+TEST(SequenceDiffTest, AlignmentsDifferentFromDifflibAreNotLonger)
+{
+    std::mt19937 random(26);
+    int differentAlignments = 0;
+    for (int round = 0; round < 300; ++round)
+    {
+        // repeated lines, eg. blank ones, give equally long alignments and difflib's autojunk skips popular ones
+        std::vector<std::string> oldLines, newLines;
+        for (int i = 0, count = static_cast<int>(random() % 300); i < count; ++i)
+            oldLines.push_back(std::to_string(random() % 5));
+        newLines = oldLines;
+        for (int edit = 0, edits = static_cast<int>(random() % 20); edit < edits; ++edit)
+        {
+            const auto position = newLines.empty() ? 0 : random() % newLines.size();
+            if (random() % 2 && !newLines.empty())
+                newLines.erase(newLines.begin() + position);
+            else
+                newLines.insert(newLines.begin() + position, std::to_string(random() % 7));
+        }
+
+        const auto opcodes = diff(oldLines, newLines);
+        const auto expected = diffByPydifflib(oldLines, newLines);
+        checkOpcodes(opcodes, oldLines, newLines);
+        ASSERT_LE(countChangedLines(opcodes), countChangedLines(expected)) << "round " << round;
+        differentAlignments += opcodes != expected;
+    }
+    EXPECT_GT(differentAlignments, 0); // the accepted difference, documented in SequenceDiff.h
+}
+
+TEST(SequenceDiffTest, DiffOfTheRegionBetweenCommonBeginningAndEndingIsTheSameAsOfWholeSequences)
+{
+    std::mt19937 random(27);
+    for (int round = 0; round < 200; ++round)
+    {
+        std::vector<std::string> oldLines;
+        for (int i = 0, count = static_cast<int>(random() % 200); i < count; ++i)
+            oldLines.push_back(random() % 3 ? std::string() : std::to_string(random() % 10));
+        auto newLines = oldLines;
+        for (int edit = 0, edits = static_cast<int>(random() % 10); edit < edits; ++edit)
+        {
+            const auto position = newLines.empty() ? 0 : random() % newLines.size();
+            if (random() % 2 && !newLines.empty())
+                newLines.erase(newLines.begin() + position);
+            else
+                newLines.insert(newLines.begin() + position, std::to_string(random() % 10));
+        }
+
+        const auto [oldDifferent, newDifferent] = std::ranges::mismatch(oldLines, newLines);
+        const auto prefix = static_cast<int>(oldDifferent - oldLines.begin());
+        int suffix = 0;
+        while (prefix + suffix < static_cast<int>(std::min(oldLines.size(), newLines.size()))
+               && oldLines[oldLines.size() - 1 - suffix] == newLines[newLines.size() - 1 - suffix])
+        {
+            ++suffix;
+        }
+
+        const std::vector<std::string> oldRegion(oldLines.begin() + prefix, oldLines.end() - suffix);
+        const std::vector<std::string> newRegion(newLines.begin() + prefix, newLines.end() - suffix);
+        std::vector<Opcode> expected;
+        for (const Opcode& opcode : diff(oldLines, newLines))
+        {
+            if (opcode.tag != Tag::Equal)
+                expected.push_back(opcode);
+        }
+        std::vector<Opcode> fromRegion;
+        for (Opcode opcode : diff(oldRegion, newRegion))
+        {
+            if (opcode.tag == Tag::Equal)
+                continue;
+            opcode.oldBegin += prefix;
+            opcode.oldEnd += prefix;
+            opcode.newBegin += prefix;
+            opcode.newEnd += prefix;
+            fromRegion.push_back(opcode);
+        }
+        ASSERT_EQ(fromRegion, expected) << "round " << round;
+    }
+}
+
+TEST(SequenceDiffTest, ManyEditsAreSplitByUniqueLines)
+{
+    const auto oldLines = numberedLines(100'000);
+    auto newLines = oldLines;
+    for (std::size_t i = 0; i < newLines.size(); i += 50)
+        newLines[i] += " edited";
+
+    const auto opcodes = diff(oldLines, newLines);
+    EXPECT_EQ(checkOpcodes(opcodes, oldLines, newLines), 2 * 2'000);
+    EXPECT_EQ(std::ranges::count(opcodes, Tag::Replace, &Opcode::tag), 2'000);
+}
+
+TEST(SequenceDiffTest, RegionsWithoutRareLinesAreStillCorrect)
+{
+    std::vector<std::string> oldLines, newLines;
+    for (int i = 0; i < 3'000; ++i)
+    {
+        oldLines.push_back(i % 3 ? "" : "[/cpp]");
+        newLines.push_back(i % 4 ? "" : "[cpp]");
+    }
+    checkOpcodes(diff(oldLines, newLines), oldLines, newLines);
+
+    const auto unique = numberedLines(1'000);
+    auto reversed = unique;
+    std::ranges::reverse(reversed);
+    checkOpcodes(diff(unique, reversed), unique, reversed);
+}
@@ -0,0 +1,25 @@
+#include <gtest/gtest.h>
+#include "utils/StartupReport.h"
+
+TEST(StartupReportTest, ParsesResidentMemoryFromProcStatus)
+{
+    const std::string status = "Name:\tSTC_editor\nVmPeak:\t  900000 kB\nVmHWM:\t   90112 kB\nVmRSS:\t   85244 kB\nRssAnon:\t   40000 kB\n";
+
+    const auto memory = StartupReport::parseProcStatus(status);
+    ASSERT_TRUE(memory.has_value());
+    EXPECT_EQ(memory->residentBytes, 85244ull * 1024);
+    EXPECT_EQ(memory->peakResidentBytes, 90112ull * 1024);
+
+    EXPECT_FALSE(StartupReport::parseProcStatus("Name:\tx\nVmRSSx:\t 1 kB\n").has_value());
+}
+
+TEST(StartupReportTest, MemoryOfThisProcessIsKnownOnLinux)
+{
+#ifdef __linux__
+    const auto memory = StartupReport::processMemory();
+    ASSERT_TRUE(memory.has_value());
+    EXPECT_GT(memory->residentBytes, 0);
+    EXPECT_GE(memory->peakResidentBytes, memory->residentBytes);
+    EXPECT_TRUE(StartupReport::describeMemory().starts_with("RSS "));
+#endif
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include "benchmarks/StcCorpus.h"
+#include "checkers/PairedTagsChecker.h"
+
+TEST(StcCorpusTest, TheSameSeedGivesTheSameDocument)
+{
+    corpus::DocumentOptions options{ .seed = 42, .targetBytes = 16 * 1024 };
+    const auto document = corpus::generateDocument(options);
+    EXPECT_EQ(document, corpus::generateDocument(options));
+
+    options.seed = 43;
+    EXPECT_NE(document, corpus::generateDocument(options));
+}
+
+TEST(StcCorpusTest, DocumentHasRequestedSize)
+{
+    for (std::size_t size : { 1'024u, 100'000u, 1'000'000u })
+    {
+        const auto document = corpus::generateDocument({ .targetBytes = size });
+        EXPECT_GE(document.size(), size);
+        EXPECT_LT(document.size(), size + 16 * 1024) << "only the last block can exceed the size";
+    }
+}
+
+TEST(StcCorpusTest, GeneratedTagsAreClosed)
+{
+    for (std::uint64_t seed = 1; seed <= 20; ++seed)
+    {
+        const auto document = corpus::generateDocument({ .seed = seed, .targetBytes = 32 * 1024, .maxNestingDepth = 3 });
+        const auto errors = PairedTagsChecker::checkTags(document);
+        EXPECT_TRUE(errors.empty()) << "seed " << seed << ": " << errors.front().errorText;
+    }
+}
+
+TEST(StcCorpusTest, TagMixCanDisableBlocks)
+{
+    corpus::DocumentOptions options{ .targetBytes = 32 * 1024 };
+    options.mix = { .paragraph = 1, .header = 0, .div = 0, .cpp = 0, .csv = 0, .pkt = 0, .image = 0, .inlineTags = 0 };
+
+    const auto document = corpus::generateDocument(options);
+    EXPECT_TRUE(PairedTagsChecker::extractTags(document).empty());
+}
+
+TEST(StcCorpusTest, EditScriptIsValidForTheDocument)
+{
+    const auto document = corpus::generateDocument({ .seed = 3, .targetBytes = 8 * 1024 });
+    const auto steps = corpus::generateEditScript(document, { .seed = 3, .keystrokes = 2'000 });
+
+    EXPECT_GE(steps.size(), 2'000);
+    std::string edited;
+    ASSERT_NO_THROW(edited = corpus::applyEditScript(document, steps));
+    EXPECT_NE(edited, document);
+    EXPECT_EQ(steps, corpus::generateEditScript(document, { .seed = 3, .keystrokes = 2'000 }));
+}
+
+TEST(StcCorpusTest, EditScriptTextRoundTrip)
+{
+    const std::vector<corpus::EditStep> steps = {
+        { .kind = corpus::EditStep::Kind::MoveCursor, .delayMs = 1'200, .line = 3, .column = 7 },
+        { .kind = corpus::EditStep::Kind::Type, .delayMs = 80, .text = "ż" },
+        { .kind = corpus::EditStep::Kind::Type, .delayMs = 150, .text = " " },
+        { .kind = corpus::EditStep::Kind::Backspace, .delayMs = 60 },
+        { .kind = corpus::EditStep::Kind::Newline, .delayMs = 300 },
+        { .kind = corpus::EditStep::Kind::Paste, .delayMs = 900, .text = "[cpp]\n\tint a; // \\n\n[/cpp]" },
+    };
+    EXPECT_EQ(corpus::parseEditScript(corpus::editScriptToText(steps)), steps);
+}
+
+TEST(StcCorpusTest, MalformedEditScriptThrows)
+{
+    EXPECT_THROW(corpus::parseEditScript("10 jump 1 2\n"), std::runtime_error);
+    EXPECT_THROW(corpus::parseEditScript("x type a\n"), std::runtime_error);
+    EXPECT_THROW(corpus::parseEditScript("10 move 1\n"), std::runtime_error);
+    EXPECT_THROW(corpus::applyEditScript("one line", corpus::parseEditScript("0 move 1 0\n")), std::runtime_error);
+}
@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+#include "utils/StcHtmlRenderer.h"
+#include "benchmarks/StcCorpus.h"
+
+using StcHtmlRenderer::toHtml;
+
+TEST(StcHtmlRendererTest, RendersInlineFormattingAndEscapesText)
+{
+    EXPECT_EQ(toHtml("[b]a[/b] [i]b[/i] [u]c[/u] [s]d[/s] x[sub]2[/sub] y[sup]3[/sup] [tt]e[/tt]"),
+              "<b>a</b> <i>b</i> <u>c</u> <s>d</s> x<sub>2</sub> y<sup>3</sup> <tt>e</tt>");
+    EXPECT_EQ(toHtml("a < b && \"c\" > d"), "a &lt; b &amp;&amp; &quot;c&quot; &gt; d");
+    EXPECT_EQ(toHtml("zażółć\ngęślą"), "zażółć<br/>\ngęślą");
+}
+
+TEST(StcHtmlRendererTest, RendersBlocksWithoutEmptyLinesAroundThem)
+{
+    EXPECT_EQ(toHtml("before\n[h1]Title[/h1]\nafter"), "before<h1>Title</h1>after");
+    EXPECT_EQ(toHtml("[div class=\"tip\"]\ntip\n[/div]\n[div class=\"uwaga\"]w[/div][div]d[/div]"),
+              "<div class=\"div tip\">tip</div><div class=\"div uwaga\">w</div><div class=\"div\">d</div>");
+    EXPECT_EQ(toHtml("[cytat][h4]q[/h4][/cytat]"), "<blockquote class=\"cytat\"><h4>q</h4></blockquote>");
+}
+
+TEST(StcHtmlRendererTest, DoesNotInterpretTagsInsideCode)
+{
+    EXPECT_EQ(toHtml("[cpp]\nint t[10];\nstd::cout << \"[b]\";\n[/cpp]\n[b]x[/b]"),
+              "<pre class=\"cpp\">int t[10];\nstd::cout &lt;&lt; &quot;[b]&quot;;</pre><b>x</b>");
+    EXPECT_EQ(toHtml("[code src=\"bash\"]ls[/code][PY]x = a[div][/py]"),
+              "<div class=\"src\">bash</div><pre class=\"code\">ls</pre><pre class=\"py\">x = a[div]</pre>");
+    EXPECT_EQ(toHtml("[cpp]unclosed [b]"), "<pre class=\"cpp\">unclosed [b]</pre>");
+}
+
+TEST(StcHtmlRendererTest, RendersLinksAndImages)
+{
+    EXPECT_EQ(toHtml("[a href=\"https://cpp0x.pl\" name=\"Kurs\"] [a href=\"https://x.pl/?a=1&b=2\"]"),
+              "<a href=\"https://cpp0x.pl\">Kurs</a> <a href=\"https://x.pl/?a=1&amp;b=2\">https://x.pl/?a=1&amp;b=2</a>");
+    EXPECT_EQ(toHtml("[a href=\"javascript:alert(1)\" name=\"x\"]"), "<a href=\"#\">x</a>");
+    EXPECT_EQ(toHtml("[img src=\"a.png\" alt=\"diagram\" opis=\"Opis autofit\" autofit]"),
+              "<figure class=\"img autofit\"><img src=\"a.png\" alt=\"diagram\"/><figcaption>Opis autofit</figcaption></figure>");
+    EXPECT_EQ(toHtml("[img alt=\"no source\"]"), "[img alt=&quot;no source&quot;]");
+}
+
+TEST(StcHtmlRendererTest, RendersListItemsPerLineAndInterpretsOnlyRuns)
+{
+    EXPECT_EQ(toHtml("[pkt]\nfirst [b]\n\n[run][b]second[/b][/run] item\n[/pkt]"),
+              "<ul class=\"pkt\"><li>first [b]</li><li><b>second</b> item</li></ul>");
+}
+
+TEST(StcHtmlRendererTest, RendersTablesWithHeaderAndRunsSpanningLines)
+{
+    EXPECT_EQ(toHtml("[csv extended header]\nName;Value\na;[run]x;\ny[/run]\n[/csv]"),
+              "<table class=\"csv\"><tr><th>Name</th><th>Value</th></tr><tr><td>a</td><td>x;<br/>\ny</td></tr></table>");
+}
+
+TEST(StcHtmlRendererTest, ShowsBrokenTagsAsTextAndClosesUnclosedOnes)
+{
+    EXPECT_EQ(toHtml("[/b] [unknown] [b x"), "[/b] [unknown] [b x");
+    EXPECT_EQ(toHtml("[div][b]bold[/div] rest"), "<div class=\"div\"><b>bold</b></div> rest");
+    EXPECT_EQ(toHtml("[h2][i]open"), "<h2><i>open</i></h2>");
+}
+
+TEST(StcHtmlRendererTest, RendersGeneratedCorpusWithBalancedElements)
+{
+    const auto document = corpus::generateDocument({ .seed = 21, .targetBytes = 64 * 1024 });
+    const std::string html = toHtml(document);
+
+    const auto count = [&html](std::string_view what) {
+        std::size_t n = 0;
+        for (auto position = html.find(what); position != std::string::npos; position = html.find(what, position + 1))
+            ++n;
+        return n;
+    };
+    EXPECT_EQ(count("<div"), count("</div>"));
+    EXPECT_EQ(count("<pre"), count("</pre>"));
+    EXPECT_EQ(count("<table"), count("</table>"));
+    EXPECT_EQ(count("<ul"), count("</ul>"));
+}
+
+namespace
+{
+std::string renderSectionsSeparately(std::string_view text)
+{
+    std::string html;
+    for (const auto section : StcHtmlRenderer::splitIntoSections(text))
+        html += toHtml(section);
+    return html;
+}
+} // namespace
+
+TEST(StcHtmlRendererTest, SplitsIntoSectionsBeforeTopLevelBlocksAndParagraphs)
+{
+    const std::string text = "intro\n[h1]Title[/h1]\nfirst\n\nsecond [b]bold\n\nstill bold[/b]\n[div]\n[h2]in div[/h2]\n\nx\n[/div]\n[cpp]\n[h1]\n\n[/cpp]";
+    const auto sections = StcHtmlRenderer::splitIntoSections(text);
+
+    ASSERT_EQ(sections.size(), 5);
+    EXPECT_EQ(sections[0], "intro");
+    EXPECT_EQ(sections[1], "[h1]Title[/h1]\nfirst\n\n");
+    EXPECT_EQ(sections[2], "second [b]bold\n\nstill bold[/b]");
+    EXPECT_EQ(sections[3], "[div]\n[h2]in div[/h2]\n\nx\n[/div]");
+    EXPECT_EQ(sections[4], "[cpp]\n[h1]\n\n[/cpp]");
+    EXPECT_EQ(renderSectionsSeparately(text), toHtml(text));
+}
+
+TEST(StcHtmlRendererTest, SectionsRenderedSeparatelyGiveTheSameHtml)
+{
+    for (std::uint64_t seed : { 1, 2, 3, 4, 5 })
+    {
+        const auto document = corpus::generateDocument({ .seed = seed, .targetBytes = 32 * 1024 });
+        EXPECT_GT(StcHtmlRenderer::splitIntoSections(document).size(), 10) << "seed " << seed;
+        EXPECT_EQ(renderSectionsSeparately(document), toHtml(document)) << "seed " << seed;
+    }
+}
+
+TEST(StcHtmlRendererTest, IncrementalRendererReplacesOnlyChangedSections)
+{
+    StcHtmlRenderer::IncrementalRenderer renderer;
+    const std::string before = "[h1]A[/h1]\na\n[h1]B[/h1]\nb\n[h1]C[/h1]\nc";
+
+    const auto initial = renderer.update(before);
+    EXPECT_TRUE(initial.removedIds.empty());
+    EXPECT_EQ(initial.insertAfterId, 0);
+    ASSERT_EQ(initial.inserted.size(), 3);
+    EXPECT_EQ(renderer.html(), toHtml(before));
+
+    EXPECT_TRUE(renderer.update(before).isEmpty());
+
+    const std::string edited = "[h1]A[/h1]\na\n[h1]B[/h1]\nb[i]![/i]\n[h1]C[/h1]\nc";
+    const auto patch = renderer.update(edited);
+    EXPECT_EQ(patch.removedIds, std::vector<std::uint64_t>{ initial.inserted[1].first });
+    EXPECT_EQ(patch.insertAfterId, initial.inserted[0].first);
+    ASSERT_EQ(patch.inserted.size(), 1);
+    EXPECT_EQ(patch.inserted[0].second, "<h1>B</h1>b<i>!</i>");
+    EXPECT_EQ(renderer.html(), toHtml(edited));
+
+    const auto removal = renderer.update("[h1]B[/h1]\nb[i]![/i]\n[h1]C[/h1]\nc");
+    EXPECT_EQ(removal.removedIds, std::vector<std::uint64_t>{ initial.inserted[0].first });
+    EXPECT_TRUE(removal.inserted.empty());
+    EXPECT_EQ(renderer.sectionsCount(), 2);
+
+    renderer.reset();
+    EXPECT_EQ(renderer.update("x").inserted.size(), 1);
+}
+
+TEST(StcHtmlRendererTest, IncrementalRendererFollowsRandomEditsLikeFullRendering)
+{
+    std::string document = corpus::generateDocument({ .seed = 7, .targetBytes = 16 * 1024 });
+    StcHtmlRenderer::IncrementalRenderer renderer;
+    renderer.update(document);
+
+    const std::string_view insertions[] = { "x", "\n", "\n\n", "[h1]", "[/b]", "[b]", "[cpp]", "[/cpp]", "]", "[div]\nd\n[/div]" };
+    std::uint64_t state = 7;
+    const auto next = [&state](std::size_t bound) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<std::size_t>((state >> 33) % bound);
+    };
+    for (int edit = 0; edit < 200; ++edit)
+    {
+        const auto position = next(document.size() + 1);
+        if (next(3) == 0 && position < document.size())
+            document.erase(position, 1 + next(std::min<std::size_t>(40, document.size() - position)));
+        else
+            document.insert(position, insertions[next(std::size(insertions))]);
+
+        renderer.update(document);
+        ASSERT_EQ(renderer.sectionsCount(), StcHtmlRenderer::splitIntoSections(document).size()) << "edit " << edit;
+        ASSERT_EQ(renderer.html(), renderSectionsSeparately(document)) << "edit " << edit;
+    }
+}
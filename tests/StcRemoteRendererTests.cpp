@@ -0,0 +1,272 @@
+#include <optional>
+#include <utility>
+#include <vector>
+#include <QHash>
+#include <QEventLoop>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkProxy>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUrlQuery>
+#include <gtest/gtest.h>
+#include "utils/PreviewTransport.h"
+#include "utils/StcRemoteRenderer.h"
+
+namespace
+{
+/// Stand-in of the STC rendering of cpp0x.pl speaking the delta and deflate protocol, the HTML it gives is the text it has
+class FakeStcServer : public QObject
+{
+public:
+    struct Request
+    {
+        bool asDelta = false;
+        bool compressed = false;
+        int status = 0;
+    };
+
+    bool acceptsDeltas = true;
+    bool acceptsDeflate = true;
+    bool advertisesDeflate = true; // a server can change its mind, eg. after an update
+    std::optional<int> nextStatus; // forced status of the next request
+    std::vector<Request> requests;
+
+    FakeStcServer()
+    {
+        server.listen(QHostAddress::LocalHost);
+        connect(&server, &QTcpServer::newConnection, this, [this] {
+            while (QTcpSocket* socket = server.nextPendingConnection())
+            {
+                connect(socket, &QTcpSocket::readyRead, this, [this, socket] { onReadyRead(socket); });
+                connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            }
+        });
+    }
+
+    QUrl url() const
+    {
+        return QUrl(QString("http://127.0.0.1:%1/stc/").arg(server.serverPort()));
+    }
+
+    void forgetText()
+    {
+        text.clear();
+    }
+
+private:
+    void onReadyRead(QTcpSocket* socket)
+    {
+        QByteArray& buffer = buffers[socket];
+        buffer += socket->readAll();
+
+        const qsizetype headersEnd = buffer.indexOf("\r\n\r\n");
+        if (headersEnd < 0)
+            return;
+        qsizetype contentLength = 0;
+        bool compressed = false;
+        for (const QByteArray& line : buffer.first(headersEnd).split('\n'))
+        {
+            const QByteArray header = line.trimmed().toLower();
+            if (header.startsWith("content-length:"))
+                contentLength = header.mid(15).trimmed().toLongLong();
+            compressed = compressed || (header.startsWith("content-encoding:") && header.contains("deflate"));
+        }
+        if (buffer.size() < headersEnd + 4 + contentLength)
+            return;
+
+        QByteArray body = buffer.sliced(headersEnd + 4, contentLength);
+        buffers.remove(socket);
+        respond(socket, handle(body, compressed));
+    }
+
+    std::pair<int, QByteArray> handle(QByteArray body, bool compressed)
+    {
+        Request& request = requests.emplace_back(Request{ .compressed = compressed });
+        const auto reply = [&request](int status, QByteArray html = {}) {
+            request.status = status;
+            return std::make_pair(status, html);
+        };
+
+        if (nextStatus)
+            return reply(*std::exchange(nextStatus, std::nullopt));
+        if (compressed)
+        {
+            if (!acceptsDeflate)
+                return reply(415);
+            const quint32 expectedSize = static_cast<quint32>(body.size()) * 16; // qUncompress grows it when needed
+            const char sizeHeader[] = { char(expectedSize >> 24), char(expectedSize >> 16), char(expectedSize >> 8), char(expectedSize) };
+            body = qUncompress(QByteArray(sizeHeader, 4) + body);
+        }
+
+        const QUrlQuery query(QString::fromUtf8(body));
+        request.asDelta = query.hasQueryItem("stcBase");
+        if (request.asDelta)
+        {
+            if (!acceptsDeltas || query.queryItemValue("stcBase", QUrl::FullyDecoded).toStdString() != PreviewTransport::textFingerprint(text))
+                return reply(409);
+            const PreviewTransport::TextDelta delta{ .position = query.queryItemValue("stcFrom").toULongLong(),
+                                                     .removedLength = query.queryItemValue("stcRemoved").toULongLong(),
+                                                     .inserted = query.queryItemValue("stcInserted", QUrl::FullyDecoded).toStdString() };
+            const auto newText = PreviewTransport::applyDelta(text, delta);
+            if (!newText)
+                return reply(400);
+            text = *newText;
+        }
+        else
+        {
+            text = query.queryItemValue("stc", QUrl::FullyDecoded).toStdString();
+        }
+
+        const QJsonObject json{ { "html", QString::fromStdString(text) } };
+        return reply(200, QJsonDocument(json).toJson(QJsonDocument::Compact));
+    }
+
+    void respond(QTcpSocket* socket, const std::pair<int, QByteArray>& reply)
+    {
+        const auto& [status, content] = reply;
+        QByteArray response = "HTTP/1.1 " + QByteArray::number(status) + " Status\r\n";
+        if (acceptsDeltas)
+            response += "X-Stc-Delta: 1\r\n";
+        if (advertisesDeflate)
+            response += "Accept-Encoding: deflate\r\n";
+        response += "Content-Type: application/json\r\nConnection: close\r\n";
+        response += "Content-Length: " + QByteArray::number(content.size()) + "\r\n\r\n" + content;
+        socket->write(response);
+        socket->disconnectFromHost();
+    }
+
+    QTcpServer server;
+    QHash<QTcpSocket*, QByteArray> buffers;
+    std::string text;
+};
+
+class StcRemoteRendererTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        network.setProxy(QNetworkProxy::NoProxy);
+        renderer.setEndpoint(server.url());
+        QObject::connect(&renderer, &StcRemoteRenderer::rendered, [this](const QString& html) {
+            renderedHtml = html;
+        });
+        QObject::connect(&renderer, &StcRemoteRenderer::failed, [this](const QString& reason) {
+            failure = reason;
+        });
+    }
+
+    /// Renders the text and waits for the result
+    void render(const QString& text)
+    {
+        renderedHtml.reset();
+        failure.reset();
+
+        QEventLoop loop;
+        QObject::connect(&renderer, &StcRemoteRenderer::rendered, &loop, &QEventLoop::quit);
+        QObject::connect(&renderer, &StcRemoteRenderer::failed, &loop, &QEventLoop::quit);
+        QTimer::singleShot(10'000, &loop, &QEventLoop::quit);
+        renderer.render(text);
+        loop.exec();
+    }
+
+    FakeStcServer server;
+    QNetworkAccessManager network;
+    StcRemoteRenderer renderer{ network };
+
+    std::optional<QString> renderedHtml;
+    std::optional<QString> failure;
+};
+} // namespace
+
+TEST_F(StcRemoteRendererTest, SendsCompressedDeltasOnceTheServerAnnouncesThem)
+{
+    render("[h1]Zażółć[/h1]\nfirst & second = third");
+    EXPECT_EQ(renderedHtml, "[h1]Zażółć[/h1]\nfirst & second = third");
+    EXPECT_TRUE(renderer.acceptsDeltas());
+    EXPECT_TRUE(renderer.acceptsDeflate());
+
+    render("[h1]Zażółć gęślą[/h1]\nfirst & second = third");
+    EXPECT_EQ(renderedHtml, "[h1]Zażółć gęślą[/h1]\nfirst & second = third");
+
+    ASSERT_EQ(server.requests.size(), 2);
+    EXPECT_FALSE(server.requests[0].asDelta);
+    EXPECT_FALSE(server.requests[0].compressed);
+    EXPECT_TRUE(server.requests[1].asDelta);
+    EXPECT_TRUE(server.requests[1].compressed);
+    EXPECT_EQ(renderer.getStats().requestCount, 2);
+    EXPECT_EQ(renderer.getStats().deltaRequestCount, 1);
+}
+
+TEST_F(StcRemoteRendererTest, ServerWithoutFeaturesGetsWholeUncompressedTexts)
+{
+    server.acceptsDeltas = false;
+    server.acceptsDeflate = false;
+    server.advertisesDeflate = false;
+
+    render("a");
+    render("ab");
+    EXPECT_EQ(renderedHtml, "ab");
+    ASSERT_EQ(server.requests.size(), 2);
+    EXPECT_FALSE(server.requests[1].asDelta);
+    EXPECT_FALSE(server.requests[1].compressed);
+}
+
+TEST_F(StcRemoteRendererTest, SendsWholeTextAgainWhenServerDoesNotHaveTheBase)
+{
+    render("first");
+    server.forgetText();
+    render("first, edited");
+    EXPECT_EQ(renderedHtml, "first, edited");
+
+    ASSERT_EQ(server.requests.size(), 3);
+    EXPECT_TRUE(server.requests[1].asDelta);
+    EXPECT_EQ(server.requests[1].status, 409);
+    EXPECT_FALSE(server.requests[2].asDelta);
+    EXPECT_EQ(server.requests[2].status, 200);
+}
+
+TEST_F(StcRemoteRendererTest, SendsUncompressedTextAgainWhenCompressionIsRejected)
+{
+    render("first");
+    server.acceptsDeflate = false;
+    server.advertisesDeflate = false;
+    render("second");
+    EXPECT_EQ(renderedHtml, "second");
+    EXPECT_FALSE(renderer.acceptsDeflate());
+
+    ASSERT_EQ(server.requests.size(), 3);
+    EXPECT_TRUE(server.requests[1].compressed);
+    EXPECT_EQ(server.requests[1].status, 415);
+    EXPECT_FALSE(server.requests[2].compressed);
+    EXPECT_EQ(server.requests[2].status, 200);
+
+    render("third");
+    EXPECT_FALSE(server.requests.back().compressed);
+}
+
+TEST_F(StcRemoteRendererTest, FailedRequestIsNotAcknowledged)
+{
+    render("first");
+    server.nextStatus = 500;
+    render("second");
+    EXPECT_FALSE(renderedHtml);
+    EXPECT_TRUE(failure);
+
+    // the delta is made against the last text the server rendered, not against the failed one
+    render("third");
+    EXPECT_EQ(renderedHtml, "third");
+    EXPECT_TRUE(server.requests.back().asDelta);
+    EXPECT_EQ(server.requests.back().status, 200);
+}
+
+TEST_F(StcRemoteRendererTest, ReplyWithoutHtmlIsAFailure)
+{
+    render("first");
+    server.nextStatus = 200; // without any content
+    render("second");
+    EXPECT_FALSE(renderedHtml);
+    EXPECT_TRUE(failure);
+}
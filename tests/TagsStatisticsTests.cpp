@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include "checkers/TagsStatistics.h"
+
+TEST(TagsStatisticsTest, CountsLinesWordsAndCharactersOfUtf8Text)
+{
+    const auto counts = TagsStatistics::count("Zażółć gęślą\n jaźń\n");
+    EXPECT_EQ(counts.lineCount, 3);
+    EXPECT_EQ(counts.wordCount, 3);
+    EXPECT_EQ(counts.charCount, 19);
+}
+
+TEST(TagsStatisticsTest, CountsTagsLikeFileStatistics)
+{
+    const auto counts = TagsStatistics::count("[h1]Title[/h1]\n[h2]A[/h2] [h2]B[/h2] [h3]C[/h3]\n"
+                                              "[a href=\"https://cpp0x.pl\"] [a href=\"\"] [A HREF='x' name=\"y\"]\n"
+                                              "[img src=\"a.png\"] [img alt=\"no source\"]\n"
+                                              "[div class=\"tip\"]x[/div] [div]y[/div]\n"
+                                              "[cpp]int a;[/cpp] [code src=\"C++\"]int b;[/code] [code src=\"bash\"]ls[/code]\n");
+    EXPECT_EQ(counts.h1Count, 1);
+    EXPECT_EQ(counts.h2Count, 2);
+    EXPECT_EQ(counts.h3Count, 1);
+    EXPECT_EQ(counts.linkCount, 2);
+    EXPECT_EQ(counts.imageCount, 1);
+    EXPECT_EQ(counts.divCount, 2);
+    EXPECT_EQ(counts.cppCodeCount, 2);
+}
+
+TEST(TagsStatisticsTest, IgnoresTagsInsideCode)
+{
+    const auto counts = TagsStatistics::count("[cpp]\nint t[10];\nstd::string s = \"[h1]\";\n[/cpp]\n[py]x = a[div][/py]\n[h1]after[/h1]");
+    EXPECT_EQ(counts.cppCodeCount, 1);
+    EXPECT_EQ(counts.h1Count, 1);
+    EXPECT_EQ(counts.divCount, 0);
+}
+
+TEST(TagsStatisticsTest, AttributeValueWithAndWithoutQuotes)
+{
+    EXPECT_EQ(TagsStatistics::attributeValue(R"([a href="https://cpp0x.pl" name='kurs'])", "href"), "https://cpp0x.pl");
+    EXPECT_EQ(TagsStatistics::attributeValue(R"([a href="https://cpp0x.pl" name='kurs'])", "name"), "kurs");
+    EXPECT_EQ(TagsStatistics::attributeValue(R"([img src = obrazek.png])", "src"), "obrazek.png");
+    EXPECT_EQ(TagsStatistics::attributeValue(R"([img src=])", "src"), "");
+    EXPECT_EQ(TagsStatistics::attributeValue(R"([img datasrc="x"])", "src"), std::nullopt);
+    EXPECT_EQ(TagsStatistics::attributeValue(R"([a])", "a"), std::nullopt);
+}
+
+TEST(TagsStatisticsTest, CountsH4TablesTodosAndLinesOfCode)
+{
+    const auto counts = TagsStatistics::count("[h4]A[/h4]\n[csv]a;b[/csv]\nTODO: x\ntodos\n// todo\n"
+                                              "[cpp]\nint a;\nint b;\n[/cpp]\n[code src=\"bash\"]ls[/code]\n[py]\nx = 1");
+    EXPECT_EQ(counts.h4Count, 1);
+    EXPECT_EQ(counts.tableCount, 1);
+    EXPECT_EQ(counts.todoCount, 2);
+    EXPECT_EQ(counts.cppCodeCount, 1);
+    EXPECT_EQ(counts.codeLinesPerLanguage, (std::map<std::string, int>{ { "C++", 2 }, { "bash", 1 }, { "Python", 1 } }));
+}
+
+TEST(TagsStatisticsTest, ChunksAddUpToTheWholeText)
+{
+    const std::string text = "Zażółć [h1]gęślą[/h1]\n[cpp]\nint t[10]; // [h2]\n[/cpp] po kodzie [h2]B[/h2]\n"
+                             "[code src=\"C++\"]x[/code][a href=\"https://cpp0x.pl\"]\n[py]\n# TODO\n[div]\n[/py][img src=\"a.png\"]\n\n"
+                             "[log]\nunclosed [csv]";
+    const auto whole = TagsStatistics::count(text);
+
+    for (std::size_t lineEnd = text.find('\n'); lineEnd != std::string::npos; lineEnd = text.find('\n', lineEnd + 1))
+    {
+        TagsStatistics::Accumulator accumulator;
+        accumulator.add(TagsStatistics::countChunk(std::string_view(text).substr(0, lineEnd + 1)));
+        accumulator.add(TagsStatistics::countChunk(std::string_view(text).substr(lineEnd + 1)));
+        EXPECT_EQ(std::move(accumulator).finish(), whole) << "split after byte " << lineEnd;
+    }
+
+    TagsStatistics::Accumulator lineByLine;
+    for (std::size_t lineStart = 0; lineStart < text.size(); )
+    {
+        const std::size_t lineEnd = std::min(text.find('\n', lineStart), text.size() - 1);
+        lineByLine.add(TagsStatistics::countChunk(std::string_view(text).substr(lineStart, lineEnd + 1 - lineStart)));
+        lineStart = lineEnd + 1;
+    }
+    EXPECT_EQ(std::move(lineByLine).finish(), whole);
+}
@@ -0,0 +1,106 @@
+#include <thread>
+#include <gtest/gtest.h>
+#include "utils/Tracing.h"
+
+namespace
+{
+std::size_t countOccurrences(const std::string& text, const std::string& what)
+{
+    std::size_t count = 0;
+    for (auto position = text.find(what); position != std::string::npos; position = text.find(what, position + what.size()))
+    {
+        ++count;
+    }
+    return count;
+}
+
+class TracingTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        Tracing::setEnabled(true);
+        Tracing::clear();
+    }
+
+    void TearDown() override
+    {
+        Tracing::setEnabled(true);
+        Tracing::clear();
+    }
+};
+} // namespace
+
+TEST_F(TracingTest, ScopesAreExportedAsCompleteEvents)
+{
+    Tracing::setCurrentThreadName("main");
+    {
+        const Tracing::Scope outer("editor", "keyPressEvent");
+        const Tracing::Scope inner("highlighter", "highlightBlock");
+    }
+
+    const std::string json = Tracing::toChromeTraceJson();
+    EXPECT_TRUE(json.starts_with(R"({"displayTimeUnit":"ms","traceEvents":[)")) << json;
+    EXPECT_TRUE(json.ends_with("]}\n")) << json;
+    EXPECT_NE(json.find(R"({"name":"keyPressEvent","cat":"editor","ph":"X","ts":)"), std::string::npos) << json;
+    EXPECT_NE(json.find(R"({"name":"highlightBlock","cat":"highlighter","ph":"X","ts":)"), std::string::npos) << json;
+    EXPECT_NE(json.find(R"("args":{"name":"main"})"), std::string::npos) << json;
+}
+
+TEST_F(TracingTest, NothingIsRecordedWhenDisabled)
+{
+    Tracing::setEnabled(false);
+    {
+        const Tracing::Scope scope("editor", "keyPressEvent");
+        Tracing::recordAsync("network", "preview", Tracing::Clock::now());
+    }
+
+    EXPECT_EQ(countOccurrences(Tracing::toChromeTraceJson(), "keyPressEvent"), 0);
+    EXPECT_EQ(countOccurrences(Tracing::toChromeTraceJson(), "preview"), 0);
+}
+
+TEST_F(TracingTest, RingBufferKeepsTheNewestEvents)
+{
+    for (int i = 0; i < 10; ++i)
+    {
+        const Tracing::Scope scope("test", "old");
+    }
+    for (std::size_t i = 0; i < Tracing::eventsPerThread; ++i)
+    {
+        const Tracing::Scope scope("test", "new");
+    }
+
+    const std::string json = Tracing::toChromeTraceJson();
+    EXPECT_EQ(countOccurrences(json, R"("name":"old")"), 0);
+    EXPECT_EQ(countOccurrences(json, R"("name":"new")"), Tracing::eventsPerThread);
+}
+
+TEST_F(TracingTest, AsyncOperationIsExportedAsBeginAndEndWithTheSameId)
+{
+    Tracing::recordAsync("network", "preview reply", Tracing::Clock::now());
+
+    const std::string json = Tracing::toChromeTraceJson();
+    EXPECT_EQ(countOccurrences(json, R"({"name":"preview reply","cat":"network","ph":"b")"), 1) << json;
+    EXPECT_EQ(countOccurrences(json, R"({"name":"preview reply","cat":"network","ph":"e")"), 1) << json;
+}
+
+TEST_F(TracingTest, EventsOfEndedThreadAreKept)
+{
+    std::thread([] {
+        Tracing::setCurrentThreadName("worker");
+        const Tracing::Scope scope("spellcheck", "checkQueuedWords");
+    }).join();
+
+    const std::string json = Tracing::toChromeTraceJson();
+    EXPECT_NE(json.find(R"("args":{"name":"worker"})"), std::string::npos) << json;
+    EXPECT_EQ(countOccurrences(json, "checkQueuedWords"), 1) << json;
+}
+
+TEST_F(TracingTest, NamesAreEscaped)
+{
+    {
+        const Tracing::Scope scope("test", "say \"hi\"\\");
+    }
+
+    EXPECT_NE(Tracing::toChromeTraceJson().find(R"("name":"say \"hi\"\\")"), std::string::npos);
+}
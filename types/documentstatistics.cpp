@@ -1,11 +1,44 @@
-#include <QRegularExpression>
+#include <algorithm>
 #include <QFileInfo>
+#include <QtConcurrent/QtConcurrentMap>
 #include "documentstatistics.h"
-#include "CodeEditor.h"
+#include "checkers/TagsStatistics.h"
+#include "utils/Tracing.h"
 
 
 namespace
 {
+constexpr qsizetype chunkLength = 256 * 1024; // characters, cut at the end of line
+
+QList<QStringView> splitIntoChunks(QStringView content)
+{
+    QList<QStringView> chunks;
+    for (qsizetype from = 0; from < content.size(); )
+    {
+        qsizetype end = std::min(from + chunkLength, content.size());
+        if (end < content.size())
+        {
+            const qsizetype lineEnd = content.indexOf(u'\n', end);
+            end = lineEnd < 0 ? content.size() : lineEnd + 1;
+        }
+        chunks.append(content.sliced(from, end - from));
+        from = end;
+    }
+    return chunks;
+}
+
+TagsStatistics::ChunkCounts countChunk(QStringView chunk)
+{
+    TRACE_SCOPE("statistics", "DocumentStatistics: count chunk");
+    const QByteArray utf8 = chunk.toUtf8();
+    return TagsStatistics::countChunk(std::string_view(utf8.constData(), static_cast<std::size_t>(utf8.size())));
+}
+
+void addChunk(TagsStatistics::Accumulator& accumulator, const TagsStatistics::ChunkCounts& chunk)
+{
+    accumulator.add(chunk);
+}
+
 QString sizeInHumenReadable(qint64 fileSizeBytes)
 {
     QString sizeStr;
@@ -55,10 +88,14 @@ QString makeFileStatsHtml(
     int h1Count,
     int h2Count,
     int h3Count,
+    int h4Count,
     int cppCodeCount,
     int linkCount,
     int divCount,
-    int imageCount)
+    int imageCount,
+    int tableCount,
+    int todoCount,
+    const QString& codeLinesRows)
 {
     const QString htmlTemplate = QStringLiteral(R"(
 <!doctype html>
@@ -107,6 +144,7 @@ QString makeFileStatsHtml(
           <tr><td class="key">Characters</td><td>%9</td></tr>
           <tr><td class="key">Words</td><td>%10</td></tr>
           <tr><td class="key">C++ code sections</td><td>%14</td></tr>
+          <tr><td class="key">TODOs</td><td>%20</td></tr>
         </table>
       </div>
       <div>
@@ -114,13 +152,20 @@ QString makeFileStatsHtml(
           <tr><td class="key">[h1] sections</td><td>%11</td></tr>
           <tr><td class="key">[h2] sections</td><td>%12</td></tr>
           <tr><td class="key">[h3] sections</td><td>%13</td></tr>
+          <tr><td class="key">[h4] sections</td><td>%18</td></tr>
           <tr><td class="key">Links</td><td>%15</td></tr>
           <tr><td class="key">DIV blocks</td><td>%16</td></tr>
           <tr><td class="key">Images</td><td>%17</td></tr>
+          <tr><td class="key">Tables</td><td>%19</td></tr>
         </table>
       </div>
     </div>
 
+    <div class="section-title">Lines of code</div>
+    <table class="stats">
+      %21
+    </table>
+
     <div class="footer-note">
       Generated statistics for the scanned file.
     </div>
@@ -146,52 +191,64 @@ QString makeFileStatsHtml(
         .arg(QString::number(cppCodeCount))
         .arg(QString::number(linkCount))
         .arg(QString::number(divCount))
-        .arg(QString::number(imageCount));
+        .arg(QString::number(imageCount))
+        .arg(QString::number(h4Count))
+        .arg(QString::number(tableCount))
+        .arg(QString::number(todoCount))
+        .arg(codeLinesRows);
+}
+
+QString codeLinesInHtmlRows(const QMap<QString, int>& codeLinesPerLanguage)
+{
+    if (codeLinesPerLanguage.isEmpty())
+        return R"(<tr><td class="key">No code blocks</td><td></td></tr>)";
+
+    QString rows;
+    for (auto it = codeLinesPerLanguage.begin(); it != codeLinesPerLanguage.end(); ++it)
+        rows += QString(R"(<tr><td class="key">%1</td><td>%2</td></tr>)").arg(it.key().toHtmlEscaped(), QString::number(it.value()));
+    return rows;
 }
 } // namespace
 
-DocumentStatisticsResult DocumentStatistics::analyze(CodeEditor* editor)
+QFuture<DocumentStatisticsResult> DocumentStatistics::analyze(const QString& content, const QString& filePath)
 {
-    DocumentStatisticsResult result;
-    if (!editor)
-        return result;
+    // the lambda keeps the content alive, the chunks are only views of it
+    auto counting = QtConcurrent::mappedReduced<TagsStatistics::Accumulator>(splitIntoChunks(content), [content](QStringView chunk) {
+        return countChunk(chunk);
+    }, addChunk, QtConcurrent::OrderedReduce | QtConcurrent::SequentialReduce);
+
+    return counting.then([filePath](TagsStatistics::Accumulator accumulator) {
+        const TagsStatistics::Counts counts = std::move(accumulator).finish();
+
+        DocumentStatisticsResult result;
+        result.lineCount = counts.lineCount;
+        result.charCount = counts.charCount;
+        result.wordCount = counts.wordCount;
+        result.h1Count = counts.h1Count;
+        result.h2Count = counts.h2Count;
+        result.h3Count = counts.h3Count;
+        result.h4Count = counts.h4Count;
+        result.cppCodeCount = counts.cppCodeCount;
+        result.linkCount = counts.linkCount;
+        result.divCount = counts.divCount;
+        result.imageCount = counts.imageCount;
+        result.tableCount = counts.tableCount;
+        result.todoCount = counts.todoCount;
+        for (const auto& [language, lines] : counts.codeLinesPerLanguage)
+            result.codeLinesPerLanguage.insert(QString::fromStdString(language), lines);
 
-    const QString content = editor->toPlainText();
-    const QString filePath = editor->getFileName();
-
-    QFileInfo fi(filePath);
-    result.fileName = fi.fileName();
-    result.filePath = fi.absoluteFilePath();
-    result.created  = fi.birthTime();
-    result.modified = fi.lastModified();
-    result.fileSizeBytes = fi.size();
-    result.isReadable = fi.isReadable();
-    result.isWritable = fi.isWritable();
-    result.isExecutable = fi.isExecutable();
-
-    result.lineCount = content.count('\n') + 1;
-    result.charCount = content.size();
-    result.wordCount = content.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts).count();
-
-    auto countTag = [&](const QString& tag) {
-        QRegularExpression rx(QString(R"(\[%1(?:\s+[^\]]*)?\].*?\[/%1\])").arg(tag),
-                              QRegularExpression::DotMatchesEverythingOption | QRegularExpression::CaseInsensitiveOption);
-        return content.count(rx);
-    };
-
-    result.h1Count = countTag("h1");
-    result.h2Count = countTag("h2");
-    result.h3Count = countTag("h3");
-
-    result.cppCodeCount = content.count(QRegularExpression(R"(\[(cpp|code\s+src\s*=\s*\"c\+\+\").*?\])",
-                                                           QRegularExpression::CaseInsensitiveOption));
-    result.linkCount = content.count(QRegularExpression(R"(\[a\s+(?=[^\]]*href\s*=\s*\"[^\"]+\")([^\]]*)\])",
-                                                        QRegularExpression::CaseInsensitiveOption));
-    result.divCount = countTag("div");
-    result.imageCount = content.count(QRegularExpression(R"(\[img\s+src\s*=\s*\"[^\"]+\"\])",
-                                                         QRegularExpression::CaseInsensitiveOption));
-
-    return result;
+        QFileInfo fi(filePath);
+        result.fileName = fi.fileName();
+        result.filePath = fi.absoluteFilePath();
+        result.created  = fi.birthTime();
+        result.modified = fi.lastModified();
+        result.fileSizeBytes = fi.size();
+        result.isReadable = fi.isReadable();
+        result.isWritable = fi.isWritable();
+        result.isExecutable = fi.isExecutable();
+
+        return result;
+    });
 }
 
 QString DocumentStatisticsResult::toQString() const
@@ -213,9 +270,13 @@ QString DocumentStatisticsResult::toQString() const
         h1Count,
         h2Count,
         h3Count,
+        h4Count,
         cppCodeCount,
         linkCount,
         divCount,
-        imageCount
+        imageCount,
+        tableCount,
+        todoCount,
+        codeLinesInHtmlRows(codeLinesPerLanguage)
         );
 }
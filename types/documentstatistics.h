@@ -2,8 +2,8 @@
 
 #include <QString>
 #include <QDateTime>
-
-class CodeEditor;
+#include <QFuture>
+#include <QMap>
 
 struct DocumentStatisticsResult
 {
@@ -23,16 +23,23 @@ struct DocumentStatisticsResult
     int h1Count = 0;
     int h2Count = 0;
     int h3Count = 0;
+    int h4Count = 0;
 
     int cppCodeCount = 0;
     int linkCount = 0;
     int divCount = 0;
     int imageCount = 0;
+    int tableCount = 0; // [csv]
+    int todoCount = 0;  // lines with TODO
+
+    QMap<QString, int> codeLinesPerLanguage; // eg. "C++", "Python", or src of [code]
 
     QString toQString() const;
 };
 
 namespace DocumentStatistics
 {
-    DocumentStatisticsResult analyze(CodeEditor* editor);
+    /// Counts in a single pass over the content in the global thread pool, chunks of lines are counted in parallel by `TagsStatistics`.
+    /// Tags inside of code blocks are not counted, file information is read for the path.
+    QFuture<DocumentStatisticsResult> analyze(const QString& content, const QString& filePath);
 };
@@ -1,5 +1,6 @@
 #include "WorkAwareStopwatch.h"
 #include "ui_WorkAwareStopwatch.h"
+#include "utils/HandlerTimings.h"
 
 
 WorkAwareStopwatch::WorkAwareStopwatch(QWidget *parent)
@@ -62,6 +63,7 @@ void WorkAwareStopwatch::reset()
 
 void WorkAwareStopwatch::notifyWorkActivity()
 {
+    HANDLER_TIMING("WorkAwareStopwatch::notifyWorkActivity");
     lastWorkTime = QDateTime::currentDateTime();
     if (! working)
     {
@@ -1,5 +1,6 @@
 #include "errorlist.h"
 #include "ui_errorlist.h"
+#include "utils/Tracing.h"
 
 
 ErrorList::ErrorList(QWidget *parent)
@@ -23,9 +24,8 @@ void ErrorList::addError(int lineNumber, int positionInLine, const QString& erro
 
     const auto rows = ui->tableWidget->rowCount();
     ui->tableWidget->setRowCount(rows + 1);
-    ui->tableWidget->setItem(rows, 0, new QTableWidgetItem{QString::number(lineNumber)});
-    ui->tableWidget->setItem(rows, 1, new QTableWidgetItem{QString::number(positionInLine)});
-    ui->tableWidget->setItem(rows, 2, new QTableWidgetItem{errorText});
+    setRow(rows, { lineNumber, positionInLine, errorText });
+    shownErrors.append({ lineNumber, positionInLine, errorText });
 
     ui->tableWidget->setVisible(true);
     ui->label->setHidden(true);
@@ -36,7 +36,50 @@ void ErrorList::clearErrors()
     setVisible(true);
 
     ui->tableWidget->setRowCount(0);
-    ui->label->setText("No tags errors!");
-    ui->label->setVisible(true);
-    ui->tableWidget->setHidden(true);
+    shownErrors.clear();
+    showNoErrorsLabelIfEmpty();
+}
+
+void ErrorList::setErrors(const QList<Error>& errors)
+{
+    TRACE_SCOPE("panel", "ErrorList::setErrors");
+    // usually an edit adds or removes a few errors, so the same errors are at the beginning and at the end
+    const qsizetype commonSize = std::min(shownErrors.size(), errors.size());
+    qsizetype prefix = 0;
+    while (prefix < commonSize && shownErrors[prefix] == errors[prefix])
+        ++prefix;
+    qsizetype suffix = 0;
+    while (suffix < commonSize - prefix && shownErrors[shownErrors.size() - 1 - suffix] == errors[errors.size() - 1 - suffix])
+        ++suffix;
+
+    const int changedRowsBefore = static_cast<int>(shownErrors.size() - prefix - suffix);
+    const int changedRowsAfter = static_cast<int>(errors.size() - prefix - suffix);
+    const int firstChangedRow = static_cast<int>(prefix);
+
+    for (int row = changedRowsBefore; row < changedRowsAfter; ++row)
+        ui->tableWidget->insertRow(firstChangedRow + changedRowsBefore);
+    for (int row = changedRowsAfter; row < changedRowsBefore; ++row)
+        ui->tableWidget->removeRow(firstChangedRow + changedRowsAfter);
+
+    for (int row = firstChangedRow; row < firstChangedRow + changedRowsAfter; ++row)
+        setRow(row, errors[row]);
+
+    shownErrors = errors;
+    showNoErrorsLabelIfEmpty();
+}
+
+void ErrorList::setRow(int row, const Error& error)
+{
+    ui->tableWidget->setItem(row, 0, new QTableWidgetItem{QString::number(error.lineNumber)});
+    ui->tableWidget->setItem(row, 1, new QTableWidgetItem{QString::number(error.positionInLine)});
+    ui->tableWidget->setItem(row, 2, new QTableWidgetItem{error.errorText});
+}
+
+void ErrorList::showNoErrorsLabelIfEmpty()
+{
+    const bool noErrors = shownErrors.isEmpty();
+    if (noErrors)
+        ui->label->setText("No tags errors!");
+    ui->label->setVisible(noErrors);
+    ui->tableWidget->setHidden(noErrors);
 }
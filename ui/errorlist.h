@@ -1,5 +1,6 @@
 #pragma once
 
+#include <QList>
 #include <QWidget>
 
 namespace Ui {
@@ -11,12 +12,29 @@ class ErrorList : public QWidget
     Q_OBJECT
 
 public:
+    struct Error
+    {
+        int lineNumber;
+        int positionInLine;
+        QString errorText;
+
+        bool operator==(const Error&) const = default;
+    };
+
     explicit ErrorList(QWidget *parent = nullptr);
     ~ErrorList();
 
     void addError(int lineNumber, int positionInLine, const QString& errorText);
     void clearErrors();
 
+    /// Replaces the shown errors touching only the rows which changed, so the table does not flicker while the user types.
+    void setErrors(const QList<Error>& errors);
+
 private:
+    void setRow(int row, const Error& error);
+    void showNoErrorsLabelIfEmpty();
+
     Ui::ErrorList *ui;
+
+    QList<Error> shownErrors;
 };
@@ -6,17 +6,21 @@
 #include "ui_finddialog.h"
 #include "CodeEditor.h"
 #include "highlightdelegate.h"
+#include "searchresultsmodel.h"
+#include "utils/Tracing.h"
 
 
 FindDialog::FindDialog(QWidget *parent)
-    : QWidget(parent), ui(new Ui::FindDialog)
+    : QWidget(parent), ui(new Ui::FindDialog), resultsModel(new SearchResultsModel(this))
 {
     ui->setupUi(this);
 
+    ui->foundTextsTreeView->setModel(resultsModel);
+
     auto delegate = new HighlightDelegate(this);
-    ui->foundTextsTreeWidget->setItemDelegateForColumn(2, delegate);
+    ui->foundTextsTreeView->setItemDelegateForColumn(SearchResultsModel::ContextColumn, delegate);
 
-    connect(ui->foundTextsTreeWidget, &QTreeWidget::itemClicked, this, &FindDialog::onResultItemClicked);
+    connect(ui->foundTextsTreeView, &QTreeView::clicked, this, &FindDialog::onResultClicked);
 
     installEventFilter2HandleMovingBetweenOccurences();
 }
@@ -28,10 +32,20 @@ void FindDialog::installEventFilter2HandleMovingBetweenOccurences()
     }
 }
 
-void FindDialog::onResultItemClicked(QTreeWidgetItem* item, int column)
+void FindDialog::setCodeEditor(CodeEditor* codeEditor)
 {
-    int line = item->data(0, Qt::UserRole).toInt();
-    int offset = item->data(1, Qt::UserRole).toInt();
+    this->codeEditor = codeEditor;
+
+    delete search;
+    search = new BackgroundSearch(codeEditor->document(), this);
+    connect(search, &BackgroundSearch::matchesFound, this, &FindDialog::onMatchesFound);
+    connect(search, &BackgroundSearch::finished, this, &FindDialog::onSearchFinished);
+}
+
+void FindDialog::onResultClicked(const QModelIndex& index)
+{
+    const int line = index.siblingAtColumn(SearchResultsModel::LineColumn).data(SearchResultsModel::LineRole).toInt();
+    const int offset = index.siblingAtColumn(SearchResultsModel::OffsetColumn).data(SearchResultsModel::OffsetRole).toInt();
 
     emit jumpToLocationRequested(line, offset);
 }
@@ -47,57 +61,34 @@ void FindDialog::odCheckboxMatchCasesChanged(bool checked)
 
 void FindDialog::onNextOccurencyPressed()
 {
-    // Get the number of items in the results tree
-    int total = ui->foundTextsTreeWidget->topLevelItemCount();
+    const int total = resultsModel->rowCount();
     if (total == 0)
         return;
 
-    // Find the currently selected item
-    QTreeWidgetItem* current = ui->foundTextsTreeWidget->currentItem();
-    int currentIndex = -1;
-    for (int i = 0; i < total; ++i)
-    {
-        if (ui->foundTextsTreeWidget->topLevelItem(i) == current)
-        {
-            currentIndex = i;
-            break;
-        }
-    }
-    // Move to next item (wrap around)
-    const int nextIndex = (currentIndex + 1) % total;
-    QTreeWidgetItem* nextItem = ui->foundTextsTreeWidget->topLevelItem(nextIndex);
-    ui->foundTextsTreeWidget->setCurrentItem(nextItem);
-    ui->foundTextsTreeWidget->scrollToItem(nextItem);
-    // Simulate click to trigger jump
-    onResultItemClicked(nextItem, 0);
+    // Move to next item (wrap around), -1 when nothing is selected yet
+    const int currentRow = ui->foundTextsTreeView->currentIndex().row();
+    selectResult((currentRow + 1) % total);
 }
 
 void FindDialog::onPreviousOccurencyPressed()
 {
-    // Get the number of items in the results tree
-    int total = ui->foundTextsTreeWidget->topLevelItemCount();
+    const int total = resultsModel->rowCount();
     if (total == 0)
         return;
 
-    // Find the currently selected item
-    QTreeWidgetItem* current = ui->foundTextsTreeWidget->currentItem();
-    int currentIndex = -1;
-    for (int i = 0; i < total; ++i)
-    {
-        if (ui->foundTextsTreeWidget->topLevelItem(i) == current)
-        {
-            currentIndex = i;
-            break;
-        }
-    }
     // Move to previous item (wrap around)
-    const int prevIndex = (currentIndex - 1 + total) % total;
-    QTreeWidgetItem* prevItem = ui->foundTextsTreeWidget->topLevelItem(prevIndex);
-    ui->foundTextsTreeWidget->setCurrentItem(prevItem);
-    ui->foundTextsTreeWidget->scrollToItem(prevItem);
+    const int currentRow = std::max(0, ui->foundTextsTreeView->currentIndex().row());
+    selectResult((currentRow - 1 + total) % total);
+}
+
+void FindDialog::selectResult(int row)
+{
+    const QModelIndex index = resultsModel->index(row, SearchResultsModel::LineColumn);
+    ui->foundTextsTreeView->setCurrentIndex(index);
+    ui->foundTextsTreeView->scrollTo(index);
 
     // Simulate click to trigger jump
-    onResultItemClicked(prevItem, 0);
+    onResultClicked(index);
 }
 
 bool FindDialog::eventFilter(QObject* obj, QEvent* event)
@@ -160,159 +151,92 @@ void FindDialog::currentTextChanged(QString newText)
     {
         ui->occurencesLabel->setText("Occurences: (empty text)");
 
+        search->cancel();
+        resultsModel->reset({}, 0);
         codeEditor->setSearchHighlights({});
     }
     else
     {
-        const MatchStats stats = showOccurences(newText);
-        QString occurencesCountAsText;
-        if (stats.isZero())
-        {
-            occurencesCountAsText = QString("Occurences: 0");
-        }
-        else
-        {
-            occurencesCountAsText = QString("Occurences: %1 (%2)/%3 (%4)")
-            .arg(stats.sensitive).arg(stats.sensitiveWhole)
-                .arg(stats.insensitive).arg(stats.insensitiveWhole);
-        }
-
-        ui->occurencesLabel->setText(occurencesCountAsText);
+        showOccurences(newText);
     }
 }
 
-FindDialog::MatchStats FindDialog::showOccurences(const QString &searchText)
+void FindDialog::showOccurences(const QString &searchText)
 {
-    const bool caseSensitiveRequired = ui->matchCasesCheckBox->isChecked();
-    const bool wholeWordRequired = ui->wholeWordsCheckBox->isChecked();
-
-    ui->foundTextsTreeWidget->clear();
-    if (searchText.isEmpty() || !codeEditor)
-    {
-        return {};
-    }
-
-    if (auto* delegate = qobject_cast<HighlightDelegate*>(ui->foundTextsTreeWidget->itemDelegateForColumn(2)))
+    TRACE_SCOPE("search", "FindDialog::showOccurences");
+    if (auto* delegate = qobject_cast<HighlightDelegate*>(ui->foundTextsTreeView->itemDelegateForColumn(SearchResultsModel::ContextColumn)))
         delegate->setSearchTerm(searchText);
 
-    QTextDocument* doc = codeEditor->document();
-    QTextCursor cursor(doc);
-    MatchStats stats;
-
-    const int columnWidth = ui->foundTextsTreeWidget->columnWidth(2);
-    QFontMetrics fm(ui->foundTextsTreeWidget->font());
+    const int columnWidth = ui->foundTextsTreeView->columnWidth(SearchResultsModel::ContextColumn);
+    QFontMetrics fm(ui->foundTextsTreeView->font());
     const int charWidth = fm.horizontalAdvance('x');
-    const int maxContextLength = std::max(10, columnWidth / charWidth);
-
-    while (!cursor.isNull() && !cursor.atEnd())
-    {
-        cursor = doc->find(searchText, cursor); // default: case insensitive
-        if (cursor.isNull())
-        {
-            break;
-        }
-
-        QString blockText = cursor.block().text();
-        int startInDoc = cursor.selectionStart();
-        int endInDoc = cursor.selectionEnd();
-        int blockPosition = cursor.block().position();
-        int startInBlock = startInDoc - blockPosition;
-        int endInBlock = endInDoc - blockPosition;
+    resultsModel->setMaxContextLength(std::max(10, columnWidth / charWidth));
 
-        QString foundText = blockText.mid(startInBlock, endInBlock - startInBlock);
-        bool isCaseSensitive = (foundText == searchText);
+    search->start({ .text = searchText,
+                    .matchCase = ui->matchCasesCheckBox->isChecked(),
+                    .wholeWords = ui->wholeWordsCheckBox->isChecked() });
+    resultsModel->reset(search->snapshot(), searchText.size());
 
-        bool leftBoundary = startInBlock == 0 || !blockText[startInBlock - 1].isLetterOrNumber();
-        bool rightBoundary = endInBlock >= blockText.length() || !blockText[endInBlock].isLetterOrNumber();
-        bool isWholeWord = leftBoundary && rightBoundary;
+    ui->occurencesLabel->setText("Occurences: searching…");
+}
 
-        stats.insensitive++;
-        if (isWholeWord)
-            stats.insensitiveWhole++;
-        if (isCaseSensitive)
-        {
-            stats.sensitive++;
-            if (isWholeWord)
-                stats.sensitiveWhole++;
-        }
+void FindDialog::onMatchesFound(const QList<BackgroundSearch::Match>& matches)
+{
+    resultsModel->appendMatches(matches);
+}
 
-        // Pokaż tylko jeśli pasuje do opcji użytkownika
-        if ((caseSensitiveRequired && !isCaseSensitive) ||
-            (wholeWordRequired && !isWholeWord))
-            continue;
-
-        int lineNumber = cursor.blockNumber() + 1;
-        int contextHalf = (maxContextLength - searchText.length()) / 2;
-        auto startContext = std::max<qsizetype>(0, startInBlock - contextHalf);
-        auto endContext = std::min<qsizetype>(blockText.length(), endInBlock + contextHalf);
-
-        QString visibleText = blockText.mid(startContext, endContext - startContext);
-        if (startContext > 0)
-            visibleText.prepend("…");
-        if (endContext < blockText.length())
-            visibleText.append("…");
-
-        auto *item = new QTreeWidgetItem();
-        item->setText(0, QString("Line %1").arg(lineNumber));
-        item->setText(1, QString::number(startInBlock));
-        item->setData(0, Qt::UserRole, lineNumber);
-        item->setData(1, Qt::UserRole, startInBlock);
-        item->setData(2, Qt::DisplayRole, visibleText);
-        ui->foundTextsTreeWidget->addTopLevelItem(item);
+void FindDialog::onSearchFinished(const MatchStats& stats)
+{
+    QString occurencesCountAsText;
+    if (stats.isZero())
+    {
+        occurencesCountAsText = QString("Occurences: 0");
     }
-
-    ui->foundTextsTreeWidget->setColumnCount(3);
-    ui->foundTextsTreeWidget->setHeaderLabels({ "Line", "Offset", "Context" });
+    else
+    {
+        occurencesCountAsText = QString("Occurences: %1 (%2)/%3 (%4)")
+        .arg(stats.sensitive).arg(stats.sensitiveWhole)
+            .arg(stats.insensitive).arg(stats.insensitiveWhole);
+    }
+    ui->occurencesLabel->setText(occurencesCountAsText);
 
     // Highlight all matches in the editor
     updateHighlights();
-    return stats;
 }
 
-
 void FindDialog::updateHighlights()
 {
+    TRACE_SCOPE("search", "FindDialog::updateHighlights");
     if (!codeEditor)
         return;
 
-    QList<QTextEdit::ExtraSelection> highlights;
     if (ui->textSearchField->currentText().isEmpty())
     {
         codeEditor->setSearchHighlights({});
         return;
     }
-    QTextDocument* doc = codeEditor->document();
-    QTextCursor cursor(doc);
-    QTextDocument::FindFlags flags;
-    if (ui->matchCasesCheckBox->isChecked())
-        flags |= QTextDocument::FindCaseSensitively;
-    if (ui->wholeWordsCheckBox->isChecked())
-        flags |= QTextDocument::FindWholeWords;
-    while (!cursor.isNull() && !cursor.atEnd())
-    {
-        cursor = doc->find(ui->textSearchField->currentText(), cursor, flags);
-        if (!cursor.isNull())
-        {
-            QTextEdit::ExtraSelection sel;
-            sel.cursor = cursor;
-            sel.format.setBackground(QColor(255, 255, 0, 80));
-            sel.format.setProperty(QTextFormat::FullWidthSelection, true);
-            highlights.append(sel);
-        }
-    }
-    codeEditor->setSearchHighlights(highlights);
+
+    // matches are streamed in the order of the document
+    std::vector<int> positions;
+    positions.reserve(resultsModel->matches().size());
+    for (const BackgroundSearch::Match& match : resultsModel->matches())
+        positions.push_back(match.position);
+
+    codeEditor->setSearchHighlights(std::move(positions), ui->textSearchField->currentText().size());
 }
 
 void FindDialog::showEvent(QShowEvent* event)
 {
     QWidget::showEvent(event);
-    if (! ui->textSearchField->currentText().isEmpty())
-        updateHighlights();
+    if (const QString text = ui->textSearchField->currentText(); !text.isEmpty() && codeEditor)
+        showOccurences(text); // the document could be edited while the dialog was hidden
 }
 
 void FindDialog::hideEvent(QHideEvent* event)
 {
     QWidget::hideEvent(event);
+    if (search)
+        search->cancel();
     if (codeEditor)
         codeEditor->setSearchHighlights({});
 }
@@ -1,14 +1,15 @@
 #pragma once
 
+#include <QModelIndex>
 #include <QWidget>
+#include "utils/BackgroundSearch.h"
 
 namespace Ui {
 class FindDialog;
 }
 
-class QTreeWidgetItem;
-
 class CodeEditor;
+class SearchResultsModel;
 
 class FindDialog : public QWidget
 {
@@ -17,26 +18,12 @@ class FindDialog : public QWidget
     CodeEditor* codeEditor{};
 
 public:
-    struct MatchStats
-    {
-        int insensitive = {};
-        int insensitiveWhole = {};
-        int sensitive = {};
-        int sensitiveWhole = {};
-
-        bool isZero() const
-        {
-            return 0 == insensitive && 0 == insensitiveWhole && 0 == sensitive && 0 == sensitiveWhole;
-        }
-    };
+    using MatchStats = BackgroundSearch::MatchStats;
 
     explicit FindDialog(QWidget *parent = nullptr);
     ~FindDialog();
 
-    void setCodeEditor(CodeEditor* codeEditor)
-    {
-        this->codeEditor = codeEditor;
-    }
+    void setCodeEditor(CodeEditor* codeEditor);
 
     void focusInput();
 
@@ -45,7 +32,7 @@ signals:
 
 public slots:
     void currentTextChanged(QString newText);
-    void onResultItemClicked(QTreeWidgetItem* item, int column);
+    void onResultClicked(const QModelIndex& index);
 
     void odCheckboxMatchCasesChanged(bool checked);
 
@@ -58,7 +45,8 @@ protected:
     // Event filter to handle Enter and Shift+Enter in the search field
     bool eventFilter(QObject* obj, QEvent* event) override;
 
-    MatchStats showOccurences(const QString& text);
+    /// Results are streamed by the search engine, the previous search is cancelled
+    void showOccurences(const QString& text);
 
     void installEventFilterOnSearchInput();
 
@@ -68,6 +56,13 @@ private slots:
     void onNextOccurencyPressed();
     void onPreviousOccurencyPressed();
 
+    void onMatchesFound(const QList<BackgroundSearch::Match>& matches);
+    void onSearchFinished(const MatchStats& stats);
+
 private:
+    void selectResult(int row);
+
     Ui::FindDialog *ui;
+    SearchResultsModel* resultsModel;
+    BackgroundSearch* search{};
 };
@@ -6,17 +6,27 @@
 #include <QDesktopServices>
 #include <QClipboard>
 #include <QStack>
+#include <QProgressBar>
+#include <QDateTime>
+#include <QDir>
+#include <QTimer>
+#include <QElapsedTimer>
 #include "mainwindow.h"
 #include "./ui_mainwindow.h"
 #include "ui/shortcutsdialog.h"
 #include "ui/stctagsbuttons.h"
 #include "ui/WorkAwareStopwatch.h"
 #include "checkers/PairedTagsChecker.h"
+#include "checkers/BackgroundTagsChecker.h"
 #include "errorlist.h"
 #include "types/documentstatistics.h"
 #include "widgets/LoginDialog.h"
 #include "widgets/DiffReviewDialog.h"
 #include "widgets/RenameFileDialog.h"
+#include "widgets/StcPreview.h"
+#include "utils/HandlerTimings.h"
+#include "utils/Tracing.h"
+#include "utils/StartupReport.h"
 using namespace std;
 
 namespace
@@ -29,6 +39,7 @@ namespace GeometryNames
     constexpr const char SETTINGS_WINDOW_STATE[] = "windowState";
     constexpr const char LAST_DIRECTORY[] = "lastDirectory";
     constexpr const char RECENT_FILES_LIST[] = "recentFiles";
+    constexpr const char CHECK_TAGS_WHILE_TYPING[] = "checkTagsWhileTyping";
 };
 
 std::pair<QString, QString> extractLink(const QString& text)
@@ -105,9 +116,20 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
     ui->codesListTableWidget->setTextEditor(ui->textEditor);
     ui->todosTableWidget->setTextEditor(ui->textEditor);
 
+    backgroundTagsChecker = new BackgroundTagsChecker(ui->textEditor->document(), this);
+
+#ifndef STC_TRACING
+    ui->actionSave_performance_trace->setVisible(false); // nothing is recorded
+#endif
+
     connectSignals2Slots();
     connectShortcutsFromCodeWidget();
     connectShortcuts();
+
+    if (ui->actionCheck_tags_while_typing->isChecked()) // restored from settings before the signals were connected
+    {
+        onCheckTagsWhileTypingToggled(true);
+    }
 }
 
 void MainWindow::connectSignals2Slots()
@@ -126,11 +148,29 @@ void MainWindow::connectSignals2Slots()
     });
     connect(ui->textEditor, &QPlainTextEdit::textChanged, ui->stopwatchGroupBox, &WorkAwareStopwatch::notifyWorkActivity);
     connect(ui->menuOpen_recent, &QMenu::aboutToShow, this, &MainWindow::onRecentRecentFilesMenuOpened);
+    connect(ui->textEditor, &CodeEditor::loadingProgress, this, &MainWindow::onLoadingProgress);
+    connect(ui->actionCheck_tags_while_typing, &QAction::toggled, this, &MainWindow::onCheckTagsWhileTypingToggled);
+    connect(backgroundTagsChecker, &BackgroundTagsChecker::tagsChecked, this, &MainWindow::showTagsErrors);
+    connect(ui->textEditor, &CodeEditor::textChanged, this, &MainWindow::updateStcPreview);
 
     ui->breadcrumbTextBrowser->setTextEditor(ui->textEditor);
     ui->breadcrumbTextBrowser->setHeaderTable(ui->contextTableWidget);
 }
 
+void MainWindow::onLoadingProgress(int percent)
+{
+    if (!loadingProgressBar)
+    {
+        loadingProgressBar = new QProgressBar(this);
+        loadingProgressBar->setMaximumWidth(200);
+        loadingProgressBar->setFormat(tr("Loading file: %p%"));
+        ui->statusbar->addPermanentWidget(loadingProgressBar);
+    }
+
+    loadingProgressBar->setValue(percent);
+    loadingProgressBar->setVisible(percent < 100);
+}
+
 void MainWindow::onStcTagsButtonPressed(StcTags stcTag)
 {
     switch (stcTag)
@@ -329,10 +369,12 @@ QAction* MainWindow::createRecentFileAction(const QString& filePath, const Recen
         loadFileContentToEditorDistargingCurrentContent(filePath);
 
         const int position = recentFilesWithPositions.value(filePath).cursorPosition;
-        QTextCursor cursor = ui->textEditor->textCursor();
-        cursor.setPosition(position);
-        ui->textEditor->setTextCursor(cursor);
-        ui->textEditor->ensureCursorVisible();
+        ui->textEditor->whenContentLoaded([this, position]() {
+            QTextCursor cursor = ui->textEditor->textCursor();
+            cursor.setPosition(std::min(position, ui->textEditor->document()->characterCount() - 1));
+            ui->textEditor->setTextCursor(cursor);
+            ui->textEditor->ensureCursorVisible();
+        });
     });
 
     return action;
@@ -415,8 +457,15 @@ void MainWindow::onShowAvailableShortcutsPressed()
 
 void MainWindow::onFileStatsRequested()
 {
-    auto result = DocumentStatistics::analyze(ui->textEditor);
-    QMessageBox::information(this, "File statistics", result.toQString());
+    // the dialog opens at once, counting multi megabyte documents takes a while
+    auto* dialog = new QMessageBox(QMessageBox::Information, "File statistics", tr("Counting..."), QMessageBox::Ok, this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->open();
+
+    DocumentStatistics::analyze(ui->textEditor->toPlainText(), ui->textEditor->getFileName())
+        .then(dialog, [dialog](const DocumentStatisticsResult& result) {
+            dialog->setText(result.toQString());
+        });
 }
 
 void MainWindow::onFindTriggered(bool)
@@ -795,16 +844,49 @@ void MainWindow::onRepository_pressed()
         QDesktopServices::openUrl(url);
 }
 
+void MainWindow::onSavePerformanceTracePressed()
+{
+    const QString defaultFileName = "stc-editor-trace-" + QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss") + ".json";
+    const QString directory = lastDirectory.isEmpty() ? QDir::homePath() : lastDirectory;
+
+    const QString fileName = QFileDialog::getSaveFileName(this, tr("Save performance trace"), QDir(directory).filePath(defaultFileName),
+                                                          tr("Chrome trace (*.json)"));
+    if (fileName.isEmpty())
+        return;
+
+    if (Tracing::saveChromeTrace(QFile::encodeName(fileName).toStdString()))
+        ui->statusbar->showMessage(tr("Trace saved, it can be opened in https://ui.perfetto.dev or chrome://tracing"), 10'000);
+    else
+        QMessageBox::warning(this, tr("Saving trace failed"), tr("Cannot write file: ") + fileName);
+}
+
 void MainWindow::onCheckTagsPressed()
 {
     const auto text = ui->textEditor->toPlainText().toStdString();
     const auto tagsErrors = PairedTagsChecker::checkTags(text);
 
-    ui->errorsInText->clearErrors();
-    for (const auto [lineNumber, positionInLine, errorText] : tagsErrors)
+    ui->errorsInText->setVisible(true);
+    showTagsErrors(tagsErrors);
+}
+
+void MainWindow::onCheckTagsWhileTypingToggled(bool enabled)
+{
+    if (enabled)
+    {
+        ui->errorsInText->setVisible(true);
+    }
+    backgroundTagsChecker->setEnabled(enabled);
+}
+
+void MainWindow::showTagsErrors(const std::vector<PairedTagsChecker::TagError>& tagsErrors)
+{
+    QList<ErrorList::Error> errors;
+    errors.reserve(tagsErrors.size());
+    for (const auto& [lineNumber, positionInLine, errorText] : tagsErrors)
     {
-        ui->errorsInText->addError(lineNumber, positionInLine, QString::fromStdString(errorText));
+        errors.append({ lineNumber, positionInLine, QString::fromStdString(errorText) });
     }
+    ui->errorsInText->setErrors(errors);
 }
 
 void MainWindow::onContextShowChanged(bool visible)
@@ -1029,6 +1111,8 @@ void MainWindow::loadSettings()
 
     lastDirectory = settings.value(GeometryNames::LAST_DIRECTORY, QDir::homePath()).toString();
 
+    ui->actionCheck_tags_while_typing->setChecked(settings.value(GeometryNames::CHECK_TAGS_WHILE_TYPING, false).toBool());
+
     QVariantMap filesMap = settings.value(GeometryNames::RECENT_FILES_LIST).toMap();
     for (auto it = filesMap.begin(); it != filesMap.end(); ++it)
     {
@@ -1050,6 +1134,7 @@ void MainWindow::saveSettings()
 
     settings.setValue(GeometryNames::GEOMETRY, saveGeometry());
     settings.setValue(GeometryNames::SETTINGS_WINDOW_STATE, saveState());
+    settings.setValue(GeometryNames::CHECK_TAGS_WHILE_TYPING, ui->actionCheck_tags_while_typing->isChecked());
 
     if (! lastDirectory.isEmpty())
     {
@@ -1117,8 +1202,18 @@ void MainWindow::onShowStcPreviewTriggered()
         return;
     }
 
-    if (ui->stcPreviewWidget->isPreviewInitialized())
+    if (!stcPreviewWidget) // the placeholder is painted before creating the preview blocks for a while
+    {
+        QTimer::singleShot(0, this, [this]() {
+            createStcPreviewWidget();
+            onShowStcPreviewTriggered();
+        });
+        return;
+    }
+
+    if (stcPreviewWidget->getRendering() == StcPreviewWidget::Rendering::Local || stcPreviewWidget->isPreviewInitialized())
     {
+        updateStcPreview();
         return;
     }
 
@@ -1126,23 +1221,56 @@ void MainWindow::onShowStcPreviewTriggered()
     if (dlg.exec() != QDialog::Accepted)
         return;
 
-    ui->stcPreviewWidget->login(dlg.username(), dlg.password());
+    stcPreviewWidget->login(dlg.username(), dlg.password()); // the text is sent after loginSucceeded
+}
 
-    connect(ui->textEditor, &CodeEditor::textChanged, [this]() {
-        if (ui->stcPreviewWidget->isVisible())
-        {
-            ui->stcPreviewWidget->updateText(ui->textEditor->toPlainText());
-        }
-    });
+void MainWindow::onStcPreviewRenderedByServerToggled(bool checked)
+{
+    if (stcPreviewWidget) // otherwise the rendering is set when the preview is created
+        stcPreviewWidget->setRendering(checked ? StcPreviewWidget::Rendering::Remote : StcPreviewWidget::Rendering::Local);
+    onShowStcPreviewTriggered();
+}
+
+void MainWindow::createStcPreviewWidget()
+{
+    if (stcPreviewWidget)
+        return;
+
+    TRACE_SCOPE("startup", "MainWindow::createStcPreviewWidget");
+    QElapsedTimer timer;
+    timer.start();
 
-    connect(ui->stcPreviewWidget, &StcPreviewWidget::loginFailed, this, [this](const QString &msg) {
+    stcPreviewWidget = new StcPreviewWidget(ui->stcPreviewDockWidget);
+    if (ui->actionStc_Preview_rendered_by_Cpp0x_pl->isChecked())
+        stcPreviewWidget->setRendering(StcPreviewWidget::Rendering::Remote);
+
+    connect(stcPreviewWidget, &StcPreviewWidget::loginSucceeded, this, &MainWindow::updateStcPreview);
+    connect(stcPreviewWidget, &StcPreviewWidget::loginFailed, this, [this](const QString &msg) {
         QMessageBox::warning(this, "Login error", msg);
     });
 
-    connect(ui->stcPreviewWidget, &StcPreviewWidget::loginSucceeded, this, [this]() {
-        connect(ui->textEditor, &CodeEditor::textChanged, this, [this]() {
-            ui->stcPreviewWidget->updateText(ui->textEditor->toPlainText());
-        });
-        ui->stcPreviewWidget->updateText(ui->textEditor->toPlainText());
-    });
+    ui->stcPreviewDockWidget->setWidget(stcPreviewWidget);
+    stcPreviewWidget->show();
+    ui->stcPreviewPlaceholderLabel->deleteLater();
+    ui->stcPreviewPlaceholderLabel = nullptr;
+
+    if (StartupReport::isEnabled())
+        qInfo().noquote() << "Preview created in" << timer.elapsed() << "ms," << QString::fromStdString(StartupReport::describeMemory());
+}
+
+void MainWindow::updateStcPreview()
+{
+    HANDLER_TIMING("MainWindow: preview updateText");
+    if (!stcPreviewWidget || stcPreviewWidget->isHidden() || ui->stcPreviewDockWidget->isHidden())
+    {
+        return;
+    }
+
+    // in the remote mode nothing is sent until login finished
+    if (stcPreviewWidget->getRendering() == StcPreviewWidget::Rendering::Remote && !stcPreviewWidget->isPreviewInitialized())
+    {
+        return;
+    }
+
+    stcPreviewWidget->updateText(ui->textEditor->toPlainText());
 }
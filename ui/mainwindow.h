@@ -1,5 +1,6 @@
 #pragma once
 
+#include <vector>
 #include <QMainWindow>
 #include <QFileDialog>
 
@@ -8,6 +9,10 @@ namespace Ui { class MainWindow; }
 QT_END_NAMESPACE
 
 class QTextCursor;
+class QProgressBar;
+class BackgroundTagsChecker;
+class StcPreviewWidget;
+namespace PairedTagsChecker { struct TagError; }
 
 enum class StcTags: std::uint32_t;
 
@@ -36,8 +41,10 @@ public slots:
 
     void onUpdateBreadcrumb();
     void onFileContentChanged(const QString& fileName, int changedLines);
+    void onLoadingProgress(int percent);
 
     void onShowStcPreviewTriggered();
+    void onStcPreviewRenderedByServerToggled(bool checked);
 
     /// file menu:
     void onNewFilePressed();
@@ -59,6 +66,8 @@ public slots:
 
     /// check menu:
     void onCheckTagsPressed();
+    void onCheckTagsWhileTypingToggled(bool enabled);
+    void showTagsErrors(const std::vector<PairedTagsChecker::TagError>& tagsErrors);
 
     /// view menu:
     void onViewMenuAboutToShow();
@@ -71,6 +80,7 @@ public slots:
     void onStcCoursePressed();
     void onCpp0xPl_pressed();
     void onRepository_pressed();
+    void onSavePerformanceTracePressed();
 
 protected:
     void setDisabledMenuActionsDependingOnOpenedFile(bool disabled=true);
@@ -100,6 +110,11 @@ protected:
 
     void setTodosCounterValue(int todosTotal);
 
+    /// Sends the text to the preview if it is shown and ready
+    void updateStcPreview();
+    /// The preview starts QWebEngine, which takes long and much memory, so it replaces its placeholder on first use
+    void createStcPreviewWidget();
+
     /// methods to handle recent files:
     QAction *createRecentFileAction(const QString &filePath, const RecentFileInfo &fileInfo);
     void addEmptyRecentFilesLabel();
@@ -111,4 +126,10 @@ private: // members
     QString lastDirectory;
 
     QMap<QString, RecentFileInfo> recentFilesWithPositions;
+
+    QProgressBar* loadingProgressBar = {};
+
+    BackgroundTagsChecker* backgroundTagsChecker = {};
+
+    StcPreviewWidget* stcPreviewWidget = {}; // created by createStcPreviewWidget
 };
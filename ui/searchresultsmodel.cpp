@@ -0,0 +1,92 @@
+#include "searchresultsmodel.h"
+
+
+void SearchResultsModel::reset(const QString& searchedText, int searchTermLength)
+{
+    beginResetModel();
+    text = searchedText;
+    termLength = searchTermLength;
+    found.clear();
+    endResetModel();
+}
+
+void SearchResultsModel::appendMatches(const QList<BackgroundSearch::Match>& matches)
+{
+    if (matches.isEmpty())
+        return;
+
+    beginInsertRows({}, found.size(), found.size() + matches.size() - 1);
+    found.append(matches);
+    endInsertRows();
+}
+
+int SearchResultsModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(found.size());
+}
+
+int SearchResultsModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : ColumnsCount;
+}
+
+QVariant SearchResultsModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= found.size())
+        return {};
+
+    const BackgroundSearch::Match& match = found[index.row()];
+    const int offset = match.position - match.lineStart;
+    switch (index.column())
+    {
+    case LineColumn:
+        if (role == Qt::DisplayRole)
+            return QString("Line %1").arg(match.line);
+        if (role == LineRole)
+            return match.line;
+        break;
+    case OffsetColumn:
+        if (role == Qt::DisplayRole)
+            return QString::number(offset);
+        if (role == OffsetRole)
+            return offset;
+        break;
+    case ContextColumn:
+        if (role == Qt::DisplayRole)
+            return context(match);
+        break;
+    }
+    return {};
+}
+
+QVariant SearchResultsModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return {};
+
+    switch (section)
+    {
+    case LineColumn: return "Line";
+    case OffsetColumn: return "Offset";
+    case ContextColumn: return "Context";
+    }
+    return {};
+}
+
+QString SearchResultsModel::context(const BackgroundSearch::Match& match) const
+{
+    qsizetype lineEnd = text.indexOf(u'\n', match.position);
+    if (lineEnd < 0)
+        lineEnd = text.size();
+
+    const int contextHalf = (maxContextLength - termLength) / 2;
+    const auto startContext = std::max<qsizetype>(match.lineStart, match.position - contextHalf);
+    const auto endContext = std::min<qsizetype>(lineEnd, match.position + termLength + contextHalf);
+
+    QString visibleText = text.mid(startContext, endContext - startContext);
+    if (startContext > match.lineStart)
+        visibleText.prepend("…");
+    if (endContext < lineEnd)
+        visibleText.append("…");
+    return visibleText;
+}
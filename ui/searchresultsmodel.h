@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include "utils/BackgroundSearch.h"
+
+/**
+ * @brief Occurrences found by FindDialog, appended in batches while the search is running.
+ *
+ * Only positions are stored, the context of an occurrence is cut from the searched text when the row is painted.
+ */
+class SearchResultsModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column
+    {
+        LineColumn,
+        OffsetColumn,
+        ContextColumn,
+        ColumnsCount
+    };
+
+    static constexpr int LineRole = Qt::UserRole;   // for LineColumn, counted from 1
+    static constexpr int OffsetRole = Qt::UserRole; // for OffsetColumn, in the line
+
+    using QAbstractTableModel::QAbstractTableModel;
+
+    /// Removes the results, the next ones are referring to the text
+    void reset(const QString& searchedText, int searchTermLength);
+    void appendMatches(const QList<BackgroundSearch::Match>& matches);
+
+    void setMaxContextLength(int characters)
+    {
+        maxContextLength = characters;
+    }
+
+    const QList<BackgroundSearch::Match>& matches() const
+    {
+        return found;
+    }
+
+    int rowCount(const QModelIndex& parent = {}) const override;
+    int columnCount(const QModelIndex& parent = {}) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    QString context(const BackgroundSearch::Match& match) const;
+
+    QString text;
+    int termLength = 0;
+    int maxContextLength = 80;
+    QList<BackgroundSearch::Match> found;
+};
@@ -0,0 +1,142 @@
+#include <utility>
+#include <QElapsedTimer>
+#include <QTextDocument>
+#include "BackgroundSearch.h"
+#include "Tracing.h"
+
+
+namespace
+{
+constexpr qsizetype sliceLength = 256 * 1024; // characters searched between checks if the search was cancelled
+constexpr qsizetype matchesPerBatch = 1'000;
+constexpr qint64 batchIntervalMs = 30; // rare occurrences are shown without waiting for a full batch
+
+/// the same as in QTextDocument::FindWholeWords: no letter or digit just before and after the occurrence
+bool isWholeWord(QStringView text, qsizetype start, qsizetype end)
+{
+    const bool leftBoundary = start == 0 || !text[start - 1].isLetterOrNumber();
+    const bool rightBoundary = end >= text.size() || !text[end].isLetterOrNumber();
+    return leftBoundary && rightBoundary;
+}
+
+/// Case insensitive search like QTextDocument::find, the occurrences are checked against options of the query afterwards
+template<typename BatchConsumer>
+BackgroundSearch::MatchStats search(QStringView text, const BackgroundSearch::Query& query, const std::atomic_bool& cancelled,
+                                    BatchConsumer consumeBatch)
+{
+    const QStringView needle = query.text;
+    BackgroundSearch::MatchStats stats;
+    QList<BackgroundSearch::Match> batch;
+    QElapsedTimer sinceLastBatch;
+    sinceLastBatch.start();
+
+    int line = 1;
+    qsizetype lineStart = 0;
+    qsizetype linesCountedTo = 0;
+
+    for (qsizetype from = 0; from <= text.size() - needle.size() && !cancelled.load(std::memory_order_relaxed); )
+    {
+        const qsizetype sliceEnd = std::min(text.size(), from + sliceLength + needle.size() - 1);
+        const qsizetype found = text.first(sliceEnd).indexOf(needle, from, Qt::CaseInsensitive);
+        if (found < 0)
+        {
+            from = sliceEnd - needle.size() + 1;
+            continue;
+        }
+        from = found + needle.size(); // occurrences do not overlap, as of QTextDocument::find
+
+        const QStringView skipped = text.sliced(linesCountedTo, found - linesCountedTo);
+        if (const qsizetype lastNewLine = skipped.lastIndexOf(u'\n'); lastNewLine >= 0)
+        {
+            line += static_cast<int>(skipped.count(u'\n'));
+            lineStart = linesCountedTo + lastNewLine + 1;
+        }
+        linesCountedTo = found;
+
+        const bool caseSensitive = text.sliced(found, needle.size()) == needle;
+        const bool wholeWord = isWholeWord(text, found, found + needle.size());
+
+        stats.insensitive++;
+        if (wholeWord)
+            stats.insensitiveWhole++;
+        if (caseSensitive)
+        {
+            stats.sensitive++;
+            if (wholeWord)
+                stats.sensitiveWhole++;
+        }
+
+        if ((query.matchCase && !caseSensitive) || (query.wholeWords && !wholeWord))
+            continue;
+
+        batch.append({ .position = static_cast<int>(found), .line = line, .lineStart = static_cast<int>(lineStart) });
+        if (batch.size() >= matchesPerBatch || sinceLastBatch.elapsed() >= batchIntervalMs)
+        {
+            consumeBatch(std::exchange(batch, {}));
+            sinceLastBatch.restart();
+        }
+    }
+
+    if (!batch.isEmpty())
+        consumeBatch(std::move(batch));
+    return stats;
+}
+} // namespace
+
+
+BackgroundSearch::BackgroundSearch(QTextDocument* document, QObject* parent)
+    : QObject(parent), document(document)
+{
+    worker.setMaxThreadCount(1);
+
+    connect(document, &QTextDocument::contentsChanged, this, [this] {
+        snapshotOutdated = true;
+    });
+}
+
+BackgroundSearch::~BackgroundSearch()
+{
+    cancel();
+    worker.waitForDone(); // results are posted to this object
+}
+
+void BackgroundSearch::start(const Query& query)
+{
+    TRACE_SCOPE("search", "BackgroundSearch::start");
+    cancel();
+    if (query.text.isEmpty())
+        return;
+
+    // QTextDocument can be read only from its thread, the snapshot is shared with the worker without copying
+    if (std::exchange(snapshotOutdated, false))
+        text = document->toPlainText();
+
+    searching = true;
+    cancelled = std::make_shared<std::atomic_bool>(false);
+    worker.start([this, text = text, query, id = searchId, cancelled = cancelled] {
+        TRACE_SCOPE("search", "BackgroundSearch: search snapshot");
+        const MatchStats stats = search(text, query, *cancelled, [this, id](QList<Match> batch) {
+            QMetaObject::invokeMethod(this, [this, id, batch = std::move(batch)] {
+                if (id == searchId)
+                    emit matchesFound(batch);
+            }, Qt::QueuedConnection);
+        });
+
+        QMetaObject::invokeMethod(this, [this, id, stats] {
+            if (id != searchId)
+                return;
+            searching = false;
+            emit finished(stats);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void BackgroundSearch::cancel()
+{
+    if (cancelled)
+        cancelled->store(true);
+    worker.clear();
+
+    ++searchId;
+    searching = false;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+
+class QTextDocument;
+
+/**
+ * @brief Finds all occurrences of a text in the document by a worker thread, without blocking typing of the query.
+ *
+ * The worker searches a snapshot of the text, which is taken again only after the document was changed.
+ * Matches are streamed in batches in the order of the document, a new search cancels the previous one
+ * and signals of a cancelled search are never emitted.
+ */
+class BackgroundSearch : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Query
+    {
+        QString text;
+        bool matchCase = false;
+        bool wholeWords = false;
+    };
+
+    /// Occurrence found with the options of the query, positions are in the snapshot
+    struct Match
+    {
+        int position;
+        int line;      // counted from 1
+        int lineStart; // position of the first character of the line
+    };
+
+    /// Counted for every occurrence of the text, independently of the options of the query
+    struct MatchStats
+    {
+        int insensitive = {};
+        int insensitiveWhole = {};
+        int sensitive = {};
+        int sensitiveWhole = {};
+
+        bool isZero() const
+        {
+            return 0 == insensitive && 0 == insensitiveWhole && 0 == sensitive && 0 == sensitiveWhole;
+        }
+    };
+
+    explicit BackgroundSearch(QTextDocument* document, QObject* parent = nullptr);
+    ~BackgroundSearch();
+
+    /// Cancels the current search, results of the new one are referring to `snapshot()`.
+    void start(const Query& query);
+    void cancel();
+
+    bool isSearching() const
+    {
+        return searching;
+    }
+
+    /// Text of the document when the last search was started.
+    const QString& snapshot() const
+    {
+        return text;
+    }
+
+signals:
+    void matchesFound(const QList<BackgroundSearch::Match>& matches);
+    void finished(const BackgroundSearch::MatchStats& stats);
+
+private:
+    QTextDocument* document;
+    QString text;
+    bool snapshotOutdated = true;
+
+    bool searching = false;
+    std::uint64_t searchId = 0; // results of other searches are stale
+    std::shared_ptr<std::atomic_bool> cancelled;
+    QThreadPool worker;
+};
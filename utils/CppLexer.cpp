@@ -0,0 +1,278 @@
+#include <algorithm>
+#include <bit>
+#include <QHash>
+#include "CppLexer.h"
+
+
+namespace
+{
+const QString commentFormat = QStringLiteral("Comment");
+const QString stringFormat = QStringLiteral("String");
+const QString preprocessorFormat = QStringLiteral("Preprocessor");
+const QString functionFormat = QStringLiteral("Function");
+const QString typeFormat = QStringLiteral("Type");
+
+/// the same as `[_a-zA-Z]` used by the regular expressions of the highlighter before
+bool isIdentifierStart(QChar c)
+{
+    const char16_t u = c.unicode();
+    return u == u'_' || (u >= u'a' && u <= u'z') || (u >= u'A' && u <= u'Z');
+}
+
+bool isDigit(QChar c)
+{
+    return c.unicode() >= u'0' && c.unicode() <= u'9';
+}
+
+bool isIdentifierPart(QChar c)
+{
+    return isIdentifierStart(c) || isDigit(c);
+}
+
+bool isSpace(QChar c)
+{
+    return c == u' ' || c == u'\t';
+}
+
+qsizetype skipSpaces(QStringView code, qsizetype i)
+{
+    while (i < code.size() && isSpace(code[i]))
+        ++i;
+    return i;
+}
+
+qsizetype skipIdentifier(QStringView code, qsizetype i)
+{
+    while (i < code.size() && isIdentifierPart(code[i]))
+        ++i;
+    return i;
+}
+
+/// end of string or char literal starting at `start`, escaped quotes are skipped; -1 if not closed in the fragment
+qsizetype findLiteralEnd(QStringView code, qsizetype start)
+{
+    const QChar quote = code[start];
+    for (qsizetype i = start + 1; i < code.size(); ++i)
+    {
+        if (code[i] == u'\\')
+            ++i;
+        else if (code[i] == quote)
+            return i + 1;
+    }
+    return -1;
+}
+} // namespace
+
+
+namespace cpp
+{
+KeywordTable::KeywordTable(const QList<Keyword>& allKeywords)
+{
+    QHash<QString, qsizetype> indexOfWord;
+    for (const Keyword& keyword : allKeywords)
+    {
+        if (auto it = indexOfWord.constFind(keyword.word); it != indexOfWord.cend())
+        {
+            keywords[it.value()].formatName = keyword.formatName;
+        }
+        else
+        {
+            indexOfWord.insert(keyword.word, keywords.size());
+            keywords.append(keyword);
+        }
+    }
+
+    // a few hundred keywords: with twice as many slots a seed without collisions is found after several tries
+    std::size_t size = std::bit_ceil(std::max<std::size_t>(8, 2 * keywords.size()));
+    for (std::uint32_t attempt = 0; ; ++attempt)
+    {
+        if (attempt > 0 && attempt % 64 == 0)
+            size *= 2;
+
+        seed = attempt;
+        mask = static_cast<std::uint32_t>(size - 1);
+        slots.assign(size, -1);
+
+        bool collision = false;
+        for (qsizetype i = 0; i < keywords.size() && !collision; ++i)
+        {
+            auto& slot = slots[hash(keywords[i].word, seed) & mask];
+            collision = slot >= 0;
+            slot = static_cast<std::int32_t>(i);
+        }
+        if (!collision)
+            return;
+    }
+}
+
+std::uint32_t KeywordTable::hash(QStringView word, std::uint32_t seed)
+{
+    std::uint32_t h = 2166136261u ^ (seed * 0x9e3779b9u); // FNV-1a
+    for (QChar c : word)
+    {
+        h ^= c.unicode();
+        h *= 16777619u;
+    }
+    return h ^ (h >> 15);
+}
+
+const QString* KeywordTable::formatOf(QStringView identifier) const
+{
+    if (slots.empty())
+        return nullptr;
+
+    const std::int32_t index = slots[hash(identifier, seed) & mask];
+    if (index < 0 || keywords[index].word != identifier)
+        return nullptr;
+    return &keywords[index].formatName;
+}
+
+bool tokenize(QStringView code, bool startsInsideComment, const KeywordTable& keywords, QList<Token>& tokens)
+{
+    const qsizetype n = code.size();
+    auto add = [&tokens](qsizetype start, qsizetype end, const QString& formatName) {
+        tokens.append(Token{ static_cast<int>(start), static_cast<int>(end - start), formatName });
+    };
+
+    qsizetype i = 0;
+    if (startsInsideComment)
+    {
+        const qsizetype end = code.indexOf(u"*/");
+        if (end < 0)
+        {
+            add(0, n, commentFormat);
+            return true;
+        }
+        i = end + 2;
+        add(0, i, commentFormat);
+    }
+    else if (const qsizetype hash = skipSpaces(code, 0); hash < n && code[hash] == u'#') // preprocessor line
+    {
+        const qsizetype nameStart = skipSpaces(code, hash + 1);
+        const qsizetype nameEnd = skipIdentifier(code, nameStart);
+        i = nameEnd;
+
+        if (code.sliced(nameStart, nameEnd - nameStart) == u"include")
+        {
+            const qsizetype path = skipSpaces(code, nameEnd);
+            if (path < n && (code[path] == u'<' || code[path] == u'"'))
+            {
+                const qsizetype pathEnd = code.indexOf(code[path] == u'<' ? u'>' : u'"', path + 1);
+                if (pathEnd > 0)
+                {
+                    add(hash, path, preprocessorFormat);
+                    add(path, pathEnd + 1, stringFormat);
+                    i = pathEnd + 1;
+                }
+            }
+        }
+        if (i == nameEnd && nameEnd > nameStart)
+            add(hash, nameEnd, preprocessorFormat);
+    }
+
+    struct Identifier
+    {
+        qsizetype start = -1;
+        qsizetype end = -1;
+        bool keyword = false;
+    } previous;
+
+    auto previousTypeBefore = [&](qsizetype start) -> bool { // `Type name` separated only by spaces
+        if (previous.start < 0 || previous.keyword || previous.end >= start)
+            return false;
+        return skipSpaces(code, previous.end) == start;
+    };
+
+    while (i < n)
+    {
+        const QChar c = code[i];
+
+        if (isIdentifierStart(c))
+        {
+            const qsizetype start = i;
+            i = skipIdentifier(code, i);
+
+            if (const QString* keywordFormat = keywords.formatOf(code.sliced(start, i - start)))
+            {
+                add(start, i, *keywordFormat);
+                previous = { start, i, true };
+                continue;
+            }
+
+            // qualified name, eg. std::chrono::now
+            for (;;)
+            {
+                const qsizetype colons = skipSpaces(code, i);
+                if (colons + 1 >= n || code[colons] != u':' || code[colons + 1] != u':')
+                    break;
+                const qsizetype next = skipSpaces(code, colons + 2);
+                if (next >= n || !isIdentifierStart(code[next]))
+                    break;
+                i = skipIdentifier(code, next);
+            }
+
+            const qsizetype after = skipSpaces(code, i);
+            const QChar nextChar = after < n ? code[after] : QChar();
+            if (nextChar == u'(')
+            {
+                if (previousTypeBefore(start))
+                    add(previous.start, previous.end, typeFormat);
+                add(start, i, functionFormat);
+            }
+            else if ((nextChar == u';' || nextChar == u'=') && previousTypeBefore(start))
+            {
+                add(previous.start, previous.end, typeFormat);
+            }
+
+            previous = { start, i, false };
+        }
+        else if (isDigit(c)) // number literals can contain letters and apostrophes, eg. 0x1F or 1'000'000ull
+        {
+            while (i < n && (isIdentifierPart(code[i]) || code[i] == u'\'' || code[i] == u'.'))
+                ++i;
+        }
+        else if (c == u'"' || c == u'\'')
+        {
+            const qsizetype end = findLiteralEnd(code, i);
+            if (end < 0 && c == u'\'')
+            {
+                ++i;
+                continue;
+            }
+
+            const qsizetype literalEnd = end < 0 ? n : end; // not closed string is highlighted to the end of fragment
+            add(i, literalEnd, stringFormat);
+            i = literalEnd;
+        }
+        else if (c == u'/' && i + 1 < n && code[i + 1] == u'/')
+        {
+            add(i, n, commentFormat);
+            return false;
+        }
+        else if (c == u'/' && i + 1 < n && code[i + 1] == u'*')
+        {
+            const qsizetype end = code.indexOf(u"*/", i + 2);
+            if (end < 0)
+            {
+                add(i, n, commentFormat);
+                return true;
+            }
+            add(i, end + 2, commentFormat);
+            i = end + 2;
+        }
+        else if (c == u'#' && i + 1 < n && isIdentifierStart(code[i + 1]))
+        {
+            const qsizetype start = i++;
+            while (i < n && isIdentifierStart(code[i]))
+                ++i;
+            add(start, i, preprocessorFormat);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    return false;
+}
+} // namespace cpp
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <QList>
+#include <QString>
+#include <QStringView>
+
+namespace cpp
+{
+/**
+ * @brief Keywords of C++ with names of their formats (from QCodeEditor's `cpp.xml`), looked up with a perfect hash.
+ *
+ * The seed and size of the table are chosen when it is built, so that no two keywords share a slot,
+ * then a lookup is one hash of the identifier and at most one comparison.
+ */
+class KeywordTable
+{
+public:
+    struct Keyword
+    {
+        QString word;
+        QString formatName;
+    };
+
+    KeywordTable() = default;
+
+    /// When a word is repeated, the later format wins (like the later rule used to overwrite the earlier one).
+    explicit KeywordTable(const QList<Keyword>& keywords);
+
+    /// nullptr if the identifier is not a keyword
+    const QString* formatOf(QStringView identifier) const;
+
+    bool isEmpty() const
+    {
+        return keywords.isEmpty();
+    }
+
+private:
+    static std::uint32_t hash(QStringView word, std::uint32_t seed);
+
+    QList<Keyword> keywords;
+    std::vector<std::int32_t> slots; // index in keywords or -1
+    std::uint32_t seed = 0;
+    std::uint32_t mask = 0;
+};
+
+struct Token
+{
+    int start;
+    int length;
+    QString formatName; // as in QSyntaxStyle, eg. "Keyword", "String", "Comment"
+};
+
+/**
+ * @brief Splits a fragment of C++ code into highlighted tokens in a single pass.
+ *
+ * Strings, char literals, comments and preprocessor directives are recognized while walking the text,
+ * so eg. keywords inside of strings are not reported. Identifiers are classified with `KeywordTable`,
+ * an identifier followed by `(` is a "Function" and the identifier before it (or before a declared variable) is a "Type".
+ *
+ * @return true if the fragment ends inside of a block comment
+ */
+bool tokenize(QStringView code, bool startsInsideComment, const KeywordTable& keywords, QList<Token>& tokens);
+} // namespace cpp
@@ -1,10 +1,11 @@
 #include <vector>
 #include <QSet>
+#include <QHash>
 #include <QStringList>
 
 #include "DiffCalculation.h"
-
-#include "pydifflib-cpp/difflib.hpp" /// it uses https://github.com/dominicprice/pydifflib-cpp
+#include "SequenceDiff.h"
+#include "Tracing.h"
 
 #include "diff-match-patch-cpp-stl/diff_match_patch.h" /// it uses https://github.com/leutloff/diff-match-patch-cpp-stl/
 
@@ -41,28 +42,60 @@ struct diff_match_patch_traits<char32_t>
 };
 
 
-namespace DiffCalculation
+namespace
 {
-QSet<int> calculateModifiedLines(const QStringList& oldLines, const QStringList& newLines)
+struct InternedLines
 {
-    using namespace pydifflib;
+    std::vector<std::uint64_t> oldIds;
+    std::vector<std::uint64_t> newIds;
+};
 
-    std::vector<std::string> a, b;
-    for (const auto& line : oldLines)
-        a.emplace_back(line.toStdString());
-    for (const auto& line : newLines)
-        b.emplace_back(line.toStdString());
+/// Equal lines get equal ids (numbers of distinct lines), the lines are not copied
+InternedLines internLines(const QStringList& oldLines, const QStringList& newLines)
+{
+    QHash<QStringView, std::uint64_t> ids;
+    ids.reserve(oldLines.size() + newLines.size());
+    const auto intern = [&ids](const QStringList& lines) {
+        std::vector<std::uint64_t> lineIds;
+        lineIds.reserve(lines.size());
+        for (const QString& line : lines)
+        {
+            auto id = ids.constFind(line);
+            if (id == ids.cend())
+                id = ids.insert(line, static_cast<std::uint64_t>(ids.size()));
+            lineIds.push_back(*id);
+        }
+        return lineIds;
+    };
 
-    SequenceMatcher matcher(a, b);
-    auto opcodes = matcher.get_opcodes();
+    InternedLines interned;
+    interned.oldIds = intern(oldLines);
+    interned.newIds = intern(newLines);
+    return interned;
+}
+
+std::vector<SequenceDiff::Opcode> diffLines(const QStringList& oldLines, const QStringList& newLines)
+{
+    const InternedLines interned = internLines(oldLines, newLines);
+    return SequenceDiff::computeOpcodes(interned.oldIds, interned.newIds);
+}
+} // namespace
+
+
+namespace DiffCalculation
+{
+QSet<int> calculateModifiedLines(const QStringList& oldLines, const QStringList& newLines)
+{
+    TRACE_SCOPE("diff", "calculateModifiedLines");
+    using SequenceDiff::Tag;
 
     QSet<int> modified;
 
-    for (const auto& op : opcodes)
+    for (const auto& op : diffLines(oldLines, newLines))
     {
-        if (op.tag != tag_t::t_equal)
+        if (op.tag != Tag::Equal)
         {
-            for (int i = op.j1; i < op.j2; ++i)
+            for (int i = op.newBegin; i < op.newEnd; ++i)
                 modified.insert(i + 1);  // linie liczymy od 1
         }
     }
@@ -72,40 +105,32 @@ QSet<int> calculateModifiedLines(const QStringList& oldLines, const QStringList&
 
 std::vector<DiffLine> computeDiff(const QStringList &oldLines, const QStringList &newLines)
 {
-    using namespace pydifflib;
-
-    std::vector<std::string> a, b;
-    for (const auto &line : oldLines)
-        a.push_back(line.toStdString());
-    for (const auto &line : newLines)
-        b.push_back(line.toStdString());
-
-    SequenceMatcher matcher(a, b);
-    auto opcodes = matcher.get_opcodes();
+    TRACE_SCOPE("diff", "computeDiff");
+    using SequenceDiff::Tag;
 
     std::vector<DiffLine> result;
 
-    for (const auto &op : opcodes)
+    for (const auto &op : diffLines(oldLines, newLines))
     {
-        int i1 = op.i1, i2 = op.i2; // old
-        int j1 = op.j1, j2 = op.j2; // new
+        int i1 = op.oldBegin, i2 = op.oldEnd; // old
+        int j1 = op.newBegin, j2 = op.newEnd; // new
 
         switch (op.tag)
         {
-        case tag_t::t_equal:
+        case Tag::Equal:
             for (int k = 0; k < i2 - i1; ++k)
             {
                 result.push_back(DiffLine{
                     .oldIndex = i1 + k,
                     .newIndex = j1 + k,
-                    .oldText = QString::fromStdString(a[i1 + k]),
-                    .newText = QString::fromStdString(b[j1 + k]),
+                    .oldText = oldLines[i1 + k],
+                    .newText = newLines[j1 + k],
                     .type = DiffType::Unchanged
                 });
             }
             break;
 
-        case tag_t::t_replace:
+        case Tag::Replace:
         {
             int len = std::max(i2 - i1, j2 - j1);
             for (int k = 0; k < len; ++k)
@@ -116,8 +141,8 @@ std::vector<DiffLine> computeDiff(const QStringList &oldLines, const QStringList
                 bool hasOld = oldIdx < i2;
                 bool hasNew = newIdx < j2;
 
-                QString oldText = hasOld ? QString::fromStdString(a[oldIdx]) : "";
-                QString newText = hasNew ? QString::fromStdString(b[newIdx]) : "";
+                QString oldText = hasOld ? oldLines[oldIdx] : "";
+                QString newText = hasNew ? newLines[newIdx] : "";
 
                 DiffType type;
                 if (hasOld && hasNew) {
@@ -139,27 +164,27 @@ std::vector<DiffLine> computeDiff(const QStringList &oldLines, const QStringList
         }
         break;
 
-        case tag_t::t_delete:
+        case Tag::Delete:
             for (int k = i1; k < i2; ++k)
             {
                 result.push_back(DiffLine{
                     .oldIndex = k,
                     .newIndex = -1,
-                    .oldText = QString::fromStdString(a[k]),
+                    .oldText = oldLines[k],
                     .newText = "",
                     .type = DiffType::Removed
                 });
             }
             break;
 
-        case tag_t::t_insert:
+        case Tag::Insert:
             for (int k = j1; k < j2; ++k)
             {
                 result.push_back(DiffLine{
                     .oldIndex = -1,
                     .newIndex = k,
                     .oldText = "",
-                    .newText = QString::fromStdString(b[k]),
+                    .newText = newLines[k],
                     .type = DiffType::Added
                 });
             }
@@ -172,6 +197,7 @@ std::vector<DiffLine> computeDiff(const QStringList &oldLines, const QStringList
 
 QList<LineDiffResult> computeModifiedLineDiffs(const std::vector<DiffLine>& diffLines)
 {
+    TRACE_SCOPE("diff", "computeModifiedLineDiffs");
     using DMP = diff_match_patch<std::u32string>;
     using Op = DMP::Operation;
 
@@ -240,6 +266,7 @@ QList<LineDiffResult> computeModifiedLineDiffs(const std::vector<DiffLine>& diff
 
 QList<LineDiffResult> computeAllLineDiffs(const std::vector<DiffLine>& diffLines)
 {
+    TRACE_SCOPE("diff", "computeAllLineDiffs");
     // using namespace DiffCalculation;
     using DMP = diff_match_patch<std::u32string>;
     using Op = DMP::Operation;
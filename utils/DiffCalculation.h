@@ -24,6 +24,7 @@ struct DiffLine
 };
 
 
+/// Lines are diffed as interned ids by `SequenceDiff`, numbers of modified or added lines are counted from 1
 QSet<int> calculateModifiedLines(const QStringList& oldLines, const QStringList& newLines);
 
 std::vector<DiffLine> computeDiff(const QStringList &oldLines, const QStringList &newLines);
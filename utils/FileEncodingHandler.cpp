@@ -2,7 +2,9 @@
 #include <QByteArray>
 #include <QStringDecoder>
 #include <QStringEncoder>
+#include <algorithm>
 #include <stdexcept>
+#include <utility>
 
 // https://gitlab.freedesktop.org/uchardet/uchardet
 #if __has_include(<uchardet.h>) // when installing with FetchContent_Declare from CMakeLists.txt
@@ -14,6 +16,7 @@
 #endif
 
 #include "FileEncodingHandler.h"
+#include "Tracing.h"
 
 struct FileEncodingHandler::Impl
 {
@@ -31,51 +34,127 @@ QString FileEncodingHandler::lastDetectedEncoding() const
     return impl->encodingName;
 }
 
-QString FileEncodingHandler::loadFile(const QString& filePath)
+namespace
 {
-    QFile file(filePath);
-    if (!file.open(QFile::ReadOnly))
-    {
-        throw std::runtime_error(("Cannot open file: " + filePath).toStdString());
-    }
+constexpr qsizetype detectionPrefixSize = 64 * 1024;
+constexpr qsizetype decodingChunkSize = 1024 * 1024;
 
-    QByteArray data = file.readAll();
-    file.close();
+/// Charsets which the prefix is not enough for, eg. a file starting with pure ASCII can contain Polish letters later
+bool needsFullScan(const char* charset)
+{
+    return !charset || strlen(charset) == 0 || 0 == qstrcmp(charset, "ASCII");
+}
 
-    // uchardet setup
+QString detectCharset(QByteArrayView data)
+{
+    TRACE_SCOPE("file", "detectCharset");
     uchardet_t detector = uchardet_new();
 
-    if (uchardet_handle_data(detector, data.constData(), data.size()) != 0)
+    auto feed = [detector](QByteArrayView part) {
+        if (uchardet_handle_data(detector, part.data(), part.size()) != 0)
+        {
+            uchardet_delete(detector);
+            throw std::runtime_error("uchardet failed to handle data");
+        }
+    };
+
+    feed(data.first(std::min(detectionPrefixSize, data.size())));
+    uchardet_data_end(detector);
+
+    if (needsFullScan(uchardet_get_charset(detector)) && data.size() > detectionPrefixSize)
     {
-        uchardet_delete(detector);
-        throw std::runtime_error("uchardet failed to handle data");
+        uchardet_reset(detector);
+        for (qsizetype from = 0; from < data.size(); from += detectionPrefixSize)
+        {
+            feed(data.sliced(from, std::min(detectionPrefixSize, data.size() - from)));
+        }
+        uchardet_data_end(detector);
     }
 
-    uchardet_data_end(detector);
     const char* charset = uchardet_get_charset(detector);
 
     // If detection failed, fallback to UTF-8
-    if (!charset || strlen(charset) == 0)
+    QString encodingName = (!charset || strlen(charset) == 0) ? QStringLiteral("UTF-8") : QString::fromUtf8(charset);
+
+    uchardet_delete(detector);
+    return encodingName;
+}
+} // namespace
+
+QString FileEncodingHandler::loadFile(const QString& filePath)
+{
+    QString content;
+    loadFile(filePath, [&content](QStringView chunk) {
+        content.append(chunk);
+    });
+    return content;
+}
+
+IncrementalFileDecoder::IncrementalFileDecoder(const QString& filePath)
+    : file(filePath)
+{
+    TRACE_SCOPE("file", "IncrementalFileDecoder: open");
+    if (!file.open(QFile::ReadOnly))
     {
-        impl->encodingName = "UTF-8";
+        throw std::runtime_error(("Cannot open file: " + filePath).toStdString());
     }
-    else
+
+    // Mapping does not copy the file into memory, pages are read by the system when decoder touches them
+    if (file.size() > 0)
     {
-        impl->encodingName = QString::fromUtf8(charset);
+        if (const uchar* mapped = file.map(0, file.size()))
+            data = QByteArrayView(mapped, file.size());
+    }
+    if (data.isNull()) // eg. empty file or a file system which does not support mapping
+    {
+        readData = file.readAll();
+        data = readData;
     }
 
-    uchardet_delete(detector);
+    encoding = detectCharset(data);
 
-    // Decode using detected encoding
-    QStringDecoder decoder(impl->encodingName.toUtf8());
+    // Decode using detected encoding, the decoder keeps state between pieces, so multibyte characters can be split
+    decoder = QStringDecoder(encoding.toUtf8());
     if (!decoder.isValid())
         decoder = QStringDecoder(QStringDecoder::Utf8);
+}
+
+QString IncrementalFileDecoder::decodeNext(qsizetype maxBytes)
+{
+    const qsizetype length = std::min(maxBytes, data.size() - position);
+    QString text = decoder.decode(data.sliced(position, length));
+    position += length;
+
+    if (std::exchange(pendingCarriageReturn, false))
+        text.prepend(u'\r');
+    if (text.endsWith(u'\r') && !atEnd())
+    {
+        pendingCarriageReturn = true;
+        text.chop(1);
+    }
+    return text;
+}
 
-    return decoder.decode(data);
+void FileEncodingHandler::loadFile(const QString& filePath, const std::function<void(QStringView chunk)>& consumeChunk)
+{
+    TRACE_SCOPE("file", "FileEncodingHandler::loadFile");
+    const auto decoder = openForDecoding(filePath);
+    while (!decoder->atEnd())
+    {
+        consumeChunk(decoder->decodeNext(decodingChunkSize));
+    }
+}
+
+std::unique_ptr<IncrementalFileDecoder> FileEncodingHandler::openForDecoding(const QString& filePath)
+{
+    auto decoder = std::make_unique<IncrementalFileDecoder>(filePath);
+    impl->encodingName = decoder->encodingName();
+    return decoder;
 }
 
 bool FileEncodingHandler::saveFile(const QString& filePath, const QString& content)
 {
+    TRACE_SCOPE("file", "FileEncodingHandler::saveFile");
     QFile file(filePath);
     if (!file.open(QFile::WriteOnly))
         return false;
@@ -1,7 +1,53 @@
 #pragma once
 
+#include <functional>
 #include <memory>
+#include <QByteArray>
+#include <QFile>
 #include <QString>
+#include <QStringDecoder>
+#include <QStringView>
+
+/// A file mapped into memory and decoded on demand piece by piece, eg. while it is inserted into a document in batches,
+/// so only the pieces not consumed yet are ever decoded. The file stays mapped until the decoder is destroyed.
+class IncrementalFileDecoder
+{
+public:
+    /// Opens the file and detects its encoding, throws if the file cannot be opened.
+    explicit IncrementalFileDecoder(const QString& filePath);
+
+    /// Decodes next `maxBytes` bytes of the file. The text never ends between '\r' and '\n', unless the file does.
+    QString decodeNext(qsizetype maxBytes);
+
+    bool atEnd() const
+    {
+        return position >= data.size();
+    }
+
+    qsizetype decodedBytes() const
+    {
+        return position;
+    }
+
+    qsizetype size() const
+    {
+        return data.size();
+    }
+
+    const QString& encodingName() const
+    {
+        return encoding;
+    }
+
+private:
+    QFile file;
+    QByteArray readData; // when the file cannot be mapped
+    QByteArrayView data;
+    QString encoding;
+    QStringDecoder decoder;
+    qsizetype position = 0;
+    bool pendingCarriageReturn = false;
+};
 
 class FileEncodingHandler
 {
@@ -12,6 +58,13 @@ public:
     // Load file with encoding detection: returns Unicode QString
     QString loadFile(const QString& filePath);
 
+    /// Streaming version: the file is memory mapped and decoded in chunks, so only one copy of the text is kept at once.
+    /// Throws before calling `consumeChunk` if the file cannot be opened. A chunk never ends between '\r' and '\n'.
+    void loadFile(const QString& filePath, const std::function<void(QStringView chunk)>& consumeChunk);
+
+    /// For decoding the file later, on demand. Throws if the file cannot be opened.
+    std::unique_ptr<IncrementalFileDecoder> openForDecoding(const QString& filePath);
+
     // Save file preserving original encoding or fallback
     bool saveFile(const QString& filePath, const QString& content);
 
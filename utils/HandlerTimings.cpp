@@ -0,0 +1,51 @@
+#include <atomic>
+#include <utility>
+#include "HandlerTimings.h"
+
+namespace HandlerTimings
+{
+namespace
+{
+std::atomic_bool enabled = false;
+
+thread_local Totals totals;
+thread_local Scope* innermostScope = nullptr;
+} // namespace
+
+void setEnabled(bool enable)
+{
+    enabled.store(enable, std::memory_order_relaxed);
+}
+
+bool isEnabled()
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+Totals take()
+{
+    return std::exchange(totals, {});
+}
+
+Scope::Scope(std::string_view name)
+{
+    if (!isEnabled())
+        return;
+
+    this->name = name;
+    enclosing = std::exchange(innermostScope, this);
+    start = Clock::now();
+}
+
+Scope::~Scope()
+{
+    if (name.empty())
+        return;
+
+    const auto elapsed = Clock::now() - start;
+    totals[name] += elapsed - nestedTime;
+    if (enclosing)
+        enclosing->nestedTime += elapsed;
+    innermostScope = enclosing;
+}
+} // namespace HandlerTimings
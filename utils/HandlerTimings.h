@@ -0,0 +1,44 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <string_view>
+#include "Tracing.h"
+
+/**
+ * @brief Time spent in handlers of edits, measured by `HANDLER_TIMING("name")` scopes when a harness enabled it.
+ *
+ * Time of nested scopes is subtracted from the enclosing scope, so every handler is reported with its own time only,
+ * eg. `StcDocumentModel::onContentsChange` without the panels it notifies. Timings are collected per thread.
+ * Disabled by default, then a scope costs one check of a flag. Handlers also appear in the trace, see `Tracing`.
+ */
+namespace HandlerTimings
+{
+using Clock = std::chrono::steady_clock;
+using Totals = std::map<std::string_view, Clock::duration>;
+
+void setEnabled(bool enabled);
+bool isEnabled();
+
+/// Own times of handlers of this thread since the previous call, the totals are cleared.
+Totals take();
+
+class Scope
+{
+public:
+    explicit Scope(std::string_view name);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    std::string_view name; // empty when timings are disabled
+    Clock::time_point start;
+    Clock::duration nestedTime{};
+    Scope* enclosing = nullptr;
+};
+} // namespace HandlerTimings
+
+/// `name` has to be a string literal
+#define HANDLER_TIMING(name) const HandlerTimings::Scope handlerTimingScope(name); TRACE_SCOPE("handler", name)
@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <QTextDocument>
+#include <QTextBlock>
+#include "IncrementalLineDiff.h"
+#include "DiffCalculation.h"
+
+
+namespace
+{
+/// Block text is normalised the same way as in `QTextDocument::toPlainText()`,
+/// so the lines are the same as when the whole document is splitted by '\n'
+QString lineOfBlock(const QTextBlock& block)
+{
+    QString text = block.text();
+    text.replace(QChar::Nbsp, u' ');
+    return text;
+}
+} // namespace
+
+
+void IncrementalLineDiff::resetOriginal(const QTextDocument* document)
+{
+    rehashAllCurrentLines(document);
+
+    originalLines.clear();
+    originalLines.reserve(document->blockCount());
+    for (QTextBlock block = document->begin(); block.isValid(); block = block.next())
+    {
+        originalLines.append(lineOfBlock(block));
+    }
+    originalHashes = currentHashes;
+    verifiedPrefix = verifiedSuffix = originalLines.size();
+}
+
+void IncrementalLineDiff::clearOriginal(const QTextDocument* document)
+{
+    originalLines.clear();
+    originalHashes.clear();
+    rehashAllCurrentLines(document);
+}
+
+void IncrementalLineDiff::rehashAllCurrentLines(const QTextDocument* document)
+{
+    verifiedPrefix = verifiedSuffix = 0;
+    currentHashes.clear();
+    currentHashes.reserve(document->blockCount());
+    for (QTextBlock block = document->begin(); block.isValid(); block = block.next())
+    {
+        currentHashes.append(qHash(lineOfBlock(block)));
+    }
+}
+
+void IncrementalLineDiff::onContentsChange(const QTextDocument* document, int position, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(charsRemoved); // number of removed blocks is calculated from the block count difference
+
+    QTextBlock firstBlock = document->findBlock(position);
+    QTextBlock lastBlock = document->findBlock(position + charsAdded);
+    if (!lastBlock.isValid()) // Qt reports change ranges including the final paragraph separator
+        lastBlock = document->lastBlock();
+
+    const int blocksDifference = document->blockCount() - static_cast<int>(currentHashes.size());
+    const int firstIndex = firstBlock.blockNumber();
+    const int lastNewIndex = lastBlock.blockNumber();
+    const int lastOldIndex = lastNewIndex - blocksDifference;
+
+    if (!firstBlock.isValid() || lastOldIndex < firstIndex - 1 || lastOldIndex >= currentHashes.size())
+    {
+        rehashAllCurrentLines(document);
+        return;
+    }
+
+    QList<size_t> changedHashes;
+    changedHashes.reserve(lastNewIndex - firstIndex + 1);
+    for (QTextBlock block = firstBlock; block.isValid() && block.blockNumber() <= lastNewIndex; block = block.next())
+    {
+        changedHashes.append(qHash(lineOfBlock(block)));
+    }
+
+    currentHashes.remove(firstIndex, lastOldIndex - firstIndex + 1);
+    currentHashes.insert(firstIndex, changedHashes.size(), 0);
+    std::copy(changedHashes.cbegin(), changedHashes.cend(), currentHashes.begin() + firstIndex);
+
+    // blocks before and after the changed ones are not touched, the same as their hashes
+    verifiedPrefix = std::min<qsizetype>(verifiedPrefix, firstIndex);
+    verifiedSuffix = std::min<qsizetype>(verifiedSuffix, currentHashes.size() - 1 - lastNewIndex);
+}
+
+QSet<int> IncrementalLineDiff::calculateModifiedLines(const QTextDocument* document) const
+{
+    const qsizetype oldCount = originalHashes.size();
+    const qsizetype newCount = currentHashes.size();
+
+    // identical lines at the beginning and at the end are not changed, so they don't need to be diffed,
+    // different lines can have the same hash, so their text is compared when the hashes are equal
+    const qsizetype maxCommon = std::min(oldCount, newCount);
+    qsizetype commonPrefix = std::min(verifiedPrefix, maxCommon);
+    QTextBlock firstDifferentBlock = document->findBlockByNumber(static_cast<int>(commonPrefix));
+    while (commonPrefix < maxCommon && originalHashes[commonPrefix] == currentHashes[commonPrefix]
+           && originalLines[commonPrefix] == lineOfBlock(firstDifferentBlock))
+    {
+        ++commonPrefix;
+        firstDifferentBlock = firstDifferentBlock.next();
+    }
+
+    qsizetype commonSuffix = std::min(verifiedSuffix, maxCommon - commonPrefix);
+    QTextBlock lastDifferentBlock = document->findBlockByNumber(static_cast<int>(newCount - 1 - commonSuffix));
+    while (commonSuffix < maxCommon - commonPrefix
+           && originalHashes[oldCount - 1 - commonSuffix] == currentHashes[newCount - 1 - commonSuffix]
+           && originalLines[oldCount - 1 - commonSuffix] == lineOfBlock(lastDifferentBlock))
+    {
+        ++commonSuffix;
+        lastDifferentBlock = lastDifferentBlock.previous();
+    }
+    verifiedPrefix = commonPrefix;
+    verifiedSuffix = commonSuffix;
+
+    const qsizetype oldWindowSize = oldCount - commonPrefix - commonSuffix;
+    const qsizetype newWindowSize = newCount - commonPrefix - commonSuffix;
+    if (0 == newWindowSize && 0 == oldWindowSize)
+    {
+        return {};
+    }
+
+    const QStringList oldWindow = originalLines.mid(commonPrefix, oldWindowSize);
+
+    QStringList newWindow;
+    newWindow.reserve(newWindowSize);
+    QTextBlock block = firstDifferentBlock;
+    for (qsizetype i = 0; i < newWindowSize && block.isValid(); ++i, block = block.next())
+    {
+        newWindow.append(lineOfBlock(block));
+    }
+
+    QSet<int> modified;
+    for (int lineInWindow : DiffCalculation::calculateModifiedLines(oldWindow, newWindow))
+    {
+        modified.insert(lineInWindow + commonPrefix);
+    }
+    return modified;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QList>
+#include <QSet>
+#include <QStringList>
+
+class QTextDocument;
+
+/**
+ * @brief Keeps track of lines modified against the original version of a document without re-diffing all of it.
+ *
+ * Lines of the original version are hashed once (when the file is loaded or saved).
+ * Hashes of the current content are updated only for the blocks touched by `QTextDocument::contentsChange`.
+ * When the modified lines are requested, identical leading and trailing lines are skipped (by comparing hashes,
+ * then the text of lines with equal hashes) and only the remaining window is diffed with `DiffCalculation::calculateModifiedLines`.
+ * Leading and trailing lines found identical stay so until an edit touches them, so their text is not compared again.
+ *
+ * Line numbers are counted from 1 - the same as `DiffCalculation::calculateModifiedLines` does.
+ */
+class IncrementalLineDiff
+{
+public:
+    /// Sets current content of the document as the original version.
+    void resetOriginal(const QTextDocument* document);
+
+    /// Forgets the original version (eg. for a new file), every line is treated as added.
+    void clearOriginal(const QTextDocument* document);
+
+    /// Should be connected to `QTextDocument::contentsChange` of the tracked document.
+    void onContentsChange(const QTextDocument* document, int position, int charsRemoved, int charsAdded);
+
+    QSet<int> calculateModifiedLines(const QTextDocument* document) const;
+
+    const QStringList& getOriginalLines() const
+    {
+        return originalLines;
+    }
+
+protected:
+    void rehashAllCurrentLines(const QTextDocument* document);
+
+private:
+    QStringList originalLines;
+    QList<size_t> originalHashes;
+    QList<size_t> currentHashes; // one hash per QTextBlock
+
+    // counts of leading and trailing lines known to be the same as in the original
+    mutable qsizetype verifiedPrefix = 0;
+    mutable qsizetype verifiedSuffix = 0;
+};
@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <cmath>
+#include "PreviewTransport.h"
+
+namespace
+{
+bool isUtf8Continuation(char byte)
+{
+    return (static_cast<unsigned char>(byte) & 0xC0) == 0x80;
+}
+} // namespace
+
+PreviewTransport::TextDelta PreviewTransport::makeDelta(std::string_view base, std::string_view text)
+{
+    const std::size_t shorter = std::min(base.size(), text.size());
+
+    std::size_t prefix = static_cast<std::size_t>(std::ranges::mismatch(base.substr(0, shorter), text.substr(0, shorter)).in1 - base.begin());
+    while (prefix > 0 && ((prefix < base.size() && isUtf8Continuation(base[prefix]))
+                          || (prefix < text.size() && isUtf8Continuation(text[prefix]))))
+    {
+        --prefix;
+    }
+
+    std::size_t suffix = 0;
+    while (suffix < shorter - prefix && base[base.size() - 1 - suffix] == text[text.size() - 1 - suffix])
+        ++suffix;
+    while (suffix > 0 && isUtf8Continuation(base[base.size() - suffix]))
+        --suffix; // the same bytes in both texts
+
+    return { .position = prefix,
+             .removedLength = base.size() - prefix - suffix,
+             .inserted = std::string(text.substr(prefix, text.size() - prefix - suffix)) };
+}
+
+std::optional<std::string> PreviewTransport::applyDelta(std::string_view base, const TextDelta& delta)
+{
+    if (delta.position > base.size() || delta.removedLength > base.size() - delta.position)
+        return std::nullopt;
+
+    std::string text;
+    text.reserve(base.size() - delta.removedLength + delta.inserted.size());
+    text.append(base.substr(0, delta.position));
+    text.append(delta.inserted);
+    text.append(base.substr(delta.position + delta.removedLength));
+    return text;
+}
+
+std::string PreviewTransport::textFingerprint(std::string_view text)
+{
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (const char c : text)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+
+    constexpr char digits[] = "0123456789abcdef";
+    std::string fingerprint(16, '0');
+    for (int digit = 15; digit >= 0; --digit, hash >>= 4)
+        fingerprint[static_cast<std::size_t>(digit)] = digits[hash & 0xF];
+    return fingerprint;
+}
+
+using PreviewTransport::LatencyHistogram;
+
+void LatencyHistogram::record(Duration latency)
+{
+    const auto microseconds = static_cast<std::uint64_t>(std::max<Duration::rep>(latency.count(), 1));
+    // bucket i keeps latencies up to 2^(i / bucketsPerPowerOfTwo)
+    const auto bucket = static_cast<int>(std::ceil(std::log2(static_cast<double>(microseconds)) * bucketsPerPowerOfTwo));
+    ++buckets[static_cast<std::size_t>(std::min(bucket, bucketsCount - 1))];
+    ++total;
+    maximum = std::max(maximum, latency);
+}
+
+LatencyHistogram::Duration LatencyHistogram::percentile(double fraction) const
+{
+    if (total == 0)
+        return Duration{};
+
+    const auto wanted = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(std::clamp(fraction, 0.0, 1.0) * static_cast<double>(total))));
+    std::uint64_t counted = 0;
+    for (int bucket = 0; bucket < bucketsCount; ++bucket)
+    {
+        counted += buckets[static_cast<std::size_t>(bucket)];
+        if (counted >= wanted)
+        {
+            const auto upperBound = Duration(static_cast<Duration::rep>(std::llround(std::exp2(static_cast<double>(bucket) / bucketsPerPowerOfTwo))));
+            return std::min(upperBound, maximum);
+        }
+    }
+    return maximum;
+}
+
+void LatencyHistogram::clear()
+{
+    buckets.fill(0);
+    total = 0;
+    maximum = Duration{};
+}
+
+using PreviewTransport::AdaptiveDebounce;
+
+void AdaptiveDebounce::addLatency(Milliseconds latency)
+{
+    constexpr double weightOfNewLatency = 0.3;
+    const auto milliseconds = static_cast<double>(latency.count());
+    smoothedLatencyMilliseconds = smoothedLatencyMilliseconds
+        ? (1 - weightOfNewLatency) * *smoothedLatencyMilliseconds + weightOfNewLatency * milliseconds
+        : milliseconds;
+}
+
+AdaptiveDebounce::Milliseconds AdaptiveDebounce::onEdit(Clock::time_point now)
+{
+    if (!burstStart)
+        burstStart = now;
+
+    const Milliseconds delay = currentDelay();
+    const auto sinceBurstStart = std::chrono::duration_cast<Milliseconds>(now - *burstStart);
+    return std::clamp(2 * delay - sinceBurstStart, Milliseconds::zero(), delay);
+}
+
+AdaptiveDebounce::Milliseconds AdaptiveDebounce::currentDelay() const
+{
+    const double latency = smoothedLatencyMilliseconds.value_or(0);
+    const auto delay = Milliseconds(static_cast<Milliseconds::rep>(settings.latencyFraction * latency));
+    return std::clamp(delay, settings.minimumDelay, settings.maximumDelay);
+}
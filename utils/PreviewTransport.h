@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Parts of the client of the remote STC preview which do not need Qt:
+ * deltas of the text against the one the server already has, the debounce of edits and the latency histogram.
+ *
+ * The server announces that it accepts deltas by the `X-Stc-Delta: 1` header of its replies,
+ * then a request can carry `stcBase` (`textFingerprint` of the acknowledged text), `stcFrom`, `stcRemoved`
+ * and `stcInserted` instead of the whole `stc`. The server answers 409 when it does not have the base text.
+ * Positions and lengths are in bytes of UTF-8 text.
+ */
+namespace PreviewTransport
+{
+/// Replacement of `removedLength` bytes at `position` by `inserted`, it turns the base text into the new one
+struct TextDelta
+{
+    std::size_t position = 0;
+    std::size_t removedLength = 0;
+    std::string inserted;
+};
+
+/// The smallest single replacement, found by the common beginning and ending. It never splits UTF-8 characters.
+TextDelta makeDelta(std::string_view base, std::string_view text);
+
+/// nullopt when the delta does not fit the base
+std::optional<std::string> applyDelta(std::string_view base, const TextDelta& delta);
+
+/// Identifies the text a delta was made against, the same on every platform (FNV-1a, 16 hex digits)
+std::string textFingerprint(std::string_view text);
+
+/**
+ * @brief Counts latencies in buckets growing by 2^(1/4) (~19%), from 1 µs up to over an hour, so percentiles are
+ * approximate, but recording is constant time and memory does not grow.
+ */
+class LatencyHistogram
+{
+public:
+    using Duration = std::chrono::microseconds;
+
+    void record(Duration latency);
+
+    /// Upper bound of the bucket with the given percentile (eg. 0.95), not more than the maximal latency; 0 when empty
+    Duration percentile(double fraction) const;
+
+    std::uint64_t count() const
+    {
+        return total;
+    }
+
+    void clear();
+
+private:
+    static constexpr int bucketsPerPowerOfTwo = 4;
+    static constexpr int bucketsCount = 32 * bucketsPerPowerOfTwo;
+
+    std::array<std::uint64_t, bucketsCount> buckets{};
+    std::uint64_t total = 0;
+    Duration maximum{};
+};
+
+struct DebounceSettings
+{
+    std::chrono::milliseconds minimumDelay{20};
+    std::chrono::milliseconds maximumDelay{1000};
+    double latencyFraction = 0.5; // of the smoothed latency of the server
+};
+
+/**
+ * @brief Chooses how long to wait for further edits before sending the text, depending on how fast the server answers.
+ *
+ * With a fast server the text is sent almost at once. With a slow one the edits made while waiting are coalesced
+ * into one request, the reply would not come earlier anyway. During a long burst of typing the text is still sent
+ * at least every two delays.
+ */
+class AdaptiveDebounce
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::milliseconds;
+
+    AdaptiveDebounce() = default;
+    explicit AdaptiveDebounce(DebounceSettings settings) : settings(settings)
+    {
+    }
+
+    /// Latency of a finished request, smoothed exponentially
+    void addLatency(Milliseconds latency);
+
+    /// For an edit made at `now`: how long to wait before sending the text
+    Milliseconds onEdit(Clock::time_point now);
+
+    /// The text was sent, the next edit starts a new burst
+    void onSent()
+    {
+        burstStart.reset();
+    }
+
+    Milliseconds currentDelay() const;
+
+private:
+    DebounceSettings settings;
+    std::optional<double> smoothedLatencyMilliseconds;
+    std::optional<Clock::time_point> burstStart;
+};
+} // namespace PreviewTransport
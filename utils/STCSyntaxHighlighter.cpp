@@ -6,6 +6,10 @@
 #include "STCSyntaxHighlighter.h"
 #include "../stcSyntaxPatterns.h"
 #include "../types/stcTags.h"
+#include "StcTagScanner.h"
+#include "CppLexer.h"
+#include "HandlerTimings.h"
+#include "Tracing.h"
 
 
 namespace
@@ -39,8 +43,17 @@ enum BlockState // TODO: Why not to use `enum class StcTags: std::uint32_t` inst
     STATE_CODE_CPP_COMMENT= 0x20000,
 };
 
-constexpr bool PRINT_DEBUG = false; // TODO: Remove when formatting fully works
-#define DEBUG(condition, text) if (PRINT_DEBUG && condition) qDebug() << "\t " << #text << " changes" << __LINE__ << currentBlockState()
+constexpr qint64 backgroundSliceMs = 10; // then the event loop can process input and painting
+
+/// Marks a block whose highlighting was postponed, any highlighted block has no user data
+class PendingHighlight : public QTextBlockUserData
+{
+};
+
+bool isPendingHighlight(const QTextBlock& block)
+{
+    return dynamic_cast<PendingHighlight*>(block.userData()) != nullptr;
+}
 
 QString format2String(const QTextCharFormat &format)
 {
@@ -87,6 +100,115 @@ QString format2String(const QTextCharFormat &format)
 
     return str;
 }
+
+/// `[name]` without attributes - the same as regular expression `\[name\]`
+bool isPlainOpeningTag(const stc::TagToken& tag, QStringView text, QStringView name)
+{
+    return !tag.closing && 0 == tag.attributesLength && tag.name(text) == name;
+}
+
+/// `[/name]` - the same as regular expression `\[/name\]`
+bool isPlainClosingTag(const stc::TagToken& tag, QStringView text, QStringView name)
+{
+    return tag.closing && 0 == tag.attributesLength && tag.name(text) == name;
+}
+
+/// `[name]` or `[name attributes...]` - the same as regular expression `\[name(\s+[^\]]*)?\]`
+bool isOpeningTagWithOptionalAttributes(const stc::TagToken& tag, QStringView text, QStringView name)
+{
+    const QStringView attributes = tag.attributes(text);
+    return !tag.closing && tag.name(text) == name && (attributes.isEmpty() || attributes.front().isSpace());
+}
+
+bool isDivClosingTag(const stc::TagToken& tag, QStringView text)
+{
+    return isPlainClosingTag(tag, text, u"div") || isPlainClosingTag(tag, text, u"cytat");
+}
+
+/// State of the block opened by [div], [div class="tip"], [div class="uwaga"] or [cytat], 0 for other tags
+int divBlockState(const stc::TagToken& tag, QStringView text)
+{
+    if (tag.closing)
+        return 0;
+
+    const QStringView name = tag.name(text);
+    const QStringView attributes = tag.attributes(text);
+    if (name == u"cytat")
+        return attributes.isEmpty() ? DIV_CLASS_CYTAT : 0;
+    if (name != u"div")
+        return 0;
+    if (attributes.isEmpty())
+        return DIV_CLASS_PLAIN;
+    if (!attributes.front().isSpace())
+        return 0;
+
+    const QStringView divClass = attributes.trimmed();
+    if (divClass == u"class=\"tip\"")
+        return DIV_CLASS_TIP;
+    if (divClass == u"class=\"uwaga\"")
+        return DIV_CLASS_UWAGA;
+    return 0;
+}
+
+/// [cpp], [py] or [code] with optional src="..." attribute, src is set to the attribute's value
+bool isCodeOpeningTag(const stc::TagToken& tag, QStringView text, QStringView& src)
+{
+    const QStringView name = tag.name(text);
+    if (tag.closing || (name != u"cpp" && name != u"py" && name != u"code"))
+        return false;
+
+    const QStringView attributes = tag.attributes(text);
+    if (attributes.isEmpty())
+    {
+        src = {};
+        return true;
+    }
+
+    const auto value = stc::attributeValue(attributes, u"src");
+    if (!attributes.front().isSpace() || !value || value->isEmpty())
+        return false;
+
+    src = *value;
+    return true;
+}
+
+/// First tag of the line starting at `from` or later which fulfills the predicate
+template<typename Predicate>
+const stc::TagToken* findTag(const QList<stc::TagToken>& tags, int from, Predicate predicate)
+{
+    auto it = std::lower_bound(tags.cbegin(), tags.cend(), from, [](const stc::TagToken& tag, int position) {
+        return tag.start < position;
+    });
+    for (; it != tags.cend(); ++it)
+    {
+        if (predicate(*it))
+            return &*it;
+    }
+    return nullptr;
+}
+
+/// Position of the whole word (like `\bword\b`), -1 if there is no such word
+qsizetype indexOfWord(QStringView text, QStringView word)
+{
+    auto isWordCharacter = [](QChar c) { return c.isLetterOrNumber() || c == u'_'; };
+
+    for (qsizetype from = 0; ; )
+    {
+        const qsizetype index = text.indexOf(word, from);
+        if (index < 0)
+            return -1;
+
+        const qsizetype end = index + word.size();
+        if ((index == 0 || !isWordCharacter(text[index - 1])) && (end == text.size() || !isWordCharacter(text[end])))
+            return index;
+        from = index + 1;
+    }
+}
+
+int offsetIn(QStringView text, QStringView part)
+{
+    return static_cast<int>(part.data() - text.data());
+}
 } // namespace
 
 
@@ -169,44 +291,146 @@ STCSyntaxHighlighter::STCSyntaxHighlighter(QTextDocument *parent)
     tagFmt.setForeground(Qt::gray);
     tagFmt.setFontPointSize(8);
     styledTagsMap.insert("tag.attr", { "tag.attr", tagFmt });
+
+    connect(&spellCheckService, &SpellCheckService::wordsChecked, this, &STCSyntaxHighlighter::onWordsSpellchecked);
+
+    pendingBlocksTimer.setInterval(0);
+    connect(&pendingBlocksTimer, &QTimer::timeout, this, &STCSyntaxHighlighter::highlightPendingBlocks);
+    if (parent)
+    {
+        // removed lines move pending blocks up, so the search for them has to start at least from the changed line
+        connect(parent, &QTextDocument::contentsChange, this, [this](int position, int, int) {
+            firstPendingBlockNumber = std::min(firstPendingBlockNumber, std::max(0, document()->findBlock(position).blockNumber()));
+        });
+    }
+}
+
+void STCSyntaxHighlighter::setVisibleBlocks(int firstBlockNumber, int lastBlockNumber)
+{
+    visibleBlocks = std::make_pair(firstBlockNumber, lastBlockNumber);
+
+    for (QTextBlock block = document()->findBlockByNumber(std::max(0, firstBlockNumber));
+         block.isValid() && block.blockNumber() <= lastBlockNumber;
+         block = block.next())
+    {
+        if (isPendingHighlight(block))
+            rehighlightBlock(block); // with the state of previous block as it is now, corrected when the previous one is highlighted
+    }
+}
+
+bool STCSyntaxHighlighter::shouldPostponeCurrentBlock() const
+{
+    if (!visibleBlocks)
+        return false;
+
+    if (highlightingInBackground)
+        return backgroundSliceTimer.hasExpired(backgroundSliceMs);
+
+    const int blockNumber = currentBlock().blockNumber();
+    return blockNumber < visibleBlocks->first || blockNumber > visibleBlocks->second;
+}
+
+void STCSyntaxHighlighter::postponeCurrentBlock()
+{
+    // the state is not changed, so QSyntaxHighlighter does not go on with the following blocks because of this one
+    if (!isPendingHighlight(currentBlock()))
+        setCurrentBlockUserData(new PendingHighlight);
+
+    firstPendingBlockNumber = std::min(firstPendingBlockNumber, currentBlock().blockNumber());
+    if (!pendingBlocksTimer.isActive())
+        pendingBlocksTimer.start();
+}
+
+void STCSyntaxHighlighter::highlightPendingBlocks()
+{
+    TRACE_SCOPE("highlighter", "highlightPendingBlocks");
+    backgroundSliceTimer.start();
+    highlightingInBackground = true;
+
+    QTextBlock block = document()->findBlockByNumber(firstPendingBlockNumber);
+    for (; block.isValid() && !backgroundSliceTimer.hasExpired(backgroundSliceMs); block = block.next())
+    {
+        if (isPendingHighlight(block))
+            rehighlightBlock(block); // blocks after it are highlighted too as long as their states change
+    }
+
+    highlightingInBackground = false;
+
+    if (block.isValid())
+    {
+        firstPendingBlockNumber = block.blockNumber();
+    }
+    else
+    {
+        firstPendingBlockNumber = std::numeric_limits<int>::max();
+        pendingBlocksTimer.stop();
+    }
+}
+
+void STCSyntaxHighlighter::onWordsSpellchecked(const QStringList& words)
+{
+    // only misspelled words change the look of a block, correct ones were displayed as correct while being checked
+    QList<QTextBlock> blocksToRehighlight;
+    for (const QString& word : words)
+    {
+        const QList<QTextBlock> blocks = blocksWaitingForWord.take(word);
+        if (SpellCheckService::Verdict::Misspelled == spellCheckService.verdict(word))
+            blocksToRehighlight.append(blocks);
+    }
+
+    QSet<int> rehighlightedBlocks;
+    for (const QTextBlock& block : blocksToRehighlight)
+    {
+        if (block.isValid() && block.document() == document() && !rehighlightedBlocks.contains(block.blockNumber()))
+        {
+            rehighlightedBlocks.insert(block.blockNumber());
+            rehighlightBlock(block);
+        }
+    }
 }
 
 void STCSyntaxHighlighter::highlightBlock(const QString &text)
 {
+    HANDLER_TIMING("STCSyntaxHighlighter::highlightBlock");
+    if (shouldPostponeCurrentBlock())
+    {
+        postponeCurrentBlock();
+        return;
+    }
+    if (currentBlockUserData())
+        setCurrentBlockUserData(nullptr);
+
     _codeRangesThisLine.clear();     // clear before each line
     _noFormatRangesThisLine.clear(); // clear before each line
 
+    _tagsThisLine.clear(); // all the stages use tags found here instead of their own regular expressions
+    stc::TagScanner scanner(text);
+    while (auto tag = scanner.next())
+        _tagsThisLine.append(*tag);
+
     const int prev = previousBlockState();  // save before overwriting
-    DEBUG(true, "----------") << prev << text;
 
     // --- 1. DIV (outermost) ---
     bool divChanges = highlightDivBlock(text);
-    DEBUG(divChanges, "div");
 
     // --- 2. Headers ---
     bool headersChanges = highlightHeading(text);
-    DEBUG(divChanges, "hN");
 
     // // --- 3. pkt / csv (may contain other tags) ---
     bool pktOrCsvChanges = highlightPktOrCsv(text);
     if (pktOrCsvChanges)
     {
-        DEBUG(pktOrCsvChanges, "pkt/csv");
-        bool divChanges = highlightDivBlock(text);
-        DEBUG(divChanges, "div");
+        highlightDivBlock(text);
     }
 
     // // --- 4. Code blocks ---
     bool codeChanges = highlightCodeBlock(text);
-    DEBUG(codeChanges, "code");
 
     // --- 5. Stylizacja tekstu (b/i/u/s) ---
     bool styleChanges = highlightTextStyleTags(text);
-    DEBUG(styleChanges, "style");
 
     // --- 6. Tagi z atrybutami [a href=...] ---
     bool hrefImgChanges = highlightTagsWithAttributes(text);
-    DEBUG(hrefImgChanges, "href/img");
 
     // --- 7. Spellcheck for untagged plain text ---
     highlightPlainTextContent(text);
@@ -218,45 +442,53 @@ void STCSyntaxHighlighter::highlightBlock(const QString &text)
 
 bool STCSyntaxHighlighter::highlightHeading(const QString &text)
 {
+    TRACE_SCOPE("highlighter", "highlightHeading");
     bool found = false;
 
-    for (const auto& styled : styledTags)
+    for (qsizetype i = 0; i < _tagsThisLine.size(); ++i)
     {
-        if (!styled.tag.startsWith("h"))
+        const stc::TagToken& opening = _tagsThisLine[i];
+        const QStringView tagName = opening.name(text);
+        if (opening.closing || opening.attributesLength != 0 || tagName.size() != 2 || tagName[0] != u'h')
             continue;
 
-        QRegularExpression re(QStringLiteral(R"(\[(%1)\](.*?)\[/\1\])").arg(styled.tag));
-        QRegularExpressionMatchIterator it = re.globalMatch(text);
+        const auto styled = styledTagsMap.constFind(tagName.toString());
+        if (styled == styledTagsMap.cend())
+            continue;
 
-        while (it.hasNext())
-        {
-            auto match = it.next();
-            const int fullStart = match.capturedStart(0);
-            const int contentStart = match.capturedStart(2);
-            const int contentLen = match.capturedLength(2);
-            const int fullEnd = match.capturedEnd(0);
+        const stc::TagToken* closing = findTag(_tagsThisLine, opening.end(), [&](const stc::TagToken& tag) {
+            return isPlainClosingTag(tag, text, tagName);
+        });
+        if (!closing)
+            continue;
 
-            // Format heading content
-            setFormat(contentStart, contentLen, styled.format);
+        const int fullStart = opening.start;
+        const int contentStart = opening.end();
+        const int contentLen = closing->start - contentStart;
+        const int fullEnd = closing->end();
 
-            // Format heading tags ([h1], [/h1])
-            QTextCharFormat tagFmt;
-            tagFmt.setForeground(Qt::gray);
-            tagFmt.setFontPointSize(8);
-            setFormat(fullStart, contentStart - fullStart, tagFmt);                              // opening tag
-            setFormat(contentStart + contentLen, fullEnd - (contentStart + contentLen), tagFmt); // closing tag
+        // Format heading content
+        setFormat(contentStart, contentLen, styled->format);
 
-            // Apply spellcheck to the content
-            applySpellcheckToTextRange(text, contentStart, contentLen, styled.format);
+        // Format heading tags ([h1], [/h1])
+        QTextCharFormat tagFmt;
+        tagFmt.setForeground(Qt::gray);
+        tagFmt.setFontPointSize(8);
+        setFormat(fullStart, contentStart - fullStart, tagFmt);                              // opening tag
+        setFormat(contentStart + contentLen, fullEnd - (contentStart + contentLen), tagFmt); // closing tag
 
-            found = true;
-        }
+        // Apply spellcheck to the content
+        applySpellcheckToTextRange(text, contentStart, contentLen, styled->format);
+
+        found = true;
+        i = std::distance(_tagsThisLine.constData(), closing);
     }
     return found;
-} // TODO: Why not to find all headers at once, but searching text 6 times?
+}
 
 bool STCSyntaxHighlighter::highlightDivBlock(const QString &text)
 {
+    TRACE_SCOPE("highlighter", "highlightDivBlock");
     static QTextCharFormat tagFmt = [] {
         QTextCharFormat fmt;
         fmt.setForeground(Qt::gray);
@@ -286,10 +518,12 @@ bool STCSyntaxHighlighter::highlightDivBlock(const QString &text)
             else
                 fmt = styledTagsMap.value("div").format;
 
-            QRegularExpressionMatch closeMatch = stc::syntax::divCloseRe.match(text);
-            if (closeMatch.hasMatch())
+            const stc::TagToken* closeTag = findTag(_tagsThisLine, 0, [&text](const stc::TagToken& tag) {
+                return isDivClosingTag(tag, text);
+            });
+            if (closeTag)
             {
-                int closeStart = closeMatch.capturedStart();
+                int closeStart = closeTag->start;
                 int contentLen = closeStart;
 
                 // if (overlapsWithNoFormat(closeStart, closingTag.size())) // TODO:
@@ -302,7 +536,7 @@ bool STCSyntaxHighlighter::highlightDivBlock(const QString &text)
                 applySpellcheckToTextRange(text, 0, contentLen, fmt);
 
                 // Format closing tag
-                setFormat(closeStart, closeMatch.capturedLength(0), tagFmt);
+                setFormat(closeStart, closeTag->length, tagFmt);
                 currentBlockStateWithoutFlag(prevState);
             } else {
                 setFormat(0, text.length(), fmt);
@@ -315,50 +549,33 @@ bool STCSyntaxHighlighter::highlightDivBlock(const QString &text)
     }
 
     // === 2. Look for new div/cytat blocks in this line ===
-    QRegularExpressionMatchIterator it = stc::syntax::divOpenRe.globalMatch(text);
-    while (it.hasNext())
+    for (const stc::TagToken& openTag : _tagsThisLine)
     {
-        QRegularExpressionMatch openMatch = it.next();
-        int tagStart = openMatch.capturedStart(0);
-        int tagEnd = openMatch.capturedEnd(0);
+        const int blockState = divBlockState(openTag, text);
+        if (!blockState)
+            continue;
 
-        const QString tagName = openMatch.captured(1); // "div"
-        const QString divClass = openMatch.captured(2); // "tip" / "uwaga"
-        const QString quoteTag = openMatch.captured(3); // "cytat"
+        int tagStart = openTag.start;
+        int tagEnd = openTag.end();
 
         QTextCharFormat fmt;
-        int blockState = DIV_CLASS_PLAIN;
-
-        if (tagName == "div")
-        {
-            if (divClass == "tip")
-            {
-                fmt = styledTagsMap.value("tip").format;
-                blockState = DIV_CLASS_TIP;
-            }
-            else if (divClass == "uwaga")
-            {
-                fmt = styledTagsMap.value("warning").format;
-                blockState = DIV_CLASS_UWAGA;
-            }
-            else
-            {
-                fmt = styledTagsMap.value("div").format;
-                blockState = DIV_CLASS_PLAIN;
-            }
-        }
-        else if (!quoteTag.isEmpty())
-        {
+        if (blockState == DIV_CLASS_TIP)
+            fmt = styledTagsMap.value("tip").format;
+        else if (blockState == DIV_CLASS_UWAGA)
+            fmt = styledTagsMap.value("warning").format;
+        else if (blockState == DIV_CLASS_CYTAT)
             fmt = styledTagsMap.value("cytat").format;
-            blockState = DIV_CLASS_CYTAT;
-        }
+        else
+            fmt = styledTagsMap.value("div").format;
 
-        QRegularExpressionMatch closeMatch = stc::syntax::divCloseRe.match(text, tagEnd);
-        if (closeMatch.hasMatch())
+        const stc::TagToken* closeTag = findTag(_tagsThisLine, tagEnd, [&text](const stc::TagToken& tag) {
+            return isDivClosingTag(tag, text);
+        });
+        if (closeTag)
         {
             // One-line block
             int contentStart = tagEnd;
-            int contentEnd = closeMatch.capturedStart(0);
+            int contentEnd = closeTag->start;
             int contentLen = contentEnd - contentStart;
 
             // Format opening tag
@@ -369,7 +586,7 @@ bool STCSyntaxHighlighter::highlightDivBlock(const QString &text)
             applySpellcheckToTextRange(text, contentStart, contentLen, fmt);
 
             // Format closing tag
-            setFormat(closeMatch.capturedStart(0), closeMatch.capturedLength(0), tagFmt);
+            setFormat(closeTag->start, closeTag->length, tagFmt);
             currentBlockStateWithFlag(prevState);
         }
         else
@@ -401,7 +618,14 @@ void STCSyntaxHighlighter::applySpellcheckToTextRange(const QString& text, int s
         if (overlapsWithCode(wordStart, wordLen) || overlapsWithNoFormat(wordStart, wordLen))
             continue;
 
-        if (!spellChecker.isCorrect(word))
+        const auto verdict = spellCheckService.verdict(word);
+        if (SpellCheckService::Verdict::Unknown == verdict)
+        {
+            QList<QTextBlock>& waitingBlocks = blocksWaitingForWord[word];
+            if (waitingBlocks.isEmpty() || waitingBlocks.last() != currentBlock()) // the block is highlighted again on every edit
+                waitingBlocks.append(currentBlock());
+        }
+        else if (SpellCheckService::Verdict::Misspelled == verdict)
         {
             QTextCharFormat errFmt = baseFormat;
             errFmt.setUnderlineColor(Qt::red);
@@ -413,6 +637,7 @@ void STCSyntaxHighlighter::applySpellcheckToTextRange(const QString& text, int s
 
 bool STCSyntaxHighlighter::highlightPktOrCsv(const QString& text)
 {
+    TRACE_SCOPE("highlighter", "highlightPktOrCsv");
     static const QTextCharFormat runTagFmt = [] {
         QTextCharFormat fmt;
         fmt.setForeground(Qt::gray);
@@ -426,19 +651,21 @@ bool STCSyntaxHighlighter::highlightPktOrCsv(const QString& text)
     // --- 1. Continuation of multiline pkt/csv block ---
     if (prevState != STATE_NONE)
     {
-        auto handleBlock = [&](int stateFlag, const QString& tagName, const QRegularExpression& closeRe) {
+        auto handleBlock = [&](int stateFlag, const QString& tagName) {
             if (!(prevState & stateFlag))
                 return;
 
-            QRegularExpressionMatch close = closeRe.match(text);
+            const stc::TagToken* close = findTag(_tagsThisLine, 0, [&](const stc::TagToken& tag) {
+                return isPlainClosingTag(tag, text, tagName);
+            });
             QTextCharFormat fmt = styledTagsMap.value(tagName).format;
 
-            if (close.hasMatch())
+            if (close)
             {
-                int closeStart = close.capturedStart();
+                int closeStart = close->start;
                 setFormat(0, closeStart, fmt);
                 applySpellcheckToTextRange(text, 0, closeStart, fmt);
-                setFormat(closeStart, close.capturedLength(), runTagFmt);
+                setFormat(closeStart, close->length, runTagFmt);
                 currentBlockStateWithoutFlag(stateFlag);
             }
             else
@@ -451,23 +678,32 @@ bool STCSyntaxHighlighter::highlightPktOrCsv(const QString& text)
             foundAny = true;
         };
 
-        handleBlock(STATE_PKT, "pkt", stc::syntax::pktCloseRe);
-        handleBlock(STATE_CSV, "csv", stc::syntax::csvCloseRe);
+        handleBlock(STATE_PKT, "pkt");
+        handleBlock(STATE_CSV, "csv");
 
         // Format [run] only if in extended mode
         bool extendedMode = text.contains("ext") || text.contains("extended") || text.contains("extended header");
 
-        auto runMatches = stc::syntax::runTagRe.globalMatch(text);
-        while (runMatches.hasNext())
+        for (qsizetype i = 0; i < _tagsThisLine.size(); ++i)
         {
-            auto m = runMatches.next();
-            setFormat(m.capturedStart(), 5, runTagFmt); // [run]
-            setFormat(m.capturedEnd() - 6, 6, runTagFmt); // [/run]
+            const stc::TagToken& runOpen = _tagsThisLine[i];
+            if (!isPlainOpeningTag(runOpen, text, u"run"))
+                continue;
+
+            const stc::TagToken* runClose = findTag(_tagsThisLine, runOpen.end(), [&text](const stc::TagToken& tag) {
+                return isPlainClosingTag(tag, text, u"run");
+            });
+            if (!runClose)
+                break;
+
+            setFormat(runOpen.start, runOpen.length, runTagFmt);   // [run]
+            setFormat(runClose->start, runClose->length, runTagFmt); // [/run]
 
             if (extendedMode)
             {
-                _noFormatRangesThisLine.append({ m.capturedStart(1), m.capturedLength(1) });
+                _noFormatRangesThisLine.append({ runOpen.end(), runClose->start - runOpen.end() });
             }
+            i = std::distance(_tagsThisLine.constData(), runClose);
         }
 
         if (foundAny)
@@ -475,40 +711,40 @@ bool STCSyntaxHighlighter::highlightPktOrCsv(const QString& text)
     }
 
     // --- 2. New openings on the same line ---
-    auto processTag = [&](const QRegularExpression& openRe,
-                          const QRegularExpression& closeRe,
-                          const QString& tagName,
-                          int stateFlag)
+    auto processTag = [&](const QString& tagName, int stateFlag)
     {
         QTextCharFormat fmt = styledTagsMap.value(tagName).format;
 
-        QRegularExpressionMatchIterator it = openRe.globalMatch(text);
-        while (it.hasNext())
+        for (const stc::TagToken& open : _tagsThisLine)
         {
-            QRegularExpressionMatch open = it.next();
-            int tagStart = open.capturedStart();
-            int tagEnd = open.capturedEnd();
+            if (!isOpeningTagWithOptionalAttributes(open, text, tagName))
+                continue;
+
+            int tagStart = open.start;
+            int tagEnd = open.end();
 
             // If tag or its content overlaps with excluded area — skip
             int totalEnd = text.length(); // in case of no closing tag
-            QRegularExpressionMatch close = closeRe.match(text, tagEnd);
-            if (close.hasMatch())
-                totalEnd = close.capturedEnd();
+            const stc::TagToken* close = findTag(_tagsThisLine, tagEnd, [&](const stc::TagToken& tag) {
+                return isPlainClosingTag(tag, text, tagName);
+            });
+            if (close)
+                totalEnd = close->end();
 
             // if (overlapsWithNoFormat(tagStart, totalEnd - tagStart)) // TODO:
             //     continue;
 
             setFormat(tagStart, tagEnd - tagStart, runTagFmt);
 
-            if (close.hasMatch())
+            if (close)
             {
                 int contentStart = tagEnd;
-                int contentEnd = close.capturedStart();
+                int contentEnd = close->start;
                 int contentLen = contentEnd - contentStart;
 
                 setFormat(contentStart, contentLen, fmt);
                 applySpellcheckToTextRange(text, contentStart, contentLen, fmt);
-                setFormat(close.capturedStart(), close.capturedLength(), runTagFmt);
+                setFormat(close->start, close->length, runTagFmt);
             }
             else
             {
@@ -521,52 +757,42 @@ bool STCSyntaxHighlighter::highlightPktOrCsv(const QString& text)
         }
     };
 
-    processTag(stc::syntax::pktOpenRe, stc::syntax::pktCloseRe, "pkt", STATE_PKT);
-    processTag(stc::syntax::csvOpenRe, stc::syntax::csvCloseRe, "csv", STATE_CSV);
+    processTag("pkt", STATE_PKT);
+    processTag("csv", STATE_CSV);
 
     return foundAny;
 } // TODO: Dodać ignorowanie, gdy tagi nie wewnątrz `[run]`
 
-void STCSyntaxHighlighter::currentBlockStateWithoutFlag(int flag, std::source_location location)
+void STCSyntaxHighlighter::currentBlockStateWithoutFlag(int flag)
 {
     const auto previous = previousBlockState();
     if (previous == flag)
     {
-        DEBUG(true, "\t-") << "\t usuwamy poprzednia flage: " << flag << ". linia:" << location.line();
         setCurrentBlockState(STATE_NONE);
     }
     else
     {
         const auto newState = previous & ~flag;
-        DEBUG(true, "\t-") << "\t usuwamy ze stanu " << previous << " flage: " << flag << ", nowy stan: " << newState << ". linia:" << location.line();
         setCurrentBlockState(newState);
     }
 }
-void STCSyntaxHighlighter::currentBlockStateWithFlag(int flag, std::source_location location)
+void STCSyntaxHighlighter::currentBlockStateWithFlag(int flag)
 {
     const auto previous = previousBlockState();
     if (STATE_NONE == previous)
     {
-        DEBUG(true, "\t+")  << "\t dodaje stan flage: " << flag << ". linia:" << location.line();
         setCurrentBlockState(flag);
     }
     else
     {
         const auto newState = previous | flag;
-        DEBUG(true, "\t+") << "\t dodaje do stanu " << previous << " flage: " << flag << ", nowy stan: " << newState << ". linia:" << location.line();
         setCurrentBlockState(newState);
     }
 }
 
 bool STCSyntaxHighlighter::highlightCodeBlock(const QString& text)
 {
-    static const QMap<QString, QRegularExpression> closeReMap =
-        {
-            { "cpp",  stc::syntax::cppCloseRe },
-            { "py",   stc::syntax::pythonCloseRe },
-            { "code", stc::syntax::codeCloseRe }
-        };
-
+    TRACE_SCOPE("highlighter", "highlightCodeBlock");
     static QTextCharFormat tagFmt = [] {
         QTextCharFormat fmt;
         fmt.setForeground(Qt::gray);
@@ -580,12 +806,12 @@ bool STCSyntaxHighlighter::highlightCodeBlock(const QString& text)
     const int prev = previousBlockState();
     if (prev != STATE_NONE)
     {
-        struct CodeBlock { int stateFlag; QString styleKey; QRegularExpression closeRe; };
-        const QVector<CodeBlock> blocks =
+        struct CodeBlock { int stateFlag; QString styleKey; QStringView closingTagName; };
+        static const CodeBlock blocks[] =
             {
-                { STATE_CODE_CPP, "cpp",  stc::syntax::cppCloseRe },
-                { STATE_CODE,     "code", stc::syntax::codeCloseRe },
-                { STATE_CPP,      "py",   stc::syntax::pythonCloseRe }
+                { STATE_CODE_CPP, "cpp",  u"cpp" },
+                { STATE_CODE,     "code", u"code" },
+                { STATE_CPP,      "py",   u"py" }
             };
 
         for (const auto& blk : blocks)
@@ -593,29 +819,36 @@ bool STCSyntaxHighlighter::highlightCodeBlock(const QString& text)
             if (prev & blk.stateFlag)
             {
                 QTextCharFormat fmt = styledTagsMap.value(blk.styleKey).format;
-                QRegularExpressionMatch close = blk.closeRe.match(text);
-                if (close.hasMatch())
+                const stc::TagToken* close = findTag(_tagsThisLine, 0, [&](const stc::TagToken& tag) {
+                    return isPlainClosingTag(tag, text, blk.closingTagName);
+                });
+                if (close)
                 {
-                    const int closeStart = close.capturedStart();
+                    const int closeStart = close->start;
 
                     setFormat(0, closeStart, fmt);
                     if (blk.stateFlag == STATE_CODE_CPP)
                         applyCppHighlighting(text, 0, closeStart); // <— tylko fragment C++
 
-                    setFormat(closeStart, close.capturedLength(), tagFmt);
-                    _codeRangesThisLine.append({ closeStart, close.capturedLength() });
+                    setFormat(closeStart, close->length, tagFmt);
+                    _codeRangesThisLine.append({ closeStart, close->length });
                     currentBlockStateWithoutFlag(blk.stateFlag);
-                    offset = close.capturedEnd();
+                    if (blk.stateFlag == STATE_CODE_CPP)
+                        setCppCommentState(false); // a comment not closed before [/cpp] ends with the code
+                    offset = close->end();
                     found = true;
                     continue;
                 }
                 else
                 {
                     setFormat(0, text.length(), fmt);
+                    bool insideComment = false;
                     if (blk.stateFlag == STATE_CODE_CPP)
-                        applyCppHighlighting(text, 0, text.length()); // <— do końca linii
+                        insideComment = applyCppHighlighting(text, 0, text.length()); // <— do końca linii
 
                     currentBlockStateWithFlag(blk.stateFlag);
+                    if (blk.stateFlag == STATE_CODE_CPP)
+                        setCppCommentState(insideComment);
                     _codeRangesThisLine.append({ 0, text.length() });
                     return true;
                 }
@@ -625,52 +858,57 @@ bool STCSyntaxHighlighter::highlightCodeBlock(const QString& text)
 
     while (offset < text.length())
     {
-        QRegularExpressionMatch openMatch = stc::syntax::codeBlockOpenRe.match(text, offset);
-        if (!openMatch.hasMatch())
+        QStringView srcAttribute;
+        const stc::TagToken* openTag = findTag(_tagsThisLine, offset, [&](const stc::TagToken& tag) {
+            return isCodeOpeningTag(tag, text, srcAttribute);
+        });
+        if (!openTag)
             break;
 
-        const QString tag = openMatch.captured(1);
-        const QString src = openMatch.captured(2).toLower();
-        const int tagStart = openMatch.capturedStart();
-        const int tagEnd   = openMatch.capturedEnd();
+        const QStringView tag = openTag->name(text);
+        const QString src = srcAttribute.toString().toLower();
+        const int tagStart = openTag->start;
+        const int tagEnd   = openTag->end();
 
         QTextCharFormat fmt;
         QString styleKey;
         int stateFlag;
-        QRegularExpression closeRe;
+        QStringView closingTagName;
 
-        if (tag == "cpp" || src.contains("cpp") || src.contains("c++"))
+        if (tag == u"cpp" || src.contains("cpp") || src.contains("c++"))
         {
             styleKey = "cpp";
             fmt = styledTagsMap.value(styleKey).format;
             stateFlag = STATE_CODE_CPP;
-            closeRe = closeReMap["cpp"];
+            closingTagName = u"cpp";
         }
-        else if (tag == "py")
+        else if (tag == u"py")
         {
             styleKey = "py";
             fmt = styledTagsMap.value(styleKey).format;
             stateFlag = STATE_CPP;
-            closeRe = closeReMap["py"];
+            closingTagName = u"py";
         }
         else
         {
             styleKey = "code";
             fmt = styledTagsMap.value(styleKey).format;
             stateFlag = STATE_CODE;
-            closeRe = closeReMap["code"];
+            closingTagName = u"code";
         }
 
-        QRegularExpressionMatch closeMatch = closeRe.match(text, tagEnd);
-        if (closeMatch.hasMatch())
+        const stc::TagToken* closeTag = findTag(_tagsThisLine, tagEnd, [&](const stc::TagToken& tag) {
+            return isPlainClosingTag(tag, text, closingTagName);
+        });
+        if (closeTag)
         {
             // Kod inline
-            const int closeStart   = closeMatch.capturedStart();
+            const int closeStart   = closeTag->start;
             const int contentStart = tagEnd;
             const int contentLen   = closeStart - contentStart;
-            const int closeLen     = closeMatch.capturedLength();
+            const int closeLen     = closeTag->length;
 
-            offset = closeMatch.capturedEnd();
+            offset = closeTag->end();
 
             setFormat(tagStart, tagEnd - tagStart, tagFmt);
             setFormat(contentStart, contentLen, fmt);
@@ -689,11 +927,14 @@ bool STCSyntaxHighlighter::highlightCodeBlock(const QString& text)
             setFormat(tagStart, tagEnd - tagStart, tagFmt);
             setFormat(tagEnd, text.length() - tagEnd, fmt);
 
+            bool insideComment = false;
             if (stateFlag == STATE_CODE_CPP)
-                applyCppHighlighting(text, tagEnd, text.length()); // <— od tagu do końca linii
+                insideComment = applyCppHighlighting(text, tagEnd, text.length()); // <— od tagu do końca linii
 
             _codeRangesThisLine.append({ tagEnd, text.length() - tagEnd });
             currentBlockStateWithFlag(stateFlag);
+            if (stateFlag == STATE_CODE_CPP)
+                setCppCommentState(insideComment);
             return true;
         }
     }
@@ -701,144 +942,64 @@ bool STCSyntaxHighlighter::highlightCodeBlock(const QString& text)
     return found;
 }
 /// This function is adapted from https://github.com/ArsMasiuk/QCodeEditor, which was orginally made by https://github.com/Megaxela/QCodeEditor
-void STCSyntaxHighlighter::applyCppHighlighting(const QString &text, int from, int to)
+bool STCSyntaxHighlighter::applyCppHighlighting(const QString &text, int from, int to)
 {
+    const int prev = previousBlockState();
+    const bool startsInsideComment = from == 0 && prev != STATE_NONE && (prev & STATE_CODE_CPP) && (prev & STATE_CODE_CPP_COMMENT);
+
     from = std::max(from, 0);
     to = std::min<decltype(to)>(text.length(), to);
     if (from >= to)
-        return;
-
-    struct CppHighlightRule
-    {
-        QRegularExpression pattern;
-        QString formatName;
-    };
+        return startsInsideComment;
 
-    QSyntaxStyle *style = QSyntaxStyle::defaultStyle();
-
-    const int length = to - from;
-    const QString fragment = text.mid(from, length);
-
-    static QVector<CppHighlightRule> rules;
-    static QRegularExpression includePattern(R"(^\s*#\s*include\s*([<"][^:?"<>\|]+[">]))");
-    static QRegularExpression functionPattern(R"(\b([_a-zA-Z][_a-zA-Z0-9]*\s+)?((?:[_a-zA-Z][_a-zA-Z0-9]*\s*::\s*)*[_a-zA-Z][_a-zA-Z0-9]*)(?=\s*\())");
-    static QRegularExpression defTypePattern(R"(\b([_a-zA-Z][_a-zA-Z0-9]*)\s+[_a-zA-Z][_a-zA-Z0-9]*\s*[;=])");
-    static QRegularExpression commentStartPattern(R"(/\*)");
-    static QRegularExpression commentEndPattern(R"(\*/)");
-
-    if (rules.isEmpty())
-    {
+    static const cpp::KeywordTable keywords = [] {
         Q_INIT_RESOURCE(qcodeeditor_resources);
-        static QFile fl(":/languages/cpp.xml");
-        if (fl.open(QIODevice::ReadOnly))
-        {
-            static QLanguage language(&fl);
-            if (language.isLoaded())
-            {
-                for (auto&& key : language.keys())
-                {
-                    for (auto&& name : language.names(key))
-                    {
-                        rules.append({
-                            QRegularExpression(QString(R"(\b%1\b)").arg(name)),
-                            key
-                        });
-                    }
-                }
-            }
-        }
-        else
+        QFile fl(":/languages/cpp.xml");
+        if (!fl.open(QIODevice::ReadOnly))
         {
             throw std::runtime_error("Can not load :/cpp.xml");
         }
 
-        rules.append({ QRegularExpression(R"("[^\n"]*")"), "String" });
-        rules.append({ QRegularExpression(R"(#[a-zA-Z_]+)"), "Preprocessor" });
-        rules.append({ QRegularExpression(R"(//[^\n]*)"), "Comment" });
-    }
-
-    // include
-    {
-        auto it = includePattern.globalMatch(fragment);
-        while (it.hasNext())
+        QList<cpp::KeywordTable::Keyword> words;
+        QLanguage language(&fl);
+        if (language.isLoaded())
         {
-            auto m = it.next();
-            setFormat(from + m.capturedStart(), m.capturedLength(), style->getFormat("Preprocessor"));
-            setFormat(from + m.capturedStart(1), m.capturedLength(1), style->getFormat("String"));
+            for (auto&& key : language.keys())
+            {
+                for (auto&& name : language.names(key))
+                {
+                    words.append({ name, key });
+                }
+            }
         }
-    }
+        return cpp::KeywordTable(words);
+    }();
 
-    // funkcje
-    {
-        auto it = functionPattern.globalMatch(fragment);
-        while (it.hasNext())
-        {
-            auto m = it.next();
-            setFormat(from + m.capturedStart(), m.capturedLength(), style->getFormat("Type"));
-            setFormat(from + m.capturedStart(2), m.capturedLength(2), style->getFormat("Function"));
-        }
-    }
+    QSyntaxStyle *style = QSyntaxStyle::defaultStyle();
 
-    // definicje typów
-    {
-        auto it = defTypePattern.globalMatch(fragment);
-        while (it.hasNext())
-        {
-            auto m = it.next();
-            setFormat(from + m.capturedStart(1), m.capturedLength(1), style->getFormat("Type"));
-        }
-    }
+    _cppTokensThisFragment.clear();
+    const bool endsInsideComment = cpp::tokenize(QStringView(text).sliced(from, to - from), startsInsideComment, keywords, _cppTokensThisFragment);
 
-    // pozostałe reguły
-    for (auto& r : rules)
+    for (const cpp::Token& token : std::as_const(_cppTokensThisFragment))
     {
-        auto it = r.pattern.globalMatch(fragment);
-        while (it.hasNext())
-        {
-            auto m = it.next();
-            setFormat(from + m.capturedStart(), m.capturedLength(), style->getFormat(r.formatName));
-        }
+        setFormat(from + token.start, token.length, style->getFormat(token.formatName));
     }
 
-    // komentarze blokowe (/* ... */)
-    int startIndex = -1;
-    if (previousBlockState() != STATE_NONE && (previousBlockState() & STATE_CODE_CPP_COMMENT))
-    {
-        startIndex = 0;
-    }
-    else
-    {
-        auto m = commentStartPattern.match(fragment);
-        startIndex = m.hasMatch() ? m.capturedStart() : -1;
-    }
-
-    while (startIndex >= 0)
-    {
-        auto match = commentEndPattern.match(fragment, startIndex);
-        int endIndex = match.capturedStart();
-        int commentLength = 0;
-
-        if (endIndex == -1)
-        {
-            currentBlockStateWithFlag(STATE_CODE_CPP_COMMENT);
-            commentLength = fragment.length() - startIndex;
-        }
-        else
-        {
-            commentLength = endIndex - startIndex + match.capturedLength();
-        }
-
-        setFormat(from + startIndex,
-                  commentLength,
-                  style->getFormat("Comment"));
+    return endsInsideComment;
+}
 
-        auto nextStart = commentStartPattern.match(fragment, startIndex + commentLength);
-        startIndex = nextStart.hasMatch() ? nextStart.capturedStart() : -1;
-    }
+void STCSyntaxHighlighter::setCppCommentState(bool insideComment)
+{
+    const int state = currentBlockState();
+    if (insideComment)
+        setCurrentBlockState(state == STATE_NONE ? STATE_CODE_CPP_COMMENT : state | STATE_CODE_CPP_COMMENT);
+    else if (state != STATE_NONE && (state & STATE_CODE_CPP_COMMENT))
+        setCurrentBlockState(state & ~STATE_CODE_CPP_COMMENT);
 }
 
 bool STCSyntaxHighlighter::highlightTextStyleTags(const QString& text)
 {
+    TRACE_SCOPE("highlighter", "highlightTextStyleTags");
     const int prev = previousBlockState();
 
     static const QMap<QString, QTextCharFormat> tagFormats = [] {
@@ -861,14 +1022,6 @@ bool STCSyntaxHighlighter::highlightTextStyleTags(const QString& text)
          { "s", STATE_STYLE_STRIKE },
          };
 
-    static const QMap<QString, QRegularExpression> closeRes =
-        {
-         { "b", stc::syntax::boldCloseRe },
-         { "i", stc::syntax::italicCloseRe },
-         { "u", stc::syntax::underlineCloseRe },
-         { "s", stc::syntax::strikeOutCloseRe },
-         };
-
     static QTextCharFormat tagFmt = [] {
         QTextCharFormat fmt;
         fmt.setForeground(Qt::gray);
@@ -886,23 +1039,24 @@ bool STCSyntaxHighlighter::highlightTextStyleTags(const QString& text)
 
             if (prev & flag)
             {
-                const QRegularExpression& closeRe = closeRes[tag];
                 QTextCharFormat fmt = tagFormats[tag];
 
-                QRegularExpressionMatch closeMatch = closeRe.match(text);
-                if (closeMatch.hasMatch())
+                const stc::TagToken* closeTag = findTag(_tagsThisLine, 0, [&](const stc::TagToken& token) {
+                    return isPlainClosingTag(token, text, tag);
+                });
+                if (closeTag)
                 {
-                    int closeStart = closeMatch.capturedStart();
+                    int closeStart = closeTag->start;
 
                     // If style closing is inside code — skip the entire style
-                    if (overlapsWithCode(0, closeStart + closeMatch.capturedLength()))
+                    if (overlapsWithCode(0, closeTag->end()))
                         return false;
-                    if (overlapsWithNoFormat(0, closeStart + closeMatch.capturedLength()))
+                    if (overlapsWithNoFormat(0, closeTag->end()))
                         return false;
 
                     setFormat(0, closeStart, fmt);
                     applySpellcheckToTextRange(text, 0, closeStart, fmt);
-                    setFormat(closeStart, closeMatch.capturedLength(), tagFmt);
+                    setFormat(closeStart, closeTag->length, tagFmt);
                     currentBlockStateWithoutFlag(flag);
                 }
                 else
@@ -926,22 +1080,26 @@ bool STCSyntaxHighlighter::highlightTextStyleTags(const QString& text)
 
     while (offset < text.length())
     {
-        QRegularExpressionMatch match = stc::syntax::baseFormatting_boldItalicUnderlineStrikeRe.match(text, offset);
-        if (!match.hasMatch())
+        const stc::TagToken* openTag = findTag(_tagsThisLine, offset, [&text](const stc::TagToken& token) {
+            const QStringView name = token.name(text);
+            return !token.closing && 0 == token.attributesLength && name.size() == 1 && QStringView(u"bius").contains(name[0]);
+        });
+        if (!openTag)
             break;
 
-        const QString tag = match.captured(1);
+        const QString tag = openTag->name(text).toString();
         const QTextCharFormat fmt = tagFormats[tag];
         const int flag = tagStates[tag];
-        const QRegularExpression& closeRe = closeRes[tag];
 
-        const int tagStart = match.capturedStart();
-        const int tagEnd = match.capturedEnd();
+        const int tagStart = openTag->start;
+        const int tagEnd = openTag->end();
 
-        QRegularExpressionMatch closeMatch = closeRe.match(text, tagEnd);
-        if (closeMatch.hasMatch()) {
-            const int closeStart = closeMatch.capturedStart();
-            const int closeEnd = closeMatch.capturedEnd();
+        const stc::TagToken* closeTag = findTag(_tagsThisLine, tagEnd, [&](const stc::TagToken& token) {
+            return isPlainClosingTag(token, text, tag);
+        });
+        if (closeTag) {
+            const int closeStart = closeTag->start;
+            const int closeEnd = closeTag->end();
             const int contentStart = tagEnd;
             const int contentLen = closeStart - contentStart;
 
@@ -1010,93 +1168,90 @@ bool STCSyntaxHighlighter::overlapsWithRange(int start, int length, const QVecto
 
 bool STCSyntaxHighlighter::highlightTagsWithAttributes(const QString& text)
 {
+    TRACE_SCOPE("highlighter", "highlightTagsWithAttributes");
     bool found = false;
 
-    // Find all anchor tags
-    auto anchorIt = stc::syntax::anchorRe.globalMatch(text);
-    while (anchorIt.hasNext())
+    for (const stc::TagToken& tag : _tagsThisLine)
     {
-        auto match = anchorIt.next();
-        int start = match.capturedStart();
-        int end = match.capturedEnd();
-
-        if (overlapsWithNoFormat(start, end - start))
+        const QStringView attributes = tag.attributes(text);
+        if (tag.closing || attributes.isEmpty() || !attributes.front().isSpace())
             continue;
 
-        // Format the full tag
-        setFormat(start, end - start, styledTagsMap.value("tag.attr").format);
-
-        // Format href attribute value
-        int hrefStart = match.capturedStart(1);
-        int hrefLen = match.capturedLength(1);
-        setFormat(hrefStart, hrefLen, styledTagsMap.value("a.href").format);
+        const int start = tag.start;
+        const int end = tag.end();
 
-        // Format name attribute value, if present
-        if (match.lastCapturedIndex() >= 2 && match.captured(2).length() > 0)
+        // Anchor tags: [a href="..."] or [a href="..." name="..."]
+        if (tag.name(text) == u"a")
         {
-            int nameStart = match.capturedStart(2);
-            int nameLen = match.capturedLength(2);
-            setFormat(nameStart, nameLen, styledTagsMap.value("a.name").format);
-            applySpellcheckToTextRange(text, nameStart, nameLen, styledTagsMap.value("a.name").format);
-        }
-
-        found = true;
-    }
+            const auto href = stc::attributeValue(attributes, u"href");
+            if (!href || href->isEmpty())
+                continue;
 
-    // Find all image tags
-    auto imgIt = stc::syntax::imgRe.globalMatch(text);
-    while (imgIt.hasNext())
-    {
-        auto match = imgIt.next();
-        int start = match.capturedStart();
-        int end = match.capturedEnd();
+            if (overlapsWithNoFormat(start, end - start))
+                continue;
 
-        if (overlapsWithNoFormat(start, end - start))
-            continue;
+            // Format the full tag
+            setFormat(start, end - start, styledTagsMap.value("tag.attr").format);
 
-        // Format the entire [img ...] block
-        setFormat(start, end - start, styledTagsMap.value("tag.attr").format);
+            // Format href attribute value
+            setFormat(offsetIn(text, *href), href->size(), styledTagsMap.value("a.href").format);
 
-        QString matchedText = match.captured(0);
+            // Format name attribute value, if present
+            if (const auto name = stc::attributeValue(attributes, u"name"); name && !name->isEmpty())
+            {
+                int nameStart = offsetIn(text, *name);
+                int nameLen = name->size();
+                setFormat(nameStart, nameLen, styledTagsMap.value("a.name").format);
+                applySpellcheckToTextRange(text, nameStart, nameLen, styledTagsMap.value("a.name").format);
+            }
 
-        // Find and format src attribute
-        auto srcMatch = stc::syntax::imgAttributeSrcRe.match(matchedText);
-        if (srcMatch.hasMatch())
-        {
-            int srcStart = start + srcMatch.capturedStart(1);
-            int srcLen = srcMatch.capturedLength(1);
-            setFormat(srcStart, srcLen, styledTagsMap.value("img.src").format);
+            found = true;
         }
-
-        // Find and format alt attribute
-        auto altMatch = stc::syntax::imgAttributeSrcRe.match(matchedText);
-        if (altMatch.hasMatch())
+        // Image tags: [img ...] with attributes src, alt, opis and autofit in any order
+        else if (tag.name(text) == u"img")
         {
-            int altStart = start + altMatch.capturedStart(1);
-            int altLen = altMatch.capturedLength(1);
-            setFormat(altStart, altLen, styledTagsMap.value("img.alt").format);
-        }
+            const auto src = stc::attributeValue(attributes, u"src");
+            const auto alt = stc::attributeValue(attributes, u"alt");
+            const auto opis = stc::attributeValue(attributes, u"opis");
+            const qsizetype autofit = indexOfWord(attributes, u"autofit");
+            if (!src && !alt && !opis && autofit < 0)
+                continue;
 
-        // Find and format opis attribute
-        auto opisMatch = stc::syntax::imgAttributeDescRe.match(matchedText);
-        if (opisMatch.hasMatch())
-        {
-            int opisStart = start + opisMatch.capturedStart(1);
-            int opisLen = opisMatch.capturedLength(1);
-            setFormat(opisStart, opisLen, styledTagsMap.value("img.opis").format);
-            applySpellcheckToTextRange(text, opisStart, opisLen, styledTagsMap.value("img.opis").format);
-        }
+            if (overlapsWithNoFormat(start, end - start))
+                continue;
 
-        // Find and format 'autofit' keyword
-        auto autofitMatch = stc::syntax::imgAttributeAutofitRe.match(matchedText);
-        if (autofitMatch.hasMatch())
-        {
-            int autofitStart = start + autofitMatch.capturedStart();
-            int autofitLen = autofitMatch.capturedLength();
-            setFormat(autofitStart, autofitLen, styledTagsMap.value("img.autofit").format);
-        }
+            // Format the entire [img ...] block
+            setFormat(start, end - start, styledTagsMap.value("tag.attr").format);
 
-        found = true;
+            // Format src attribute
+            if (src && !src->isEmpty())
+            {
+                setFormat(offsetIn(text, *src), src->size(), styledTagsMap.value("img.src").format);
+            }
+
+            // Format alt attribute
+            if (alt)
+            {
+                setFormat(offsetIn(text, *alt), alt->size(), styledTagsMap.value("img.alt").format);
+            }
+
+            // Format opis attribute
+            if (opis)
+            {
+                int opisStart = offsetIn(text, *opis);
+                int opisLen = opis->size();
+                setFormat(opisStart, opisLen, styledTagsMap.value("img.opis").format);
+                applySpellcheckToTextRange(text, opisStart, opisLen, styledTagsMap.value("img.opis").format);
+            }
+
+            // Format 'autofit' keyword
+            if (autofit >= 0)
+            {
+                setFormat(tag.attributesStart + autofit, QStringView(u"autofit").size(), styledTagsMap.value("img.autofit").format);
+            }
+
+            found = true;
+        }
     }
 
     return found;
@@ -1104,16 +1259,14 @@ bool STCSyntaxHighlighter::highlightTagsWithAttributes(const QString& text)
 
 void STCSyntaxHighlighter::highlightPlainTextContent(const QString& text)
 {
+    TRACE_SCOPE("highlighter", "highlightPlainTextContent");
     const int length = text.length();
     QVector<QPair<int, int>> excludedRanges = _codeRangesThisLine + _noFormatRangesThisLine;
 
     // Exclude also tag-like segments: [tag] or [/tag]
-    static const QRegularExpression tagRe(R"(\[\/?\w+.*?\])");
-    QRegularExpressionMatchIterator tagIt = tagRe.globalMatch(text);
-    while (tagIt.hasNext())
+    for (const stc::TagToken& tag : _tagsThisLine)
     {
-        auto m = tagIt.next();
-        excludedRanges.append({ m.capturedStart(), m.capturedLength() });
+        excludedRanges.append({ tag.start, tag.length });
     }
 
     // Sort and merge excluded ranges to avoid overlap
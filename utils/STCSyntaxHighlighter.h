@@ -1,12 +1,19 @@
 #pragma once
 
-#include <source_location>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <QElapsedTimer>
 #include <QSyntaxHighlighter>
+#include <QTimer>
 #include <QTextCharFormat>
+#include <QTextBlock>
 #include <QVector>
 #include <QString>
 #include <QRegularExpression>
-#include "utils/SpellChecker.h"
+#include "utils/SpellCheckService.h"
+#include "utils/StcTagScanner.h"
+#include "utils/CppLexer.h"
 
 
 /// class inspired with: https://doc.qt.io/qt-6.2/qtwidgets-richtext-syntaxhighlighter-example.html
@@ -19,9 +26,26 @@ public:
 
     const SpellChecker& getSpellChecker() const
     {
-        return spellChecker;
+        return spellCheckService.getSpellChecker();
     }
 
+    SpellCheckService& getSpellCheckService()
+    {
+        return spellCheckService;
+    }
+
+    /**
+     * Blocks in the range are highlighted at once, the others later in time slices, starting from the top of the document.
+     * A postponed block keeps its previous state, so the blocks after it still get a state to start with,
+     * when it is highlighted and its state changes the following blocks are highlighted again, as usually in QSyntaxHighlighter.
+     * Until the first call all the blocks are highlighted at once.
+     */
+    void setVisibleBlocks(int firstBlockNumber, int lastBlockNumber);
+
+private slots:
+    void onWordsSpellchecked(const QStringList& words);
+    void highlightPendingBlocks();
+
 protected:
     void highlightBlock(const QString &text) override;
     bool highlightHeading(const QString &text);
@@ -32,7 +56,9 @@ protected:
     bool highlightTagsWithAttributes(const QString& text);
     void highlightPlainTextContent(const QString &text);
 
-    void applyCppHighlighting(const QString &text, int from, int to);
+    /// @return true if the fragment ends inside of /* comment */
+    bool applyCppHighlighting(const QString &text, int from, int to);
+    void setCppCommentState(bool insideComment);
 
     void addBlockStyle(const QString &tag,
                        QColor foreground = Qt::black,
@@ -41,8 +67,8 @@ protected:
                        QColor background = QColor(),
                        const QString &fontFamily = QString());
 
-    void currentBlockStateWithoutFlag(int flag, std::source_location location=std::source_location::current());
-    void currentBlockStateWithFlag(int flag, std::source_location location=std::source_location::current());
+    void currentBlockStateWithoutFlag(int flag);
+    void currentBlockStateWithFlag(int flag);
 
     bool overlapsWithCode(int start, int length) const
     {
@@ -60,6 +86,9 @@ protected:
 
     void applySpellcheckToTextRange(const QString &text, int start, int length, const QTextCharFormat &baseFormat);
 
+    bool shouldPostponeCurrentBlock() const;
+    void postponeCurrentBlock();
+
 private:
     struct Rule
     {
@@ -83,8 +112,17 @@ private:
 
     QMap<QString, StyledTag> styledTagsMap;
 
+    QList<stc::TagToken> _tagsThisLine;                // tokenized once per line, reused by all the stages
+    QList<cpp::Token> _cppTokensThisFragment;
     QVector<QPair<int, int>> _codeRangesThisLine;     // position start and length
     QVector<QPair<int, int>> _noFormatRangesThisLine; // position start and length
 
-    SpellChecker spellChecker;
+    SpellCheckService spellCheckService;
+    QHash<QString, QList<QTextBlock>> blocksWaitingForWord; // blocks to re-underline when the word is checked in background
+
+    std::optional<std::pair<int, int>> visibleBlocks; // first and last block number, highlighted at once
+    int firstPendingBlockNumber = std::numeric_limits<int>::max(); // no pending block before this one
+    bool highlightingInBackground = false;
+    QElapsedTimer backgroundSliceTimer;
+    QTimer pendingBlocksTimer;
 };
@@ -0,0 +1,336 @@
+#include <algorithm>
+#include <optional>
+#include "SequenceDiff.h"
+
+namespace
+{
+using SequenceDiff::Opcode;
+using SequenceDiff::Tag;
+using Ids = std::span<const std::uint64_t>;
+
+struct Region
+{
+    int oldBegin;
+    int oldEnd;
+    int newBegin;
+    int newEnd;
+};
+
+struct Match
+{
+    int oldBegin;
+    int newBegin;
+    int length;
+};
+
+class Differ
+{
+public:
+    Differ(Ids oldIds, Ids newIds) : oldIds(oldIds), newIds(newIds)
+    {
+        std::uint64_t maxId = 0;
+        for (const Ids ids : { oldIds, newIds })
+        {
+            if (!ids.empty())
+                maxId = std::max(maxId, *std::ranges::max_element(ids));
+        }
+        occurrences.assign(maxId + 1, 0);
+        newOccurrences.assign(maxId + 1, 0);
+        chainHead.assign(maxId + 1, -1);
+        chainNext.assign(oldIds.size(), -1);
+    }
+
+    /// Common runs of lines, sorted
+    std::vector<Match> findMatches()
+    {
+        std::vector<Region> regions{ { 0, static_cast<int>(oldIds.size()), 0, static_cast<int>(newIds.size()) } };
+        while (!regions.empty())
+        {
+            Region region = regions.back();
+            regions.pop_back();
+
+            skipCommonLines(region);
+            if (region.oldBegin == region.oldEnd || region.newBegin == region.newEnd)
+                continue;
+            if (diffByMyers(region))
+                continue;
+            if (splitByUniqueLines(region, regions))
+                continue;
+
+            const std::optional<Match> anchor = findAnchor(region);
+            if (!anchor)
+                continue; // replaced as a whole
+            matches.push_back(*anchor);
+            regions.push_back({ anchor->oldBegin + anchor->length, region.oldEnd, anchor->newBegin + anchor->length, region.newEnd });
+            regions.push_back({ region.oldBegin, anchor->oldBegin, region.newBegin, anchor->newBegin });
+        }
+
+        std::ranges::sort(matches, {}, &Match::oldBegin);
+        return std::move(matches);
+    }
+
+private:
+    void skipCommonLines(Region& region)
+    {
+        int common = 0;
+        while (region.oldBegin + common < region.oldEnd && region.newBegin + common < region.newEnd
+               && oldIds[region.oldBegin + common] == newIds[region.newBegin + common])
+        {
+            ++common;
+        }
+        if (common > 0)
+        {
+            matches.push_back({ region.oldBegin, region.newBegin, common });
+            region.oldBegin += common;
+            region.newBegin += common;
+        }
+
+        common = 0;
+        while (region.oldBegin < region.oldEnd - common && region.newBegin < region.newEnd - common
+               && oldIds[region.oldEnd - 1 - common] == newIds[region.newEnd - 1 - common])
+        {
+            ++common;
+        }
+        if (common > 0)
+        {
+            region.oldEnd -= common;
+            region.newEnd -= common;
+            matches.push_back({ region.oldEnd, region.newEnd, common });
+        }
+    }
+
+    /// Greedy Myers with the furthest reaching points of every step kept for backtracking, false when there are too many edits
+    bool diffByMyers(const Region& region)
+    {
+        const int n = region.oldEnd - region.oldBegin;
+        const int m = region.newEnd - region.newBegin;
+        const int maxEdits = std::min(SequenceDiff::maxEditsForMyers, n + m);
+        const int offset = maxEdits + 1;
+        const auto equal = [&](int x, int y) {
+            return oldIds[region.oldBegin + x] == newIds[region.newBegin + y];
+        };
+
+        furthest.assign(2 * maxEdits + 3, 0);
+        trace.clear(); // points of step d for diagonals -d, -d+2, ..., d start at d*(d+1)/2
+        for (int d = 0; d <= maxEdits; ++d)
+        {
+            for (int k = -d; k <= d; k += 2)
+            {
+                const bool down = k == -d || (k != d && furthest[offset + k - 1] < furthest[offset + k + 1]);
+                int x = down ? furthest[offset + k + 1] : furthest[offset + k - 1] + 1;
+                int y = x - k;
+                while (x < n && y < m && equal(x, y))
+                {
+                    ++x;
+                    ++y;
+                }
+                furthest[offset + k] = x;
+
+                if (x >= n && y >= m)
+                {
+                    backtrack(region, d, n, m);
+                    return true;
+                }
+            }
+            for (int k = -d; k <= d; k += 2)
+                trace.push_back(furthest[offset + k]);
+        }
+        return false;
+    }
+
+    void backtrack(const Region& region, int edits, int x, int y)
+    {
+        for (int d = edits; d > 0; --d)
+        {
+            const auto previous = [this, d](int k) { // furthest point of step d - 1
+                return trace[static_cast<std::size_t>((d - 1) * d / 2 + (k + d - 1) / 2)];
+            };
+            const int k = x - y;
+            const bool down = k == -d || (k != d && previous(k - 1) < previous(k + 1));
+            const int previousK = down ? k + 1 : k - 1;
+            const int previousX = previous(previousK);
+            const int snakeBegin = down ? previousX : previousX + 1;
+
+            if (x > snakeBegin)
+                matches.push_back({ region.oldBegin + snakeBegin, region.newBegin + snakeBegin - k, x - snakeBegin });
+            x = previousX;
+            y = previousX - previousK;
+        }
+        if (x > 0)
+            matches.push_back({ region.oldBegin, region.newBegin, x });
+    }
+
+    /// Patience diff: the longest sequence of lines occurring once in both regions, in the same order in both,
+    /// is kept and the regions between those lines are diffed separately. False when there are no such lines.
+    bool splitByUniqueLines(const Region& region, std::vector<Region>& regions)
+    {
+        for (int i = region.oldEnd - 1; i >= region.oldBegin; --i)
+        {
+            chainHead[oldIds[i]] = i;
+            ++occurrences[oldIds[i]];
+        }
+        for (int j = region.newBegin; j < region.newEnd; ++j)
+            ++newOccurrences[newIds[j]];
+
+        std::vector<Match> unique; // of length 1, ordered by the new position
+        for (int j = region.newBegin; j < region.newEnd; ++j)
+        {
+            const auto id = newIds[j];
+            if (occurrences[id] == 1 && newOccurrences[id] == 1)
+                unique.push_back({ chainHead[id], j, 1 });
+        }
+
+        for (int i = region.oldBegin; i < region.oldEnd; ++i)
+        {
+            occurrences[oldIds[i]] = 0;
+            chainHead[oldIds[i]] = -1;
+        }
+        for (int j = region.newBegin; j < region.newEnd; ++j)
+            newOccurrences[newIds[j]] = 0;
+
+        if (unique.empty())
+            return false;
+
+        // longest increasing subsequence of old positions by patience sorting
+        std::vector<int> pileTops; // index in `unique` of the top of each pile
+        std::vector<int> predecessor(unique.size(), -1);
+        for (int index = 0; index < static_cast<int>(unique.size()); ++index)
+        {
+            const auto pile = std::ranges::lower_bound(pileTops, unique[index].oldBegin, {}, [&unique](int top) {
+                return unique[top].oldBegin;
+            });
+            if (pile != pileTops.begin())
+                predecessor[index] = *std::prev(pile);
+            if (pile == pileTops.end())
+                pileTops.push_back(index);
+            else
+                *pile = index;
+        }
+
+        std::vector<Match> anchors;
+        for (int index = pileTops.back(); index != -1; index = predecessor[index])
+        {
+            const Match line = unique[index];
+            if (!anchors.empty() && anchors.back().oldBegin == line.oldBegin + 1 && anchors.back().newBegin == line.newBegin + 1)
+            {
+                --anchors.back().oldBegin; // joined with the next line into one run
+                --anchors.back().newBegin;
+                ++anchors.back().length;
+            }
+            else
+            {
+                anchors.push_back(line);
+            }
+        }
+        std::ranges::reverse(anchors);
+
+        Region gap{ region.oldBegin, region.oldEnd, region.newBegin, region.newEnd };
+        for (const Match& anchor : anchors)
+        {
+            regions.push_back({ gap.oldBegin, anchor.oldBegin, gap.newBegin, anchor.newBegin });
+            matches.push_back(anchor);
+            gap.oldBegin = anchor.oldBegin + anchor.length;
+            gap.newBegin = anchor.newBegin + anchor.length;
+        }
+        regions.push_back(gap);
+        return true;
+    }
+
+    /// Histogram diff: the longest common run around a line occurring the least times in the old region
+    std::optional<Match> findAnchor(const Region& region)
+    {
+        for (int i = region.oldEnd - 1; i >= region.oldBegin; --i)
+        {
+            const auto id = oldIds[i];
+            chainNext[i] = chainHead[id];
+            chainHead[id] = i;
+            ++occurrences[id];
+        }
+
+        std::optional<Match> best;
+        int bestOccurrences = SequenceDiff::maxOccurrencesForAnchor + 1;
+        for (int j = region.newBegin; j < region.newEnd;)
+        {
+            const auto id = newIds[j];
+            int nextJ = j + 1;
+            if (occurrences[id] > 0 && occurrences[id] <= bestOccurrences)
+            {
+                for (int i = chainHead[id]; i != -1; i = chainNext[i])
+                {
+                    int oldBegin = i, newBegin = j;
+                    while (oldBegin > region.oldBegin && newBegin > region.newBegin && oldIds[oldBegin - 1] == newIds[newBegin - 1])
+                    {
+                        --oldBegin;
+                        --newBegin;
+                    }
+                    int oldEnd = i + 1, newEnd = j + 1;
+                    while (oldEnd < region.oldEnd && newEnd < region.newEnd && oldIds[oldEnd] == newIds[newEnd])
+                    {
+                        ++oldEnd;
+                        ++newEnd;
+                    }
+
+                    if (occurrences[id] < bestOccurrences || oldEnd - oldBegin > best->length)
+                    {
+                        best = Match{ oldBegin, newBegin, oldEnd - oldBegin };
+                        bestOccurrences = occurrences[id];
+                    }
+                    nextJ = std::max(nextJ, newEnd); // lines of the run are not tried again
+                }
+            }
+            j = nextJ;
+        }
+
+        for (int i = region.oldBegin; i < region.oldEnd; ++i)
+        {
+            occurrences[oldIds[i]] = 0;
+            chainHead[oldIds[i]] = -1;
+        }
+        return best;
+    }
+
+    Ids oldIds;
+    Ids newIds;
+    std::vector<Match> matches;
+
+    std::vector<int> furthest; // x of the furthest reaching point of each diagonal
+    std::vector<int> trace;
+
+    std::vector<int> occurrences; // of lines in the old region, by id
+    std::vector<int> newOccurrences; // of lines in the new region, by id
+    std::vector<int> chainHead; // the first position of a line in the old region, by id
+    std::vector<int> chainNext; // the next position of the same line, by position
+};
+} // namespace
+
+std::vector<Opcode> SequenceDiff::computeOpcodes(Ids oldIds, Ids newIds)
+{
+    std::vector<Match> matches = Differ(oldIds, newIds).findMatches();
+    matches.push_back({ static_cast<int>(oldIds.size()), static_cast<int>(newIds.size()), 0 });
+
+    std::vector<Opcode> opcodes;
+    int oldPosition = 0, newPosition = 0;
+    for (std::size_t index = 0; index < matches.size(); ++index)
+    {
+        Match match = matches[index];
+        while (index + 1 < matches.size() && matches[index + 1].length > 0
+               && matches[index + 1].oldBegin == match.oldBegin + match.length
+               && matches[index + 1].newBegin == match.newBegin + match.length)
+        {
+            match.length += matches[++index].length; // adjacent runs are one equal opcode, as in difflib
+        }
+
+        if (oldPosition < match.oldBegin && newPosition < match.newBegin)
+            opcodes.push_back({ Tag::Replace, oldPosition, match.oldBegin, newPosition, match.newBegin });
+        else if (oldPosition < match.oldBegin)
+            opcodes.push_back({ Tag::Delete, oldPosition, match.oldBegin, newPosition, match.newBegin });
+        else if (newPosition < match.newBegin)
+            opcodes.push_back({ Tag::Insert, oldPosition, match.oldBegin, newPosition, match.newBegin });
+
+        oldPosition = match.oldBegin + match.length;
+        newPosition = match.newBegin + match.length;
+        if (match.length > 0)
+            opcodes.push_back({ Tag::Equal, match.oldBegin, oldPosition, match.newBegin, newPosition });
+    }
+    return opcodes;
+}
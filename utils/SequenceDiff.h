@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/**
+ * @brief Diff of two sequences of interned lines: equal lines have equal ids, ids are smaller than the count of lines
+ * of both sequences (eg. numbers given to distinct lines in order of appearance), so they index arrays.
+ *
+ * Common beginning and ending are skipped first. A region is diffed by Myers' O(ND) algorithm when it differs
+ * by at most `maxEditsForMyers` lines, which gives the shortest edit script. Otherwise it is split by patience diff:
+ * lines occurring once in both regions, in the same order in both, are kept and the regions between them are diffed
+ * the same way. A region without such lines is split by the histogram step: the longest common run around the line
+ * occurring the least times in the old region. Regions without any common line occurring at most
+ * `maxOccurrencesForAnchor` times are replaced as a whole.
+ *
+ * Opcodes are in the form of Python's difflib (which the editor used before), but not always the same: they are equal
+ * for edits of lines which are distinct in both sequences. When several alignments are equally long (repeated lines,
+ * eg. blank ones) or a block of lines was moved, another alignment may be chosen; for at most `maxEditsForMyers`
+ * edits it is never longer than difflib's. Since common beginning and ending are always kept, diffing only the region
+ * between them gives the same opcodes as diffing whole sequences (`IncrementalLineDiff` relies on that).
+ */
+namespace SequenceDiff
+{
+enum class Tag
+{
+    Equal,
+    Replace,
+    Delete,
+    Insert
+};
+
+/// The same as opcodes of Python's difflib: lines [oldBegin, oldEnd) turn into [newBegin, newEnd)
+struct Opcode
+{
+    Tag tag;
+    int oldBegin;
+    int oldEnd;
+    int newBegin;
+    int newEnd;
+
+    bool operator==(const Opcode&) const = default;
+};
+
+inline constexpr int maxEditsForMyers = 128;
+inline constexpr int maxOccurrencesForAnchor = 64;
+
+std::vector<Opcode> computeOpcodes(std::span<const std::uint64_t> oldIds, std::span<const std::uint64_t> newIds);
+} // namespace SequenceDiff
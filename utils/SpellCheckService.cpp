@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <utility>
+#include <QThread>
+#include <QTimer>
+#include "SpellCheckService.h"
+#include "Tracing.h"
+
+
+namespace
+{
+constexpr qsizetype wordsPerBatch = 256;
+constexpr qsizetype verdictsCacheSize = 65536; // words, far more than distinct words of a typical document
+constexpr qsizetype suggestionsCacheSize = 512; // words
+
+constexpr int menuRequestPriority = 1;
+constexpr int prefetchPriority = 0;
+} // namespace
+
+
+SpellCheckService::SpellCheckService(QObject* parent)
+    : QObject(parent), verdicts(verdictsCacheSize), suggestionsCache(suggestionsCacheSize)
+{
+    // nuspell::Dictionary::spell() and suggest() are const and can be called from many threads at once
+    workers.setMaxThreadCount(std::max(1, QThread::idealThreadCount() - 1)); // one core is left for the GUI
+    suggestionWorkers.setMaxThreadCount(2); // a prefetch being computed does not delay the request of an opened menu
+}
+
+SpellCheckService::~SpellCheckService()
+{
+    for (const auto& request : std::as_const(pendingSuggestions))
+        request->state.store(RequestState::Cancelled);
+
+    workers.clear();
+    suggestionWorkers.clear();
+    workers.waitForDone(); // workers use spellChecker, which is destroyed together with the service
+    suggestionWorkers.waitForDone();
+}
+
+SpellCheckService::Verdict SpellCheckService::verdict(const QString& word)
+{
+    {
+        QMutexLocker locker(&verdictsMutex);
+        if (const Verdict* known = verdicts.object(word))
+            return *known;
+        verdicts.insert(word, new Verdict(Verdict::Unknown));
+    }
+
+    if (queuedWords.isEmpty())
+    {
+        QTimer::singleShot(0, this, &SpellCheckService::checkQueuedWords);
+    }
+    queuedWords.append(word);
+
+    return Verdict::Unknown;
+}
+
+bool SpellCheckService::isCorrect(const QString& word)
+{
+    {
+        QMutexLocker locker(&verdictsMutex);
+        if (const Verdict* known = verdicts.object(word); known && *known != Verdict::Unknown)
+            return *known == Verdict::Correct;
+    }
+
+    const bool correct = spellChecker.isCorrect(word);
+    storeVerdicts({ word }, { correct });
+    return correct;
+}
+
+void SpellCheckService::checkQueuedWords()
+{
+    const QStringList words = std::exchange(queuedWords, {});
+
+    for (qsizetype from = 0; from < words.size(); from += wordsPerBatch)
+    {
+        workers.start([this, batch = words.mid(from, wordsPerBatch)] {
+            TRACE_SCOPE("spellcheck", "SpellCheckService: check batch of words");
+            QList<bool> correctness;
+            correctness.reserve(batch.size());
+            for (const QString& word : batch)
+            {
+                correctness.append(spellChecker.isCorrect(word));
+            }
+
+            storeVerdicts(batch, correctness);
+
+            QMetaObject::invokeMethod(this, [this, batch] {
+                emit wordsChecked(batch);
+            }, Qt::QueuedConnection);
+        });
+    }
+}
+
+void SpellCheckService::storeVerdicts(const QStringList& words, const QList<bool>& correctness)
+{
+    QMutexLocker locker(&verdictsMutex);
+    for (qsizetype i = 0; i < words.size(); ++i)
+    {
+        verdicts.insert(words[i], new Verdict(correctness[i] ? Verdict::Correct : Verdict::Misspelled));
+    }
+}
+
+std::optional<QStringList> SpellCheckService::cachedSuggestions(const QString& word) const
+{
+    if (const QStringList* suggestions = suggestionsCache.object(word))
+        return *suggestions;
+    return std::nullopt;
+}
+
+void SpellCheckService::requestSuggestions(const QString& word)
+{
+    startSuggestions(word, menuRequestPriority);
+}
+
+void SpellCheckService::prefetchSuggestions(const QString& word)
+{
+    startSuggestions(word, prefetchPriority);
+}
+
+void SpellCheckService::cancelSuggestions(const QString& word)
+{
+    if (auto request = pendingSuggestions.take(word))
+        request->state.store(RequestState::Cancelled);
+}
+
+void SpellCheckService::startSuggestions(const QString& word, int priority)
+{
+    if (suggestionsCache.contains(word))
+        return;
+
+    if (const auto pending = pendingSuggestions.value(word))
+    {
+        // a queued request with lower priority (a prefetch) would wait behind the other prefetches, so it is replaced
+        auto queued = RequestState::Queued;
+        if (pending->priority >= priority || !pending->state.compare_exchange_strong(queued, RequestState::Cancelled))
+            return;
+    }
+
+    auto request = std::make_shared<SuggestionsRequest>();
+    request->priority = priority;
+    pendingSuggestions.insert(word, request);
+
+    suggestionWorkers.start([this, word, request] {
+        TRACE_SCOPE("spellcheck", "SpellCheckService: suggestions");
+        auto queued = RequestState::Queued;
+        if (!request->state.compare_exchange_strong(queued, RequestState::Started))
+            return; // cancelled
+
+        QStringList suggestions = spellChecker.getSuggestions(word);
+
+        QMetaObject::invokeMethod(this, [this, word, request, suggestions = std::move(suggestions)] {
+            if (auto it = pendingSuggestions.find(word); it != pendingSuggestions.end() && it.value() == request)
+                pendingSuggestions.erase(it);
+
+            suggestionsCache.insert(word, new QStringList(suggestions)); // computed anyway, even if cancelled meanwhile
+            emit suggestionsReady(word, suggestions);
+        }, Qt::QueuedConnection);
+    }, priority);
+}
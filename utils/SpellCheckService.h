@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <QObject>
+#include <QCache>
+#include <QHash>
+#include <QMutex>
+#include <QStringList>
+#include <QThreadPool>
+#include "utils/SpellChecker.h"
+
+/**
+ * @brief Checks spelling of words in worker threads, so Nuspell never blocks the GUI thread while highlighting.
+ *
+ * Verdicts of the recently used words are cached in an LRU cache. A word which was not seen before is reported as `Verdict::Unknown`
+ * and queued, all the words queued during one event loop iteration are checked by the worker pool in batches.
+ * When a batch is done `wordsChecked` is emitted in the thread of the service, then the users can re-underline them.
+ *
+ * Suggestions are even slower (hundreds of milliseconds for long Polish words), so they are computed in separate workers
+ * and the recently used ones are kept in an LRU cache. Requests which have not started yet can be cancelled,
+ * a queued prefetch of the word the user asks about is queued again with the higher priority.
+ */
+class SpellCheckService : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Verdict : std::uint8_t
+    {
+        Unknown,
+        Correct,
+        Misspelled
+    };
+
+    explicit SpellCheckService(QObject* parent = nullptr);
+    ~SpellCheckService();
+
+    const SpellChecker& getSpellChecker() const
+    {
+        return spellChecker;
+    }
+
+    /// Cached verdict, a word which was not checked yet is queued for checking in background.
+    Verdict verdict(const QString& word);
+
+    /// Synchronous check (eg. for a single word under the mouse cursor), the result is cached too.
+    bool isCorrect(const QString& word);
+
+    std::optional<QStringList> cachedSuggestions(const QString& word) const;
+
+    /// Computes suggestions in background unless they are cached or already being computed, `suggestionsReady` is emitted when done.
+    void requestSuggestions(const QString& word);
+
+    /// The same as `requestSuggestions`, but with lower priority, for misspelled words the user may ask about soon.
+    void prefetchSuggestions(const QString& word);
+
+    /// Drops the request if the worker has not started it yet.
+    void cancelSuggestions(const QString& word);
+
+signals:
+    void wordsChecked(const QStringList& words);
+    void suggestionsReady(const QString& word, const QStringList& suggestions);
+
+private slots:
+    void checkQueuedWords();
+
+private:
+    enum class RequestState : std::uint8_t
+    {
+        Queued,
+        Started,
+        Cancelled
+    };
+
+    struct SuggestionsRequest
+    {
+        std::atomic<RequestState> state = RequestState::Queued;
+        int priority;
+    };
+
+    void storeVerdicts(const QStringList& words, const QList<bool>& correctness);
+    void startSuggestions(const QString& word, int priority);
+
+    SpellChecker spellChecker;
+
+    QMutex verdictsMutex; // QCache reorders its entries on every lookup, so even reading needs exclusive access
+    QCache<QString, Verdict> verdicts; // LRU, Unknown means queued or being checked
+
+    QStringList queuedWords;
+    QThreadPool workers;
+
+    mutable QCache<QString, QStringList> suggestionsCache; // LRU, accessed only from the thread of the service
+    QHash<QString, std::shared_ptr<SuggestionsRequest>> pendingSuggestions;
+    QThreadPool suggestionWorkers;
+};
@@ -0,0 +1,69 @@
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <sstream>
+#include "StartupReport.h"
+
+namespace
+{
+/// Value of a line like "VmRSS:	   85244 kB", in bytes
+std::optional<std::uint64_t> kilobytesField(std::string_view status, std::string_view name)
+{
+    for (std::size_t lineStart = 0; lineStart < status.size();)
+    {
+        const auto lineEnd = std::min(status.find('\n', lineStart), status.size());
+        const auto line = status.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+
+        if (!line.starts_with(name) || line.size() <= name.size() || line[name.size()] != ':')
+            continue;
+
+        const auto digits = line.find_first_of("0123456789", name.size());
+        if (digits == std::string_view::npos)
+            return std::nullopt;
+
+        std::uint64_t kilobytes = 0;
+        for (auto i = digits; i < line.size() && line[i] >= '0' && line[i] <= '9'; ++i)
+            kilobytes = kilobytes * 10 + static_cast<std::uint64_t>(line[i] - '0');
+        return kilobytes * 1024;
+    }
+    return std::nullopt;
+}
+} // namespace
+
+bool StartupReport::isEnabled()
+{
+    const char* value = std::getenv("STC_STARTUP_REPORT");
+    return value && *value && std::string_view(value) != "0";
+}
+
+std::optional<StartupReport::Memory> StartupReport::parseProcStatus(std::string_view status)
+{
+    const auto resident = kilobytesField(status, "VmRSS");
+    const auto peak = kilobytesField(status, "VmHWM");
+    if (!resident || !peak)
+        return std::nullopt;
+    return Memory{ .residentBytes = *resident, .peakResidentBytes = *peak };
+}
+
+std::optional<StartupReport::Memory> StartupReport::processMemory()
+{
+#ifdef __linux__
+    std::ifstream file("/proc/self/status");
+    std::ostringstream status;
+    status << file.rdbuf();
+    return parseProcStatus(status.str());
+#else
+    return std::nullopt;
+#endif
+}
+
+std::string StartupReport::describeMemory()
+{
+    const auto memory = processMemory();
+    if (!memory)
+        return "RSS unknown";
+
+    constexpr double megabyte = 1024.0 * 1024.0;
+    return std::format("RSS {:.1f} MB (peak {:.1f} MB)", memory->residentBytes / megabyte, memory->peakResidentBytes / megabyte);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Measurements of the start of the application, printed when the `STC_STARTUP_REPORT` environment variable is set:
+ * time from the start of `main()` to the first paint of the window and the resident memory of the process then
+ * and when the preview is created (it starts QWebEngine, so it is created on first use).
+ */
+namespace StartupReport
+{
+bool isEnabled();
+
+struct Memory
+{
+    std::uint64_t residentBytes = 0;
+    std::uint64_t peakResidentBytes = 0;
+};
+
+/// From `VmRSS` and `VmHWM` of /proc/<pid>/status, nullopt if they are missing
+std::optional<Memory> parseProcStatus(std::string_view status);
+
+/// Memory of this process, nullopt where it is not known (systems other than Linux)
+std::optional<Memory> processMemory();
+
+/// eg. "RSS 85.2 MB (peak 90.1 MB)"
+std::string describeMemory();
+} // namespace StartupReport
@@ -0,0 +1,259 @@
+#include <algorithm>
+#include <QTextDocument>
+#include <QTextBlock>
+#include "StcDocumentModel.h"
+#include "HandlerTimings.h"
+
+
+namespace
+{
+/// the same as `\w` of QRegularExpression without Unicode properties
+bool isWordCharacter(QChar c)
+{
+    const char16_t u = c.unicode();
+    return (u >= u'a' && u <= u'z') || (u >= u'A' && u <= u'Z') || (u >= u'0' && u <= u'9') || u == u'_';
+}
+
+/// Hand written version of `\bTODO\b[:]? *(.*)` (case insensitive), returns start of the "TODO" and of its text
+std::optional<std::pair<int, int>> findTodo(QStringView text)
+{
+    constexpr QStringView todo = u"todo";
+
+    for (qsizetype from = 0; ; )
+    {
+        const qsizetype start = text.indexOf(todo, from, Qt::CaseInsensitive);
+        if (start < 0)
+        {
+            return std::nullopt;
+        }
+        from = start + 1;
+
+        qsizetype end = start + todo.size();
+        if ((start > 0 && isWordCharacter(text[start - 1])) || (end < text.size() && isWordCharacter(text[end])))
+        {
+            continue;
+        }
+
+        if (end < text.size() && text[end] == u':')
+            ++end;
+        while (end < text.size() && text[end] == u' ')
+            ++end;
+        return std::make_pair(static_cast<int>(start), static_cast<int>(end));
+    }
+}
+
+/// Pairs [hN]...[/hN] inside of a single line, the same way as non greedy regular expression would do
+template<typename Callback>
+void forEachHeaderInLine(QStringView text, const QList<stc::TagToken>& tags, Callback callback)
+{
+    for (qsizetype i = 0; i < tags.size(); ++i)
+    {
+        const stc::TagToken& opening = tags[i];
+        if (opening.closing || 0 == stc::headerLevel(opening.name(text)))
+        {
+            continue;
+        }
+
+        for (qsizetype j = i + 1; j < tags.size(); ++j)
+        {
+            const stc::TagToken& closing = tags[j];
+            if (closing.closing && closing.isNamed(text, opening.name(text)))
+            {
+                callback(opening, closing);
+                i = j;
+                break;
+            }
+        }
+    }
+}
+} // namespace
+
+
+StcDocumentModel::StcDocumentModel(QTextDocument* document, QObject* parent)
+    : QObject(parent), document(document)
+{
+    reparseAll();
+
+    connect(document, &QTextDocument::contentsChange, this, &StcDocumentModel::onContentsChange);
+}
+
+StcDocumentModel::BlockInfo StcDocumentModel::analyzeBlock(QStringView text)
+{
+    BlockInfo info;
+
+    stc::TagScanner scanner(text);
+    while (auto tag = scanner.next())
+    {
+        info.hasCodeTag |= stc::isCodeTag(tag->name(text));
+        info.tags.append(*tag);
+    }
+
+    forEachHeaderInLine(text, info.tags, [&info](const stc::TagToken&, const stc::TagToken&) {
+        info.hasHeader = true;
+    });
+
+    if (auto todo = findTodo(text))
+    {
+        info.todoStart = todo->first;
+        info.todoTextStart = todo->second;
+    }
+
+    return info;
+}
+
+void StcDocumentModel::reparseAll()
+{
+    blocks.clear();
+    blocks.reserve(document->blockCount());
+    for (QTextBlock block = document->begin(); block.isValid(); block = block.next())
+    {
+        blocks.append(analyzeBlock(block.text()));
+    }
+    codeTagsTouched = true;
+}
+
+void StcDocumentModel::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    HANDLER_TIMING("StcDocumentModel::onContentsChange");
+    QTextBlock firstBlock = document->findBlock(position);
+    QTextBlock lastBlock = document->findBlock(position + charsAdded);
+    if (!lastBlock.isValid()) // Qt reports change ranges including the final paragraph separator
+        lastBlock = document->lastBlock();
+
+    const int blocksDifference = document->blockCount() - static_cast<int>(blocks.size());
+    const int firstIndex = firstBlock.blockNumber();
+    const int lastNewIndex = lastBlock.blockNumber();
+    const int lastOldIndex = lastNewIndex - blocksDifference;
+
+    if (!firstBlock.isValid() || lastOldIndex < firstIndex - 1 || lastOldIndex >= blocks.size())
+    {
+        reparseAll();
+    }
+    else
+    {
+        codeTagsTouched = false;
+        for (int i = firstIndex; i <= lastOldIndex; ++i)
+        {
+            codeTagsTouched |= blocks[i].hasCodeTag;
+        }
+
+        QList<BlockInfo> changedBlocks;
+        changedBlocks.reserve(lastNewIndex - firstIndex + 1);
+        for (QTextBlock block = firstBlock; block.isValid() && block.blockNumber() <= lastNewIndex; block = block.next())
+        {
+            changedBlocks.append(analyzeBlock(block.text()));
+            codeTagsTouched |= changedBlocks.back().hasCodeTag;
+        }
+
+        blocks.remove(firstIndex, lastOldIndex - firstIndex + 1);
+        blocks.insert(firstIndex, changedBlocks.size(), BlockInfo{});
+        std::move(changedBlocks.begin(), changedBlocks.end(), blocks.begin() + firstIndex);
+    }
+
+    emit contentsChange(position, charsRemoved, charsAdded);
+}
+
+const QList<stc::TagToken>& StcDocumentModel::tagsInBlock(int blockNumber) const
+{
+    static const QList<stc::TagToken> noTags;
+    if (blockNumber < 0 || blockNumber >= blocks.size())
+        return noTags;
+    return blocks[blockNumber].tags;
+}
+
+void StcDocumentModel::forEachTag(const TagVisitor& visitor, int fromPosition, int toPosition) const
+{
+    forEachTagWhile([&visitor](QStringView blockText, int blockPosition, const stc::TagToken& tag) {
+        visitor(blockText, blockPosition, tag);
+        return true;
+    }, fromPosition, toPosition);
+}
+
+void StcDocumentModel::forEachTagWhile(const StoppableTagVisitor& visitor, int fromPosition, int toPosition) const
+{
+    QTextBlock block = document->findBlock(fromPosition);
+    for (int blockNumber = block.blockNumber(); block.isValid() && block.position() < toPosition; block = block.next(), ++blockNumber)
+    {
+        const auto& tags = tagsInBlock(blockNumber);
+        if (tags.isEmpty())
+        {
+            continue;
+        }
+
+        const QString text = block.text();
+        const int blockPosition = block.position();
+        for (const stc::TagToken& tag : tags)
+        {
+            const int tagPosition = blockPosition + tag.start;
+            if (tagPosition < fromPosition)
+                continue;
+            if (tagPosition >= toPosition || !visitor(text, blockPosition, tag))
+                return;
+        }
+    }
+}
+
+QList<StcDocumentModel::Header> StcDocumentModel::headersInBlock(const QTextBlock& block) const
+{
+    const int blockNumber = block.blockNumber();
+    if (blockNumber < 0 || blockNumber >= blocks.size() || !blocks[blockNumber].hasHeader)
+    {
+        return {};
+    }
+
+    QList<Header> result;
+    const QString text = block.text();
+    const int blockPosition = block.position();
+    forEachHeaderInLine(text, blocks[blockNumber].tags, [&](const stc::TagToken& opening, const stc::TagToken& closing) {
+        result.append(Header{
+            .tagName = opening.name(text).toString(),
+            .textInside = text.mid(opening.end(), closing.start - opening.end()),
+            .startPos = blockPosition + opening.start,
+            .endPos = blockPosition + closing.end()
+        });
+    });
+    return result;
+}
+
+QList<StcDocumentModel::Header> StcDocumentModel::headers() const
+{
+    QList<Header> result;
+    int blockNumber = 0;
+    for (QTextBlock block = document->begin(); block.isValid(); block = block.next(), ++blockNumber)
+    {
+        if (blockNumber < blocks.size() && blocks[blockNumber].hasHeader)
+        {
+            result.append(headersInBlock(block));
+        }
+    }
+    return result;
+}
+
+std::optional<StcDocumentModel::Todo> StcDocumentModel::todoInBlock(const QTextBlock& block) const
+{
+    const int blockNumber = block.blockNumber();
+    if (blockNumber < 0 || blockNumber >= blocks.size() || blocks[blockNumber].todoStart < 0)
+    {
+        return std::nullopt;
+    }
+
+    const BlockInfo& info = blocks[blockNumber];
+    return Todo{
+        .position = block.position() + info.todoStart,
+        .text = block.text().mid(info.todoTextStart).trimmed()
+    };
+}
+
+QList<StcDocumentModel::Todo> StcDocumentModel::todos() const
+{
+    QList<Todo> result;
+    int blockNumber = 0;
+    for (QTextBlock block = document->begin(); block.isValid(); block = block.next(), ++blockNumber)
+    {
+        if (blockNumber < blocks.size() && blocks[blockNumber].todoStart >= 0)
+        {
+            result.append(*todoInBlock(block));
+        }
+    }
+    return result;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <functional>
+#include <limits>
+#include <optional>
+#include <QObject>
+#include <QList>
+#include "utils/StcTagScanner.h"
+
+class QTextDocument;
+class QTextBlock;
+
+/**
+ * @brief STC tags of the document split by lines, shared by all the side panels.
+ *
+ * Every line is tokenized once with `stc::TagScanner`, after a change only the touched blocks are tokenized again.
+ * Panels should connect to `StcDocumentModel::contentsChange` instead of `QTextDocument::contentsChange`,
+ * then the model is already up to date when they query it.
+ *
+ * Tags are kept with positions relative to their blocks, so a change does not shift anything outside of the touched lines.
+ */
+class StcDocumentModel : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Header
+    {
+        QString tagName;
+        QString textInside;
+        int startPos;
+        int endPos;
+    };
+
+    struct Todo
+    {
+        int position;
+        QString text;
+    };
+
+    using TagVisitor = std::function<void(QStringView blockText, int blockPosition, const stc::TagToken& tag)>;
+    using StoppableTagVisitor = std::function<bool(QStringView blockText, int blockPosition, const stc::TagToken& tag)>;
+
+    explicit StcDocumentModel(QTextDocument* document, QObject* parent = nullptr);
+
+    /// Tokenizes the whole document again, should not be needed unless the document was replaced.
+    void reparseAll();
+
+    const QList<stc::TagToken>& tagsInBlock(int blockNumber) const;
+
+    /// Calls visitor for each tag starting in [fromPosition, toPosition), text of lines without any tag is not even read.
+    void forEachTag(const TagVisitor& visitor, int fromPosition = 0, int toPosition = std::numeric_limits<int>::max()) const;
+
+    /// The same as forEachTag, but the visitor returns false when no more tags are needed.
+    void forEachTagWhile(const StoppableTagVisitor& visitor, int fromPosition = 0, int toPosition = std::numeric_limits<int>::max()) const;
+
+    QList<Header> headersInBlock(const QTextBlock& block) const;
+    QList<Header> headers() const;
+
+    std::optional<Todo> todoInBlock(const QTextBlock& block) const;
+    QList<Todo> todos() const;
+
+    /// true if the last change added or removed any [cpp], [code], [py] or [log] tag
+    bool lastChangeTouchedCodeTags() const
+    {
+        return codeTagsTouched;
+    }
+
+signals:
+    /// Emitted with the arguments of `QTextDocument::contentsChange` after the model was updated.
+    void contentsChange(int position, int charsRemoved, int charsAdded);
+
+private slots:
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+
+private:
+    struct BlockInfo
+    {
+        QList<stc::TagToken> tags;
+        int todoStart = -1;
+        int todoTextStart = -1;
+        bool hasHeader = false;
+        bool hasCodeTag = false;
+    };
+
+    static BlockInfo analyzeBlock(QStringView text);
+
+    QTextDocument* document;
+    QList<BlockInfo> blocks; // one per QTextBlock
+    bool codeTagsTouched = false;
+};
@@ -0,0 +1,754 @@
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <vector>
+#include "StcHtmlRenderer.h"
+#include "checkers/TagsStatistics.h"
+
+using TagsStatistics::attributeValue;
+
+namespace
+{
+constexpr std::string_view lineBreak = "<br/>\n";
+
+/// the same as [[:alpha:]] of std::regex in "C" locale
+bool isAlpha(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+bool isAlnum(char c)
+{
+    return isAlpha(c) || (c >= '0' && c <= '9');
+}
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+char toLower(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool equalsIgnoringCase(std::string_view a, std::string_view b)
+{
+    return std::ranges::equal(a, b, {}, toLower, toLower);
+}
+
+std::string_view trimmed(std::string_view text)
+{
+    while (!text.empty() && isSpace(text.front()))
+        text.remove_prefix(1);
+    while (!text.empty() && isSpace(text.back()))
+        text.remove_suffix(1);
+    return text;
+}
+
+bool isCodeTag(std::string_view tagName)
+{
+    for (std::string_view codeTag : { "cpp", "code", "py", "log" })
+    {
+        if (equalsIgnoringCase(tagName, codeTag))
+            return true;
+    }
+    return false;
+}
+
+/// Scripts in links of a previewed document are never run
+bool isSafeUrl(std::string_view url)
+{
+    url = trimmed(url);
+    for (std::string_view scheme : { "javascript:", "vbscript:" })
+    {
+        if (equalsIgnoringCase(url.substr(0, scheme.size()), scheme))
+            return false;
+    }
+    return true;
+}
+
+struct Tag
+{
+    std::string_view name;
+    std::string_view full; // from '[' to ']'
+    bool closing = false;
+};
+
+/// `[name attributes]` or `[/name]` starting at `position`, like PairedTagsChecker::extractTags finds them in a line
+std::optional<Tag> tagAt(std::string_view text, std::size_t position)
+{
+    auto nameStart = position + 1;
+    const bool closing = nameStart < text.size() && text[nameStart] == '/';
+    if (closing)
+        ++nameStart;
+    if (nameStart >= text.size() || !isAlpha(text[nameStart]))
+        return std::nullopt;
+
+    auto nameEnd = nameStart + 1;
+    while (nameEnd < text.size() && isAlnum(text[nameEnd]))
+        ++nameEnd;
+
+    const auto end = text.find_first_of("]\n", nameEnd);
+    if (end == std::string_view::npos || text[end] != ']')
+        return std::nullopt;
+    if (end != nameEnd && (closing || (!isSpace(text[nameEnd]) && text[nameEnd] != '=')))
+        return std::nullopt;
+
+    return Tag{ .name = text.substr(nameStart, nameEnd - nameStart),
+                .full = text.substr(position, end + 1 - position),
+                .closing = closing };
+}
+
+/// Position of the next '[' or '\n', npos if there is none; faster than find_first_of for two characters
+std::size_t findTagOrNewLine(std::string_view text, std::size_t from)
+{
+    for (auto i = from; i < text.size(); ++i)
+    {
+        if (text[i] == '[' || text[i] == '\n')
+            return i;
+    }
+    return std::string_view::npos;
+}
+
+/// Position of `[/name]` (in any case) from `from`, npos if there is none
+std::size_t findClosingTag(std::string_view text, std::size_t from, std::string_view name)
+{
+    for (auto start = text.find("[/", from); start != std::string_view::npos; start = text.find("[/", start + 2))
+    {
+        const auto nameEnd = start + 2 + name.size();
+        if (nameEnd < text.size() && text[nameEnd] == ']' && equalsIgnoringCase(text.substr(start + 2, name.size()), name))
+            return start;
+    }
+    return std::string_view::npos;
+}
+
+/// Attribute without value, eg. `autofit` of `[img src="a.png" autofit]`
+bool hasFlag(std::string_view tagFull, std::string_view flag)
+{
+    bool quoted = false;
+    for (std::size_t start = 1; start + flag.size() < tagFull.size(); ++start)
+    {
+        if (tagFull[start] == '"')
+            quoted = !quoted;
+        if (quoted || !isSpace(tagFull[start - 1]) || !equalsIgnoringCase(tagFull.substr(start, flag.size()), flag))
+            continue;
+
+        const char after = tagFull[start + flag.size()];
+        if (isSpace(after) || after == ']')
+            return true;
+    }
+    return false;
+}
+
+/// Parts of the text of `[pkt]` or `[csv]` between separators, which are not inside `[run]`
+std::vector<std::string_view> splitOutsideRuns(std::string_view text, char separator)
+{
+    std::vector<std::string_view> parts;
+    std::size_t partStart = 0;
+    bool insideRun = false;
+    for (std::size_t i = 0; i < text.size(); ++i)
+    {
+        if (text.substr(i).starts_with("[run]"))
+            insideRun = true;
+        else if (text.substr(i).starts_with("[/run]"))
+            insideRun = false;
+        else if (!insideRun && text[i] == separator)
+        {
+            parts.push_back(text.substr(partStart, i - partStart));
+            partStart = i + 1;
+        }
+    }
+    parts.push_back(text.substr(partStart));
+    return parts;
+}
+
+struct Element
+{
+    std::string_view stcName;
+    std::string_view opening;
+    std::string_view closing;
+    bool block;
+};
+
+constexpr Element elements[] = {
+    { "b", "<b>", "</b>", false },
+    { "i", "<i>", "</i>", false },
+    { "u", "<u>", "</u>", false },
+    { "s", "<s>", "</s>", false },
+    { "sub", "<sub>", "</sub>", false },
+    { "sup", "<sup>", "</sup>", false },
+    { "tt", "<tt>", "</tt>", false },
+    { "run", "", "", false },
+    { "h1", "<h1>", "</h1>", true },
+    { "h2", "<h2>", "</h2>", true },
+    { "h3", "<h3>", "</h3>", true },
+    { "h4", "<h4>", "</h4>", true },
+    { "cytat", "<blockquote class=\"cytat\">", "</blockquote>", true },
+    { "div", "<div class=\"div\">", "</div>", true },
+};
+
+const Element* findElement(std::string_view stcName)
+{
+    const auto element = std::ranges::find_if(elements, [stcName](const Element& e) {
+        return equalsIgnoringCase(e.stcName, stcName);
+    });
+    return element != std::end(elements) ? element : nullptr;
+}
+
+/// Line at `position` starts with a tag rendered as a block, so the new line before it is never shown
+bool startsBlock(std::string_view text, std::size_t position)
+{
+    if (position >= text.size() || text[position] != '[')
+        return false;
+
+    const auto tag = tagAt(text, position);
+    if (!tag || tag->closing)
+        return false;
+
+    const auto name = tag->name;
+    if (equalsIgnoringCase(name, "img"))
+        return !attributeValue(tag->full, "src").value_or("").empty();
+
+    const Element* element = findElement(name);
+    return (element && element->block) || isCodeTag(name) || equalsIgnoringCase(name, "pkt") || equalsIgnoringCase(name, "csv");
+}
+
+class Renderer
+{
+public:
+    explicit Renderer(std::string& out) : out(out)
+    {
+    }
+
+    /// STC with all tags, the tags opened in the text are closed at its end
+    void renderFlow(std::string_view text);
+
+private:
+    struct OpenedTag
+    {
+        std::string_view name;
+        std::string_view closing;
+        bool block;
+    };
+
+    void renderCode(const Tag& tag, std::string_view code);
+    void renderList(std::string_view content);
+    void renderTable(const Tag& tag, std::string_view content);
+    bool renderLink(const Tag& tag);
+    bool renderImage(const Tag& tag);
+    void renderTextWithRuns(std::string_view text);
+    void openElement(const Element& element, const Tag& tag);
+
+    void appendEscaped(std::string_view text)
+    {
+        for (char c : text)
+        {
+            switch (c)
+            {
+            case '&': out += "&amp;"; break;
+            case '<': out += "&lt;"; break;
+            case '>': out += "&gt;"; break;
+            case '"': out += "&quot;"; break;
+            default: out += c;
+            }
+        }
+    }
+
+    /// new line just before a block is not shown as an empty line
+    void beforeBlock()
+    {
+        if (out.ends_with(lineBreak))
+            out.resize(out.size() - lineBreak.size());
+    }
+
+    std::string& out;
+};
+
+void Renderer::renderFlow(std::string_view text)
+{
+    std::vector<OpenedTag> opened;
+    std::size_t i = 0;
+    const auto skipNewLineAfterBlock = [&text, &i] {
+        if (i < text.size() && text[i] == '\n')
+            ++i;
+    };
+
+    while (i < text.size())
+    {
+        const auto special = findTagOrNewLine(text, i);
+        appendEscaped(text.substr(i, special - i));
+        if (special == std::string_view::npos)
+            break;
+
+        i = special + 1;
+        if (text[special] == '\n')
+        {
+            out += lineBreak;
+            continue;
+        }
+
+        const auto tag = tagAt(text, special);
+        if (!tag)
+        {
+            out += '[';
+            continue;
+        }
+        const auto afterTag = special + tag->full.size();
+
+        if (tag->closing)
+        {
+            const auto matching = std::find_if(opened.rbegin(), opened.rend(), [&tag](const OpenedTag& openedTag) {
+                return equalsIgnoringCase(openedTag.name, tag->name);
+            });
+            if (matching == opened.rend()) // closing tag without opening one is shown as text
+            {
+                out += '[';
+                continue;
+            }
+
+            const bool block = matching->block;
+            if (block)
+                beforeBlock();
+            for (auto toClose = matching - opened.rbegin() + 1; toClose > 0; --toClose) // tags opened inside are closed too
+            {
+                out += opened.back().closing;
+                opened.pop_back();
+            }
+            i = afterTag;
+            if (block)
+                skipNewLineAfterBlock();
+            continue;
+        }
+
+        const auto name = tag->name;
+        if (isCodeTag(name) || equalsIgnoringCase(name, "pkt") || equalsIgnoringCase(name, "csv"))
+        {
+            const auto closingTag = findClosingTag(text, afterTag, name);
+            const auto content = text.substr(afterTag, closingTag - afterTag);
+            if (isCodeTag(name))
+                renderCode(*tag, content);
+            else if (equalsIgnoringCase(name, "pkt"))
+                renderList(content);
+            else
+                renderTable(*tag, content);
+
+            i = closingTag == std::string_view::npos ? text.size() : closingTag + name.size() + 3;
+            skipNewLineAfterBlock();
+        }
+        else if (equalsIgnoringCase(name, "a"))
+        {
+            if (renderLink(*tag))
+                i = afterTag;
+            else
+                out += '[';
+        }
+        else if (equalsIgnoringCase(name, "img"))
+        {
+            if (renderImage(*tag))
+            {
+                i = afterTag;
+                skipNewLineAfterBlock();
+            }
+            else
+            {
+                out += '[';
+            }
+        }
+        else if (const Element* element = findElement(name))
+        {
+            openElement(*element, *tag);
+            opened.push_back({ .name = name, .closing = element->closing, .block = element->block });
+            i = afterTag;
+            if (element->block)
+                skipNewLineAfterBlock();
+        }
+        else
+        {
+            out += '[';
+        }
+    }
+
+    while (!opened.empty())
+    {
+        out += opened.back().closing;
+        opened.pop_back();
+    }
+}
+
+void Renderer::openElement(const Element& element, const Tag& tag)
+{
+    if (element.block)
+        beforeBlock();
+
+    if (equalsIgnoringCase(element.stcName, "div"))
+    {
+        const auto divClass = attributeValue(tag.full, "class").value_or("");
+        if (equalsIgnoringCase(divClass, "tip"))
+        {
+            out += "<div class=\"div tip\">";
+            return;
+        }
+        if (equalsIgnoringCase(divClass, "uwaga"))
+        {
+            out += "<div class=\"div uwaga\">";
+            return;
+        }
+    }
+    out += element.opening;
+}
+
+void Renderer::renderCode(const Tag& tag, std::string_view code)
+{
+    if (code.starts_with('\n'))
+        code.remove_prefix(1);
+    if (code.ends_with('\n'))
+        code.remove_suffix(1);
+
+    beforeBlock();
+    if (const auto src = attributeValue(tag.full, "src"); src && !src->empty())
+    {
+        out += "<div class=\"src\">";
+        appendEscaped(*src);
+        out += "</div>";
+    }
+
+    out += "<pre class=\"";
+    std::ranges::transform(tag.name, std::back_inserter(out), toLower);
+    out += "\">";
+    appendEscaped(code);
+    out += "</pre>";
+}
+
+void Renderer::renderList(std::string_view content)
+{
+    beforeBlock();
+    out += "<ul class=\"pkt\">";
+    for (const auto line : splitOutsideRuns(content, '\n'))
+    {
+        const auto item = trimmed(line);
+        if (item.empty())
+            continue;
+
+        out += "<li>";
+        renderTextWithRuns(item);
+        out += "</li>";
+    }
+    out += "</ul>";
+}
+
+void Renderer::renderTable(const Tag& tag, std::string_view content)
+{
+    bool headerRow = hasFlag(tag.full, "header");
+
+    beforeBlock();
+    out += "<table class=\"csv\">";
+    for (const auto line : splitOutsideRuns(content, '\n'))
+    {
+        const auto row = trimmed(line);
+        if (row.empty())
+            continue;
+
+        const std::string_view cellTag = headerRow ? "th" : "td";
+        out += "<tr>";
+        for (const auto cell : splitOutsideRuns(row, ';'))
+        {
+            out += '<';
+            out += cellTag;
+            out += '>';
+            renderTextWithRuns(trimmed(cell));
+            out += "</";
+            out += cellTag;
+            out += '>';
+        }
+        out += "</tr>";
+        headerRow = false;
+    }
+    out += "</table>";
+}
+
+bool Renderer::renderLink(const Tag& tag)
+{
+    const auto href = attributeValue(tag.full, "href");
+    if (!href || href->empty())
+        return false;
+
+    const auto name = attributeValue(tag.full, "name");
+    out += "<a href=\"";
+    appendEscaped(isSafeUrl(*href) ? *href : "#");
+    out += "\">";
+    appendEscaped(name && !name->empty() ? *name : *href);
+    out += "</a>";
+    return true;
+}
+
+bool Renderer::renderImage(const Tag& tag)
+{
+    const auto src = attributeValue(tag.full, "src");
+    if (!src || src->empty())
+        return false;
+
+    beforeBlock();
+    out += hasFlag(tag.full, "autofit") ? "<figure class=\"img autofit\">" : "<figure class=\"img\">";
+    out += "<img src=\"";
+    appendEscaped(isSafeUrl(*src) ? *src : "");
+    out += "\" alt=\"";
+    appendEscaped(attributeValue(tag.full, "alt").value_or(""));
+    out += "\"/>";
+    if (const auto description = attributeValue(tag.full, "opis"); description && !description->empty())
+    {
+        out += "<figcaption>";
+        appendEscaped(*description);
+        out += "</figcaption>";
+    }
+    out += "</figure>";
+    return true;
+}
+
+void Renderer::renderTextWithRuns(std::string_view text)
+{
+    std::size_t i = 0;
+    while (i < text.size())
+    {
+        const auto runStart = text.find("[run]", i);
+        appendEscaped(text.substr(i, runStart - i));
+        if (runStart == std::string_view::npos)
+            break;
+
+        const auto contentStart = runStart + std::string_view("[run]").size();
+        const auto runEnd = findClosingTag(text, contentStart, "run");
+        renderFlow(text.substr(contentStart, runEnd - contentStart));
+        i = runEnd == std::string_view::npos ? text.size() : runEnd + std::string_view("[/run]").size();
+    }
+}
+} // namespace
+
+std::string StcHtmlRenderer::toHtml(std::string_view stcText)
+{
+    std::string html;
+    html.reserve(stcText.size() + stcText.size() / 4);
+    Renderer(html).renderFlow(stcText);
+    return html;
+}
+
+namespace
+{
+/// Splits the text starting at `from` (a beginning of a section) and passes `[begin, end)` of each section
+/// to `consume`, which returns false to stop. Nothing is opened at the beginning of a section,
+/// so splitting from any of them gives the same sections as splitting from the beginning of the text.
+template <typename SectionConsumer>
+void splitSections(std::string_view text, std::size_t from, SectionConsumer consume)
+{
+    std::vector<std::string_view> opened; // the same tags which Renderer::renderFlow would keep opened
+    std::size_t sectionStart = from;
+    std::size_t i = from;
+
+    while (i < text.size())
+    {
+        const auto special = findTagOrNewLine(text, i);
+        if (special == std::string_view::npos)
+            break;
+
+        i = special + 1;
+        if (text[special] == '\n')
+        {
+            if (!opened.empty())
+                continue;
+
+            if (startsBlock(text, special + 1)) // the new line is not a part of any section
+            {
+                if (!consume(sectionStart, special))
+                    return;
+                sectionStart = special + 1;
+            }
+            else if (special > sectionStart && text[special - 1] == '\n'
+                     && special + 1 < text.size() && text[special + 1] != '\n' && text[special + 1] != '[')
+            {
+                if (!consume(sectionStart, special + 1))
+                    return;
+                sectionStart = special + 1;
+            }
+            continue;
+        }
+
+        const auto tag = tagAt(text, special);
+        if (!tag)
+            continue;
+        const auto afterTag = special + tag->full.size();
+        const auto name = tag->name;
+
+        if (tag->closing)
+        {
+            const auto matching = std::find_if(opened.rbegin(), opened.rend(), [name](std::string_view openedName) {
+                return equalsIgnoringCase(openedName, name);
+            });
+            if (matching != opened.rend())
+            {
+                opened.erase(std::prev(matching.base()), opened.end());
+                i = afterTag;
+            }
+        }
+        else if (isCodeTag(name) || equalsIgnoringCase(name, "pkt") || equalsIgnoringCase(name, "csv"))
+        {
+            const auto closingTag = findClosingTag(text, afterTag, name);
+            i = closingTag == std::string_view::npos ? text.size() : closingTag + name.size() + 3;
+        }
+        else if (findElement(name))
+        {
+            opened.push_back(name);
+            i = afterTag;
+        }
+    }
+
+    consume(sectionStart, text.size());
+}
+
+/// Length of the common beginning of both texts, compared by blocks first
+std::size_t commonPrefixLength(std::string_view a, std::string_view b)
+{
+    constexpr std::size_t blockSize = 4096;
+    const std::size_t length = std::min(a.size(), b.size());
+    std::size_t common = 0;
+    while (common + blockSize <= length && std::memcmp(a.data() + common, b.data() + common, blockSize) == 0)
+        common += blockSize;
+    while (common < length && a[common] == b[common])
+        ++common;
+    return common;
+}
+
+/// Length of the common ending of both texts, not longer than `limit`
+std::size_t commonSuffixLength(std::string_view a, std::string_view b, std::size_t limit)
+{
+    constexpr std::size_t blockSize = 4096;
+    std::size_t common = 0;
+    while (common + blockSize <= limit
+           && std::memcmp(a.data() + a.size() - common - blockSize, b.data() + b.size() - common - blockSize, blockSize) == 0)
+    {
+        common += blockSize;
+    }
+    while (common < limit && a[a.size() - 1 - common] == b[b.size() - 1 - common])
+        ++common;
+    return common;
+}
+} // namespace
+
+std::vector<std::string_view> StcHtmlRenderer::splitIntoSections(std::string_view text)
+{
+    std::vector<std::string_view> sections;
+    splitSections(text, 0, [&sections, text](std::size_t begin, std::size_t end) {
+        sections.push_back(text.substr(begin, end - begin));
+        return true;
+    });
+    return sections;
+}
+
+using StcHtmlRenderer::IncrementalRenderer;
+
+IncrementalRenderer::Patch IncrementalRenderer::update(std::string_view stcText)
+{
+    // only the text around the edit is split again: from the section before the changed bytes
+    // (a change can move the boundary ending it) until a boundary which was also a boundary before, after the change
+    const std::size_t changeBegin = commonPrefixLength(text, stcText);
+    if (changeBegin == text.size() && changeBegin == stcText.size() && !sections.empty())
+        return {};
+    const std::size_t unchangedEnding = commonSuffixLength(text, stcText, std::min(text.size(), stcText.size()) - changeBegin);
+    const std::size_t newChangeEnd = stcText.size() - unchangedEnding;
+    const auto shift = static_cast<std::ptrdiff_t>(stcText.size()) - static_cast<std::ptrdiff_t>(text.size());
+
+    std::size_t firstResplit = 0;
+    if (!sections.empty())
+    {
+        const auto containingChange = std::ranges::lower_bound(sections, changeBegin, {}, &Section::end);
+        const auto index = static_cast<std::size_t>(containingChange - sections.begin());
+        firstResplit = std::min(index, sections.size() - 1);
+        firstResplit = firstResplit > 0 ? firstResplit - 1 : 0;
+    }
+    const std::size_t resplitFrom = sections.empty() ? 0 : sections[firstResplit].begin;
+
+    std::size_t firstReused = sections.size();
+    std::vector<Section> resplit;
+    splitSections(stcText, resplitFrom, [&](std::size_t begin, std::size_t end) {
+        if (begin > newChangeEnd + 1) // decisions about this boundary did not look at the changed text
+        {
+            const auto oldBegin = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(begin) - shift);
+            const auto reused = std::ranges::lower_bound(sections.begin() + static_cast<std::ptrdiff_t>(firstResplit), sections.end(),
+                                                         oldBegin, {}, &Section::begin);
+            if (reused != sections.end() && reused->begin == oldBegin)
+            {
+                firstReused = static_cast<std::size_t>(reused - sections.begin());
+                return false;
+            }
+        }
+        const auto sectionText = stcText.substr(begin, end - begin);
+        resplit.push_back({ .begin = begin, .end = end, .hash = std::hash<std::string_view>{}(sectionText), .id = 0, .html = {} });
+        return true;
+    });
+
+    for (auto reused = sections.begin() + static_cast<std::ptrdiff_t>(firstReused); reused != sections.end(); ++reused)
+    {
+        reused->begin = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(reused->begin) + shift);
+        reused->end = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(reused->end) + shift);
+    }
+
+    // sections split again can still be the same as before, eg. the one before the change
+    // (positions of the sections which are not reused are still the ones in the previous text)
+    const auto sameSource = [&](const Section& previous, const Section& current) {
+        return previous.hash == current.hash
+            && std::string_view(text).substr(previous.begin, previous.end - previous.begin)
+                   == stcText.substr(current.begin, current.end - current.begin);
+    };
+    std::size_t keptAtBeginning = 0;
+    while (firstResplit + keptAtBeginning < firstReused && keptAtBeginning < resplit.size()
+           && sameSource(sections[firstResplit + keptAtBeginning], resplit[keptAtBeginning]))
+    {
+        sections[firstResplit + keptAtBeginning].end = resplit[keptAtBeginning].end;
+        ++keptAtBeginning;
+    }
+    std::size_t keptAtEnd = 0;
+    while (firstResplit + keptAtBeginning + keptAtEnd < firstReused && keptAtBeginning + keptAtEnd < resplit.size()
+           && sameSource(sections[firstReused - 1 - keptAtEnd], resplit[resplit.size() - 1 - keptAtEnd]))
+    {
+        sections[firstReused - 1 - keptAtEnd].begin = resplit[resplit.size() - 1 - keptAtEnd].begin;
+        sections[firstReused - 1 - keptAtEnd].end = resplit[resplit.size() - 1 - keptAtEnd].end;
+        ++keptAtEnd;
+    }
+    const std::size_t replacedBegin = firstResplit + keptAtBeginning;
+    const std::size_t replacedEnd = firstReused - keptAtEnd;
+
+    Patch patch;
+    patch.insertAfterId = replacedBegin > 0 ? sections[replacedBegin - 1].id : 0;
+    for (std::size_t removed = replacedBegin; removed < replacedEnd; ++removed)
+        patch.removedIds.push_back(sections[removed].id);
+
+    std::vector<Section> rendered;
+    for (std::size_t changed = keptAtBeginning; changed < resplit.size() - keptAtEnd; ++changed)
+    {
+        Section section = std::move(resplit[changed]);
+        section.id = ++lastId;
+        section.html = toHtml(stcText.substr(section.begin, section.end - section.begin));
+        patch.inserted.emplace_back(section.id, section.html);
+        rendered.push_back(std::move(section));
+    }
+
+    const auto erased = sections.erase(sections.begin() + static_cast<std::ptrdiff_t>(replacedBegin),
+                                       sections.begin() + static_cast<std::ptrdiff_t>(replacedEnd));
+    sections.insert(erased, std::make_move_iterator(rendered.begin()), std::make_move_iterator(rendered.end()));
+    text.assign(stcText);
+    return patch;
+}
+
+void IncrementalRenderer::reset()
+{
+    sections.clear();
+    text.clear();
+}
+
+std::string IncrementalRenderer::html() const
+{
+    std::string html;
+    for (const Section& section : sections)
+        html += section.html;
+    return html;
+}
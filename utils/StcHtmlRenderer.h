@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Renders STC (the markup of cpp0x.pl) into HTML for the preview, without asking the server.
+ *
+ * Tags are translated into elements with classes named after the STC tags and their attributes
+ * (eg. `[div class="tip"]` into `<div class="div tip">`), the stylesheet of the preview is written for them.
+ * Unknown or broken tags are shown as text, unclosed tags are closed at the end of the enclosing block.
+ * Text of code tags and of `[pkt]`/`[csv]` outside `[run]` is not interpreted.
+ * The text is UTF-8, it is not validated.
+ */
+namespace StcHtmlRenderer
+{
+/// HTML fragment to be put into the container of the preview.
+std::string toHtml(std::string_view stcText);
+
+/// Splits the text between top-level blocks and before paragraphs following an empty line, outside of any tag.
+/// HTML of the sections rendered separately and joined is the same as of the whole text, if its tags are closed.
+std::vector<std::string_view> splitIntoSections(std::string_view stcText);
+
+/**
+ * @brief Keeps the preview as a sequence of sections, each in its own element, and renders again only the changed ones.
+ *
+ * Only the text around the edit is split again (from the section before it to the first unchanged boundary after it),
+ * the sections found there are compared by hashes of their text with the previous ones and the changed ones are replaced,
+ * so an edit costs rendering of the sections it touched plus comparing the texts.
+ * Ids of kept sections never change, the new ones get ids which were not used before.
+ */
+class IncrementalRenderer
+{
+public:
+    struct Patch
+    {
+        std::vector<std::uint64_t> removedIds;
+        std::uint64_t insertAfterId = 0; // 0 when the sections are inserted at the beginning
+        std::vector<std::pair<std::uint64_t, std::string>> inserted; // ids and HTML of the new sections, in order
+
+        bool isEmpty() const
+        {
+            return removedIds.empty() && inserted.empty();
+        }
+    };
+
+    Patch update(std::string_view stcText);
+
+    /// To be called when the container was emptied, eg. the page was loaded again
+    void reset();
+
+    /// HTML of all sections, in order
+    std::string html() const;
+
+    std::size_t sectionsCount() const
+    {
+        return sections.size();
+    }
+
+private:
+    struct Section
+    {
+        std::size_t begin; // position in `text`
+        std::size_t end;
+        std::size_t hash;
+        std::uint64_t id = 0;
+        std::string html;
+    };
+
+    std::string text; // the last rendered
+    std::vector<Section> sections;
+    std::uint64_t lastId = 0;
+};
+} // namespace StcHtmlRenderer
@@ -0,0 +1,116 @@
+#include <QJsonDocument>
+#include <QJsonValue>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QUrlQuery>
+#include "StcRemoteRenderer.h"
+#include "PreviewTransport.h"
+
+
+StcRemoteRenderer::StcRemoteRenderer(QNetworkAccessManager& network, QObject* parent)
+    : QObject(parent), network(network)
+{
+}
+
+void StcRemoteRenderer::render(const QString& text)
+{
+    send({ .text = text.toStdString(),
+           .asDelta = serverAcceptsDeltas && !acknowledgedText.empty(),
+           .compressed = serverAcceptsDeflate,
+           .start = Tracing::Clock::now(),
+           .generation = generation });
+}
+
+void StcRemoteRenderer::reset()
+{
+    acknowledgedText.clear();
+    ++generation;
+}
+
+void StcRemoteRenderer::send(SentText sent)
+{
+    QUrlQuery postData;
+    if (sent.asDelta)
+    {
+        const PreviewTransport::TextDelta delta = PreviewTransport::makeDelta(acknowledgedText, sent.text);
+        postData.addQueryItem("stcBase", QString::fromStdString(PreviewTransport::textFingerprint(acknowledgedText)));
+        postData.addQueryItem("stcFrom", QString::number(delta.position));
+        postData.addQueryItem("stcRemoved", QString::number(delta.removedLength));
+        postData.addQueryItem("stcInserted", QString::fromStdString(delta.inserted));
+        stats.deltaRequestCount++;
+    }
+    else
+    {
+        postData.addQueryItem("stc", QString::fromStdString(sent.text));
+    }
+    postData.addQueryItem("ajax", "ddt");
+    postData.addQueryItem("SecurityToken", securityToken);
+
+    QNetworkRequest req(endpoint);
+    req.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
+    QByteArray payload = postData.toString(QUrl::FullyEncoded).toUtf8();
+    stats.bytesBeforeCompression += payload.size();
+
+    if (sent.compressed)
+    {
+        payload = qCompress(payload).mid(4); // without the length prepended by Qt it is the zlib stream of HTTP "deflate"
+        req.setRawHeader("Content-Encoding", "deflate");
+    }
+
+    stats.bytesSent += payload.size();
+    stats.requestCount++;
+
+    QNetworkReply *reply = network.post(req, payload);
+    connect(reply, &QNetworkReply::finished, this, [this, reply, sent = std::move(sent)]() {
+        TRACE_ASYNC("network", "preview request", sent.start);
+        onReplyFinished(reply, sent);
+    });
+}
+
+void StcRemoteRenderer::onReplyFinished(QNetworkReply* reply, const SentText& sent)
+{
+    TRACE_SCOPE("network", "StcRemoteRenderer: preview reply");
+    const QByteArray response = reply->readAll();
+    stats.bytesReceived += response.size();
+
+    reply->deleteLater();
+
+    if (sent.generation != generation)
+    {
+        return;
+    }
+
+    const QVariant statusAttribute = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute);
+    if (statusAttribute.isValid()) // the server tells in every reply what it accepts, the features are used from the next request
+    {
+        serverAcceptsDeflate = reply->rawHeader("Accept-Encoding").contains("deflate");
+        serverAcceptsDeltas = reply->rawHeader("X-Stc-Delta").trimmed() == "1";
+    }
+
+    const int status = statusAttribute.toInt();
+    const bool baseOfDeltaUnknown = status == 409 && sent.asDelta;
+    const bool compressionRejected = status == 415 && sent.compressed;
+    if (baseOfDeltaUnknown || compressionRejected) // the same text is sent again, whole and not compressed
+    {
+        serverAcceptsDeflate = serverAcceptsDeflate && !compressionRejected;
+        acknowledgedText.clear();
+        send({ .text = sent.text, .asDelta = false, .compressed = false, .start = sent.start, .generation = generation });
+        return;
+    }
+
+    if (reply->error() != QNetworkReply::NoError || status < 200 || status >= 300)
+    {
+        emit failed(statusAttribute.isValid() ? QString("HTTP status %1").arg(status) : reply->errorString());
+        return;
+    }
+
+    const QJsonValue html = QJsonDocument::fromJson(response)["html"];
+    if (!html.isString() || (html.toString().isEmpty() && !sent.text.empty()))
+    {
+        emit failed("The reply has no HTML");
+        return;
+    }
+
+    acknowledgedText = sent.text;
+    emit rendered(html.toString(), std::chrono::duration_cast<std::chrono::microseconds>(Tracing::Clock::now() - sent.start));
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <QObject>
+#include <QUrl>
+#include "Tracing.h"
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+/**
+ * @brief Sends STC text to the rendering of cpp0x.pl (or of its stand-in) and gives the HTML of the reply.
+ *
+ * The server tells in every reply what it accepts: by `Accept-Encoding: deflate` (RFC 7694) the next requests can be
+ * compressed, by `X-Stc-Delta: 1` they can carry only a delta against the text the server acknowledged
+ * (see `PreviewTransport`). When the server answers 409 to a delta (it does not have the base text) or 415
+ * to a compressed request, the same text is sent again, whole and not compressed.
+ * Only the texts of successful replies with HTML are acknowledged, deltas are never made against a failed one.
+ */
+class StcRemoteRenderer : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Stats
+    {
+        int requestCount = 0;
+        int deltaRequestCount = 0;
+        qint64 bytesSent = 0;
+        qint64 bytesBeforeCompression = 0; // of the same requests
+        qint64 bytesReceived = 0;
+    };
+
+    explicit StcRemoteRenderer(QNetworkAccessManager& network, QObject* parent = nullptr);
+
+    void setEndpoint(const QUrl& url)
+    {
+        endpoint = url;
+    }
+
+    void setSecurityToken(const QString& token)
+    {
+        securityToken = token;
+    }
+
+    /// `rendered` or `failed` is emitted when done, the next text should be rendered after that
+    void render(const QString& text);
+
+    /// Forgets the text acknowledged by the server, the reply of the request in progress is ignored
+    void reset();
+
+    bool acceptsDeflate() const
+    {
+        return serverAcceptsDeflate;
+    }
+
+    bool acceptsDeltas() const
+    {
+        return serverAcceptsDeltas;
+    }
+
+    const Stats& getStats() const
+    {
+        return stats;
+    }
+
+signals:
+    /// The latency is counted from sending the text the first time, also when it had to be sent again
+    void rendered(const QString& html, std::chrono::microseconds latency);
+    void failed(const QString& reason);
+
+private:
+    struct SentText
+    {
+        std::string text;
+        bool asDelta = false;
+        bool compressed = false;
+        Tracing::Clock::time_point start;
+        quint64 generation = 0;
+    };
+
+    void send(SentText sent);
+    void onReplyFinished(QNetworkReply* reply, const SentText& sent);
+
+    QNetworkAccessManager& network;
+    QUrl endpoint;
+    QString securityToken;
+
+    std::string acknowledgedText; // the last text rendered by the server, deltas are made against it
+    bool serverAcceptsDeflate = false;
+    bool serverAcceptsDeltas = false;
+    quint64 generation = 0; // replies of requests sent before `reset` are ignored
+
+    Stats stats;
+};
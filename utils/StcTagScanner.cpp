@@ -0,0 +1,191 @@
+#include <array>
+#include <utility>
+#include "StcTagScanner.h"
+
+
+namespace
+{
+/// [[:alpha:]] and [[:alnum:]] of the checker's regular expression work on ASCII only
+bool isAsciiLetter(QChar c)
+{
+    const char16_t u = c.unicode();
+    return (u >= u'a' && u <= u'z') || (u >= u'A' && u <= u'Z');
+}
+
+bool isAsciiLetterOrDigit(QChar c)
+{
+    const char16_t u = c.unicode();
+    return isAsciiLetter(c) || (u >= u'0' && u <= u'9');
+}
+
+const std::array<std::pair<QStringView, StcTags>, 21> tagKinds =
+{{
+    { u"run", StcTags::RUN },
+    { u"cpp", StcTags::CPP },
+    { u"py", StcTags::PY },
+    { u"code", StcTags::CODE },
+    { u"div", StcTags::DIV },
+    { u"a", StcTags::A_HREF },
+    { u"pkt", StcTags::PKT },
+    { u"csv", StcTags::CSV },
+    { u"b", StcTags::BOLD },
+    { u"i", StcTags::ITALIC },
+    { u"u", StcTags::UNDERLINED },
+    { u"s", StcTags::STRUCK_OUT },
+    { u"cytat", StcTags::QUOTE },
+    { u"h1", StcTags::H1 },
+    { u"h2", StcTags::H2 },
+    { u"h3", StcTags::H3 },
+    { u"h4", StcTags::H4 },
+    { u"sub", StcTags::SUBSCRIPT },
+    { u"sup", StcTags::SUPSCRIPT },
+    { u"tt", StcTags::TELE_TYPE },
+    { u"img", StcTags::IMG },
+}};
+} // namespace
+
+
+namespace stc
+{
+std::optional<TagToken> TagScanner::next()
+{
+    const qsizetype size = text.size();
+    while (position < size)
+    {
+        const qsizetype openingBracket = text.indexOf(u'[', position);
+        if (openingBracket < 0)
+        {
+            break;
+        }
+
+        qsizetype i = openingBracket + 1;
+        const bool closing = i < size && text[i] == u'/';
+        if (closing)
+        {
+            ++i;
+        }
+
+        if (i >= size || !isAsciiLetter(text[i]))
+        {
+            position = openingBracket + 1;
+            continue;
+        }
+
+        const qsizetype nameStart = i;
+        while (i < size && isAsciiLetterOrDigit(text[i]))
+        {
+            ++i;
+        }
+
+        const qsizetype closingBracket = text.indexOf(u']', i);
+        if (closingBracket < 0) // none of the following '[' can be closed either
+        {
+            break;
+        }
+
+        TagToken token;
+        token.closing = closing;
+        token.start = static_cast<int>(openingBracket);
+        token.length = static_cast<int>(closingBracket + 1 - openingBracket);
+        token.nameStart = static_cast<int>(nameStart);
+        token.nameLength = static_cast<int>(i - nameStart);
+        token.attributesStart = static_cast<int>(i);
+        token.attributesLength = static_cast<int>(closingBracket - i);
+        token.kind = tagKind(token.name(text), token.attributes(text));
+
+        position = closingBracket + 1;
+        return token;
+    }
+
+    position = size;
+    return std::nullopt;
+}
+
+StcTags tagKind(QStringView tagName, QStringView attributes)
+{
+    for (const auto& [name, kind] : tagKinds)
+    {
+        if (name.compare(tagName, Qt::CaseInsensitive) != 0)
+        {
+            continue;
+        }
+
+        if (StcTags::DIV == kind && !attributes.isEmpty())
+        {
+            const auto divClass = attributeValue(attributes, u"class");
+            if (divClass && *divClass == u"tip")
+                return StcTags::DIV_TIP;
+            if (divClass && *divClass == u"uwaga")
+                return StcTags::DIV_WARNING;
+        }
+        return kind;
+    }
+    return StcTags::NONE;
+}
+
+int headerLevel(QStringView tagName)
+{
+    if (tagName.size() == 2 && (tagName[0] == u'h' || tagName[0] == u'H')
+        && tagName[1] >= u'1' && tagName[1] <= u'6')
+    {
+        return tagName[1].unicode() - u'0';
+    }
+    return 0;
+}
+
+bool isCodeTag(QStringView tagName)
+{
+    for (QStringView codeTag : { u"cpp", u"code", u"py", u"log" })
+    {
+        if (codeTag.compare(tagName, Qt::CaseInsensitive) == 0)
+            return true;
+    }
+    return false;
+}
+
+std::optional<QStringView> attributeValue(QStringView attributes, QStringView attributeName)
+{
+    for (qsizetype from = 0; ; )
+    {
+        const qsizetype nameStart = attributes.indexOf(attributeName, from, Qt::CaseInsensitive);
+        if (nameStart < 0)
+        {
+            return std::nullopt;
+        }
+        from = nameStart + 1;
+
+        if (nameStart > 0 && !attributes[nameStart - 1].isSpace())
+        {
+            continue;
+        }
+
+        qsizetype i = nameStart + attributeName.size();
+        while (i < attributes.size() && attributes[i].isSpace())
+            ++i;
+        if (i >= attributes.size() || attributes[i] != u'=')
+        {
+            continue;
+        }
+        ++i;
+        while (i < attributes.size() && attributes[i].isSpace())
+            ++i;
+        if (i >= attributes.size())
+        {
+            return QStringView{};
+        }
+
+        const QChar quote = attributes[i];
+        if (quote == u'"' || quote == u'\'')
+        {
+            const qsizetype valueEnd = attributes.indexOf(quote, i + 1);
+            const qsizetype valueStart = i + 1;
+            return attributes.sliced(valueStart, (valueEnd < 0 ? attributes.size() : valueEnd) - valueStart);
+        }
+
+        qsizetype valueEnd = i;
+        while (valueEnd < attributes.size() && !attributes[valueEnd].isSpace())
+            ++valueEnd;
+        return attributes.sliced(i, valueEnd - i);
+    }
+}
+} // namespace stc
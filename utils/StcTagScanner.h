@@ -0,0 +1,74 @@
+#pragma once
+
+#include <optional>
+#include <QStringView>
+#include "types/stcTags.h"
+
+namespace stc
+{
+/// Position of a single STC tag like `[b]`, `[/b]` or `[img src="..."]` inside of a scanned text.
+/// The token keeps only offsets, so scanning a line does not allocate memory.
+struct TagToken
+{
+    StcTags kind = StcTags::NONE; // NONE for tags unknown to the editor (eg. [h5] or [log]) too
+    bool closing = false;
+    int start = 0;            // position of '['
+    int length = 0;           // from '[' to ']' inclusive
+    int nameStart = 0;
+    int nameLength = 0;
+    int attributesStart = 0;  // everything between the name and ']'
+    int attributesLength = 0;
+
+    int end() const
+    {
+        return start + length;
+    }
+
+    QStringView name(QStringView text) const
+    {
+        return text.sliced(nameStart, nameLength);
+    }
+
+    QStringView attributes(QStringView text) const
+    {
+        return text.sliced(attributesStart, attributesLength);
+    }
+
+    bool isNamed(QStringView text, QStringView tagName) const
+    {
+        return name(text).compare(tagName, Qt::CaseInsensitive) == 0;
+    }
+};
+
+/**
+ * @brief Finds STC tags in a text (usually a single line) one after another.
+ *
+ * The grammar is the same as of the regular expression `\[/?([[:alpha:]][[:alnum:]]*)([^\]]*)\]` used by `PairedTagsChecker`:
+ * a tag name starts with an ASCII letter, everything after the name up to the first ']' is treated as attributes.
+ */
+class TagScanner
+{
+public:
+    explicit TagScanner(QStringView text, qsizetype from = 0)
+        : text(text), position(from)
+    {}
+
+    std::optional<TagToken> next();
+
+private:
+    QStringView text;
+    qsizetype position;
+};
+
+/// Kind of tag by its name (case insensitive), for [div] also class attribute is being checked
+StcTags tagKind(QStringView tagName, QStringView attributes = {});
+
+/// returns 1-6 for [h1]..[h6], 0 for other tags
+int headerLevel(QStringView tagName);
+
+/// [cpp], [code], [py] and [log] contain code, other tags inside them are not interpreted
+bool isCodeTag(QStringView tagName);
+
+/// Value of attribute in form `name="value"` (or with apostrophes), std::nullopt if there is no such attribute
+std::optional<QStringView> attributeValue(QStringView attributes, QStringView attributeName);
+} // namespace stc
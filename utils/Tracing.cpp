@@ -0,0 +1,289 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Tracing.h"
+
+namespace Tracing
+{
+namespace
+{
+constexpr std::size_t maxFinishedThreads = 8; // buffers of threads which ended, eg. expired threads of QThreadPool
+
+struct Event
+{
+    const char* category;
+    const char* name;
+    std::int64_t startNs;    // since the epoch of the trace
+    std::int64_t durationNs;
+    std::uint64_t asyncId;   // 0 for scopes of the thread
+};
+
+struct ThreadBuffer
+{
+    std::mutex mutex; // only the owning thread writes, so it is contended only when the trace is being saved
+    std::vector<Event> events; // grows up to eventsPerThread, then the oldest events are overwritten
+    std::uint64_t written = 0;
+    int threadId = 0;
+    std::string threadName;
+    bool finished = false;
+};
+
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    int nextThreadId = 1;
+};
+
+std::atomic_bool enabled = true;
+std::atomic_uint64_t nextAsyncId = 1;
+
+Registry& registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+Clock::time_point epoch()
+{
+    static const Clock::time_point start = Clock::now();
+    return start;
+}
+
+std::int64_t sinceEpoch(Clock::time_point time)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time - epoch()).count();
+}
+
+/// Keeps events of the thread in the registry after the thread ends, until newer threads push them out
+struct BufferOwner
+{
+    std::shared_ptr<ThreadBuffer> buffer;
+
+    ~BufferOwner()
+    {
+        if (buffer)
+        {
+            std::lock_guard lock(buffer->mutex);
+            buffer->finished = true;
+        }
+    }
+};
+
+thread_local BufferOwner currentThread;
+
+ThreadBuffer& currentBuffer()
+{
+    if (!currentThread.buffer)
+    {
+        auto buffer = std::make_shared<ThreadBuffer>();
+
+        Registry& all = registry();
+        std::lock_guard lock(all.mutex);
+        buffer->threadId = all.nextThreadId++;
+        buffer->threadName = "thread " + std::to_string(buffer->threadId);
+
+        const auto finishedCount = std::ranges::count_if(all.buffers, [](const auto& other) {
+            std::lock_guard lock(other->mutex);
+            return other->finished;
+        });
+        if (finishedCount >= static_cast<std::ptrdiff_t>(maxFinishedThreads))
+        {
+            const auto oldestFinished = std::ranges::find_if(all.buffers, [](const auto& other) {
+                std::lock_guard lock(other->mutex);
+                return other->finished;
+            });
+            all.buffers.erase(oldestFinished);
+        }
+        all.buffers.push_back(buffer);
+
+        currentThread.buffer = std::move(buffer);
+    }
+    return *currentThread.buffer;
+}
+
+void record(const Event& event)
+{
+    ThreadBuffer& buffer = currentBuffer();
+    std::lock_guard lock(buffer.mutex);
+    if (buffer.events.size() < eventsPerThread)
+        buffer.events.push_back(event);
+    else
+        buffer.events[buffer.written % eventsPerThread] = event;
+    ++buffer.written;
+}
+
+void appendJsonString(std::string& json, const char* text)
+{
+    json += '"';
+    for (const char* c = text; *c; ++c)
+    {
+        switch (*c)
+        {
+        case '"':  json += "\\\""; break;
+        case '\\': json += "\\\\"; break;
+        case '\n': json += "\\n"; break;
+        case '\t': json += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(*c) < 0x20)
+            {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", *c);
+                json += escaped;
+            }
+            else
+                json += *c;
+        }
+    }
+    json += '"';
+}
+
+void appendMicroseconds(std::string& json, std::int64_t nanoseconds)
+{
+    char number[32];
+    std::snprintf(number, sizeof(number), "%.3f", static_cast<double>(nanoseconds) / 1'000.0);
+    json += number;
+}
+
+void appendEvent(std::string& json, const Event& event, int threadId)
+{
+    const auto appendCommon = [&](const char* phase, std::int64_t timeNs) {
+        json += json.ends_with('[') ? "\n" : ",\n";
+        json += R"({"name":)";
+        appendJsonString(json, event.name);
+        json += R"(,"cat":)";
+        appendJsonString(json, event.category);
+        json += R"(,"ph":")";
+        json += phase;
+        json += R"(","ts":)";
+        appendMicroseconds(json, timeNs);
+        json += R"(,"pid":1,"tid":)";
+        json += std::to_string(threadId);
+    };
+
+    if (event.asyncId == 0)
+    {
+        appendCommon("X", event.startNs);
+        json += R"(,"dur":)";
+        appendMicroseconds(json, event.durationNs);
+        json += '}';
+    }
+    else
+    {
+        for (const auto& [phase, timeNs] : { std::pair{ "b", event.startNs }, std::pair{ "e", event.startNs + event.durationNs } })
+        {
+            appendCommon(phase, timeNs);
+            json += R"(,"id":)";
+            json += std::to_string(event.asyncId);
+            json += '}';
+        }
+    }
+}
+} // namespace
+
+void setEnabled(bool enable)
+{
+    enabled.store(enable, std::memory_order_relaxed);
+}
+
+bool isEnabled()
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void setCurrentThreadName(const char* name)
+{
+    ThreadBuffer& buffer = currentBuffer();
+    std::lock_guard lock(buffer.mutex);
+    buffer.threadName = name;
+}
+
+void recordAsync(const char* category, const char* name, Clock::time_point start)
+{
+    if (!isEnabled())
+        return;
+
+    const auto end = Clock::now();
+    record({ .category = category, .name = name, .startNs = sinceEpoch(start), .durationNs = sinceEpoch(end) - sinceEpoch(start),
+             .asyncId = nextAsyncId.fetch_add(1, std::memory_order_relaxed) });
+}
+
+Scope::Scope(const char* category, const char* name)
+    : category(category)
+{
+    if (!isEnabled())
+        return;
+
+    this->name = name;
+    start = Clock::now();
+}
+
+Scope::~Scope()
+{
+    if (!name)
+        return;
+
+    const auto end = Clock::now();
+    record({ .category = category, .name = name, .startNs = sinceEpoch(start), .durationNs = sinceEpoch(end) - sinceEpoch(start), .asyncId = 0 });
+}
+
+std::string toChromeTraceJson()
+{
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        Registry& all = registry();
+        std::lock_guard lock(all.mutex);
+        buffers = all.buffers;
+    }
+
+    std::string json = R"({"displayTimeUnit":"ms","traceEvents":[)";
+    for (const auto& buffer : buffers)
+    {
+        std::vector<Event> events;
+        std::string threadName;
+        {
+            std::lock_guard lock(buffer->mutex);
+            events = buffer->events;
+            threadName = buffer->threadName;
+            // the oldest event is the next one to be overwritten
+            const std::size_t oldest = events.size() < eventsPerThread ? 0 : buffer->written % eventsPerThread;
+            std::ranges::rotate(events, events.begin() + static_cast<std::ptrdiff_t>(oldest));
+        }
+
+        json += json.ends_with('[') ? "\n" : ",\n";
+        json += R"({"name":"thread_name","ph":"M","pid":1,"tid":)";
+        json += std::to_string(buffer->threadId);
+        json += R"(,"args":{"name":)";
+        appendJsonString(json, threadName.c_str());
+        json += "}}";
+
+        for (const Event& event : events)
+            appendEvent(json, event, buffer->threadId);
+    }
+    json += "\n]}\n";
+    return json;
+}
+
+bool saveChromeTrace(const std::string& fileName)
+{
+    std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+    file << toChromeTraceJson();
+    return static_cast<bool>(file.flush());
+}
+
+void clear()
+{
+    Registry& all = registry();
+    std::lock_guard lock(all.mutex);
+    for (const auto& buffer : all.buffers)
+    {
+        std::lock_guard bufferLock(buffer->mutex);
+        buffer->events.clear();
+        buffer->written = 0;
+    }
+}
+} // namespace Tracing
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Flight recorder of what the editor was doing, to be saved as a Chrome trace (chrome://tracing, ui.perfetto.dev).
+ *
+ * `TRACE_SCOPE("category", "name")` records the time of the enclosing scope into a ring buffer of the current thread,
+ * which keeps the last `eventsPerThread` events, so a trace saved when typing got slow shows the moments before.
+ * Scopes are compiled only with `STC_TRACING` (CMake option of the same name), otherwise the macros expand to nothing.
+ * Names and categories have to be string literals, only pointers to them are recorded.
+ */
+namespace Tracing
+{
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t eventsPerThread = 16 * 1024;
+
+/// Recording is on by default, so a trace can be saved after the problem already happened
+void setEnabled(bool enabled);
+bool isEnabled();
+
+/// Name of the current thread in the trace, eg. "main"; other threads are named "thread N"
+void setCurrentThreadName(const char* name);
+
+/// Records an operation which started at `start` and ends now, eg. a network request from sending to its reply.
+/// Such operations can overlap with anything, so they are shown in their own track of the category.
+void recordAsync(const char* category, const char* name, Clock::time_point start);
+
+class Scope
+{
+public:
+    Scope(const char* category, const char* name);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* category;
+    const char* name = nullptr; // nullptr when recording is disabled
+    Clock::time_point start;
+};
+
+/// Events of all threads still kept in ring buffers, in the Chrome trace event format.
+std::string toChromeTraceJson();
+
+/// Returns false if the file could not be written.
+bool saveChromeTrace(const std::string& fileName);
+
+/// Forgets all recorded events.
+void clear();
+} // namespace Tracing
+
+#ifdef STC_TRACING
+#define TRACING_CONCATENATE_(a, b) a##b
+#define TRACING_CONCATENATE(a, b) TRACING_CONCATENATE_(a, b)
+#define TRACE_SCOPE(category, name) const Tracing::Scope TRACING_CONCATENATE(traceScope, __COUNTER__)(category, name)
+#define TRACE_ASYNC(category, name, start) Tracing::recordAsync(category, name, start)
+#else
+#define TRACE_SCOPE(category, name) static_cast<void>(0)
+#define TRACE_ASYNC(category, name, start) static_cast<void>(0)
+#endif
@@ -1,10 +1,10 @@
-#include <QRegularExpression>
 #include <QStack>
 #include <QUrl>
 #include <QTextBlock>
 #include "BreadcrumbTextBrowser.h"
 #include "CodeEditor.h"
 #include "widgets/FilteredTagTableWidget.h"
+#include "utils/StcDocumentModel.h"
 
 
 static const QSet<QString> selfClosingTags2Ignore = { "img", "a" };
@@ -75,7 +75,6 @@ QString BreadcrumbTextBrowser::buildBreadcrumbHtml(const QTextCursor& cursor)
         return {};
 
     const int pos = cursor.position();
-    const QTextDocument* doc = textEditor->document();
 
     QStringList breadcrumbParts;
 
@@ -88,7 +87,7 @@ QString BreadcrumbTextBrowser::buildBreadcrumbHtml(const QTextCursor& cursor)
         breadcrumbParts << tagLink(headers[level].second, headers[level].first);
 
     // Step 2: Parse context tags from last header to cursor position
-    const auto tagStack = collectContextTags(doc, startScanPos, pos);
+    const auto tagStack = collectContextTags(startScanPos, pos);
     for (const auto& [tag, tagPos] : tagStack)
         breadcrumbParts << tagLink(tagPos, tag.toUpper());
 
@@ -134,81 +133,44 @@ void BreadcrumbTextBrowser::extractHeadersBeforePosition(int cursorPos, QMap<int
     }
 }
 
-QStack<QPair<QString, int>> BreadcrumbTextBrowser::collectContextTags(const QTextDocument* doc, int startPos, int cursorPos) const
+QStack<QPair<QString, int>> BreadcrumbTextBrowser::collectContextTags(int startPos, int cursorPos) const
 {
-    static QRegularExpression tagOpen(R"(\[([a-z0-9]+)(?:\s+[^\]]+)?\])", QRegularExpression::CaseInsensitiveOption);
-    static QRegularExpression tagClose(R"(\[/([a-z0-9]+)\])", QRegularExpression::CaseInsensitiveOption);
-
     QStack<QPair<QString, int>> tagStack;
     QMap<QString, QStack<int>> openTagPositions;
 
-    QTextBlock block = doc->findBlock(startPos);
-
-    while (block.isValid())
-    {
-        const QString lineText = block.text();
-        const int blockStart = block.position();
-        int limit = block.length();
-        if (block.contains(cursorPos))
-            limit = cursorPos - blockStart;
-
-        int index = 0;
-        while (index < limit)
-        {
-            auto mOpen = tagOpen.match(lineText, index);
-            auto mClose = tagClose.match(lineText, index);
+    const int scanFrom = textEditor->document()->findBlock(startPos).position();
 
-            int oPos = mOpen.hasMatch() ? mOpen.capturedStart() : -1;
-            int cPos = mClose.hasMatch() ? mClose.capturedStart() : -1;
+    textEditor->getStcDocumentModel()->forEachTag([&](QStringView text, int blockPosition, const stc::TagToken& token) {
+        const QString tag = token.name(text).toString().toLower();
+        const int globalPos = blockPosition + token.start;
 
-            if (oPos != -1 && (cPos == -1 || oPos < cPos) && oPos < limit)
+        if (!token.closing)
+        {
+            if (!tag.startsWith('h') &&
+                !textEditor->isInsideCode(globalPos) &&
+                !selfClosingTags2Ignore.contains(tag))
             {
-                const QString tag = mOpen.captured(1).toLower();
-                const int globalPos = blockStart + mOpen.capturedStart();
-
-                if (!tag.startsWith('h') &&
-                    !textEditor->isInsideCode(globalPos) &&
-                    !selfClosingTags2Ignore.contains(tag))
-                {
-                    tagStack.push({ tag, globalPos });
-                    openTagPositions[tag].push(globalPos);
-                }
-
-                index = mOpen.capturedEnd();
+                tagStack.push({ tag, globalPos });
+                openTagPositions[tag].push(globalPos);
             }
-            else if (cPos != -1 && cPos < limit)
-            {
-                const QString tag = mClose.captured(1).toLower();
+        }
+        else if (0 == token.attributesLength &&
+                 openTagPositions.contains(tag) &&
+                 !openTagPositions[tag].isEmpty() &&
+                 !textEditor->isInsideCode(openTagPositions[tag].top()))
+        {
+            const int openPos = openTagPositions[tag].pop();
 
-                if (openTagPositions.contains(tag) &&
-                    !openTagPositions[tag].isEmpty() &&
-                    !textEditor->isInsideCode(openTagPositions[tag].top()))
+            for (int i = tagStack.size() - 1; i >= 0; --i)
+            {
+                if (tagStack[i].first == tag && tagStack[i].second == openPos)
                 {
-                    const int openPos = openTagPositions[tag].pop();
-
-                    for (int i = tagStack.size() - 1; i >= 0; --i)
-                    {
-                        if (tagStack[i].first == tag && tagStack[i].second == openPos)
-                        {
-                            tagStack.remove(i);
-                            break;
-                        }
-                    }
+                    tagStack.remove(i);
+                    break;
                 }
-
-                index = mClose.capturedEnd();
-            }
-            else
-            {
-                break;
             }
         }
-
-        if (block.contains(cursorPos))
-            break;
-
-        block = block.next();
-    }
+    }, scanFrom, cursorPos);
 
     return tagStack;
 }
@@ -24,7 +24,7 @@ signals:
 
 protected:
     void extractHeadersBeforePosition(int cursorPos, QMap<int, QPair<QString, int>> &headers, int &outStartScanPos) const;
-    QStack<QPair<QString, int>> collectContextTags(const QTextDocument *doc, int startPos, int cursorPos) const;
+    QStack<QPair<QString, int>> collectContextTags(int startPos, int cursorPos) const;
 
 private slots:
     void onCursorPositionChanged();
@@ -5,6 +5,7 @@
 #include "widgets/CodeBlocksTableWidget.h"
 #include "CodeEditor.h"
 #include "types/CodeBlock.h"
+#include "utils/Tracing.h"
 
 namespace
 {
@@ -100,6 +101,7 @@ QString CodeBlocksTableWidget::getFilterCategory4CodeBlock(const QString &tag, c
 
 void CodeBlocksTableWidget::updateCodeBlocks()
 {
+    TRACE_SCOPE("panel", "CodeBlocksTableWidget::updateCodeBlocks");
     clearContents();
     setRowCount(0);
 
@@ -5,6 +5,9 @@
 #include <QMenu>
 #include "FilteredTagTableWidget.h"
 #include "CodeEditor.h"
+#include "utils/StcDocumentModel.h"
+#include "utils/HandlerTimings.h"
+#include "utils/Tracing.h"
 
 
 namespace
@@ -44,7 +47,7 @@ void FilteredTagTableWidget::setTextEditor(CodeEditor* newTextEditor)
 {
     if (textEditor)
     {
-        disconnect(textEditor->document(), &QTextDocument::contentsChange, this, &FilteredTagTableWidget::onTextChanged);
+        disconnect(textEditor->getStcDocumentModel(), &StcDocumentModel::contentsChange, this, &FilteredTagTableWidget::onTextChanged);
         disconnect(textEditor, &CodeEditor::cursorPositionChanged, this, &FilteredTagTableWidget::highlightCurrentTagInContextTable);
     }
 
@@ -52,7 +55,7 @@ void FilteredTagTableWidget::setTextEditor(CodeEditor* newTextEditor)
 
     if (textEditor)
     {
-        connect(textEditor->document(), &QTextDocument::contentsChange, this, &FilteredTagTableWidget::onTextChanged);
+        connect(textEditor->getStcDocumentModel(), &StcDocumentModel::contentsChange, this, &FilteredTagTableWidget::onTextChanged);
         connect(textEditor, &CodeEditor::cursorPositionChanged, this, &FilteredTagTableWidget::highlightCurrentTagInContextTable);
         rebuildAllHeaders();
     }
@@ -65,43 +68,29 @@ void FilteredTagTableWidget::showEvent(QShowEvent* event)
         rebuildAllHeaders();
 }
 
-QRegularExpression FilteredTagTableWidget::headerRegex()
-{
-    static QRegularExpression regex(R"(\[(h[1-6])(?:\s+[^\]]+)?\](.*?)\[/\1\])",
-                                    QRegularExpression::DotMatchesEverythingOption | QRegularExpression::CaseInsensitiveOption);
-    return regex;
-}
-
 void FilteredTagTableWidget::rebuildAllHeaders()
 {
+    TRACE_SCOPE("panel", "FilteredTagTableWidget::rebuildAllHeaders");
     cachedHeaders.clear();
     clearHeaderTable();
 
     if (!textEditor || textEditor->toPlainText().isEmpty())
         return;
 
-    const QString text = textEditor->toPlainText();
-    const QRegularExpression& re = headerRegex();
-    QRegularExpressionMatchIterator it = re.globalMatch(text);
-
-    while (it.hasNext())
+    for (const auto& header : textEditor->getStcDocumentModel()->headers())
     {
-        QRegularExpressionMatch match = it.next();
-        const int start = match.capturedStart();
-        const int end = match.capturedEnd();
-
-        if (textEditor->isInsideCode(start))
+        if (textEditor->isInsideCode(header.startPos))
             continue;
 
         QTextCursor cursor = textEditor->textCursor();
-        cursor.setPosition(start);
+        cursor.setPosition(header.startPos);
 
         HeaderInfo info {
             .startingTagCursor = cursor,
-            .tagName = match.captured(1),
-            .textInside = match.captured(2),
-            .startPos = start,
-            .endPos = end
+            .tagName = header.tagName,
+            .textInside = header.textInside,
+            .startPos = header.startPos,
+            .endPos = header.endPos
         };
 
         cachedHeaders.append(info);
@@ -166,6 +155,7 @@ void FilteredTagTableWidget::insertOrUpdateHeader(const HeaderInfo& info)
 
 void FilteredTagTableWidget::onTextChanged(int pos, int charsRemoved, int charsAdded)
 {
+    HANDLER_TIMING("FilteredTagTableWidget::onTextChanged");
     // If we don't have a text editor or document is empty, clear the headers
     if (!textEditor || !textEditor->document() || textEditor->document()->blockCount() == 0)
     {
@@ -213,22 +203,10 @@ void FilteredTagTableWidget::onTextChanged(int pos, int charsRemoved, int charsA
     QTextBlock block = textEditor->document()->findBlock(pos);
     QTextBlock endBlock = textEditor->document()->findBlock(pos + charsAdded);
 
-    // Go back to the first block that might have been affected
-    while (block.isValid() && block != endBlock)
-    {
-        block = block.previous();
-        if (!block.isValid())
-            break;
-    }
-    if (!block.isValid())
-        block = textEditor->document()->begin();
-
-    // Process all affected blocks
+    // Process all affected blocks, their headers are already parsed by the document model
+    const StcDocumentModel* model = textEditor->getStcDocumentModel();
     while (block.isValid() && block != endBlock.next())
     {
-        const QString blockText = block.text();
-        QRegularExpressionMatchIterator it = headerRegex().globalMatch(blockText);
-
         // Remove all headers from this block (we'll re-add the current ones)
         cachedHeaders.erase(
             std::remove_if(cachedHeaders.begin(), cachedHeaders.end(),
@@ -238,22 +216,19 @@ void FilteredTagTableWidget::onTextChanged(int pos, int charsRemoved, int charsA
             cachedHeaders.end());
 
         // Add current headers from this block
-        while (it.hasNext())
+        for (const auto& header : model->headersInBlock(block))
         {
-            QRegularExpressionMatch match = it.next();
-            const int start = block.position() + match.capturedStart();
-
-            if (!textEditor->isInsideCode(start))
+            if (!textEditor->isInsideCode(header.startPos))
             {
                 QTextCursor cursor(block);
-                cursor.setPosition(start);
+                cursor.setPosition(header.startPos);
 
                 HeaderInfo info{
                     .startingTagCursor = cursor,
-                    .tagName = match.captured(1),
-                    .textInside = match.captured(2).trimmed(),
-                    .startPos = start,
-                    .endPos = static_cast<int>(start + match.capturedLength())
+                    .tagName = header.tagName,
+                    .textInside = header.textInside.trimmed(),
+                    .startPos = header.startPos,
+                    .endPos = header.endPos
                 };
 
                 cachedHeaders.append(info);
@@ -275,6 +250,7 @@ void FilteredTagTableWidget::onTextChanged(int pos, int charsRemoved, int charsA
 
 void FilteredTagTableWidget::refreshHeaderTable()
 {
+    TRACE_SCOPE("panel", "FilteredTagTableWidget::refreshHeaderTable");
     setRowCount(0);
 
     for (const auto& info : cachedHeaders)
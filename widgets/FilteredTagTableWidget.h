@@ -5,7 +5,6 @@
 #include <QTextCursor>
 
 class QMenu;
-class QRegularExpression;
 
 class CodeEditor;
 
@@ -51,8 +50,6 @@ private slots:
     void onTextChanged(int pos, int charsRemoved, int charsAdded);
 
 protected:
-    static QRegularExpression headerRegex();
-
     void showEvent(QShowEvent* event) override;
 
     void refreshHeaderTable();
@@ -5,7 +5,12 @@
 #include <QEnterEvent>
 #include <QToolTip>
 #include <QCursor>
+#include <QElapsedTimer>
+#include <QMetaMethod>
+#include <QDebug>
 #include "StcPreview.h"
+#include "utils/HandlerTimings.h"
+#include "utils/Tracing.h"
 
 
 namespace
@@ -22,6 +27,52 @@ QString humanReadableBytes(qint64 bytes)
     }
     return QString::number(size, 'f', 1) + " " + units[unit];
 }
+
+/// For the classes produced by StcHtmlRenderer, similar to the look of cpp0x.pl
+constexpr const char *localStylesheet = R"(
+    body { font-family: Verdana, Arial, sans-serif; font-size: 13px; line-height: 1.5; margin: 8px; }
+    h1, h2, h3, h4 { color: #2b4d7a; margin: 0.6em 0 0.3em; }
+    pre { background: #f6f8fa; border: 1px solid #d0d7de; padding: 6px; overflow-x: auto; }
+    pre.cpp { border-left: 4px solid #00599c; }
+    pre.py { border-left: 4px solid #3776ab; }
+    div.src { font-size: 11px; color: #555; margin-top: 6px; }
+    div.div { border: 1px solid #ccc; padding: 6px; margin: 6px 0; }
+    div.tip { background: #eef8ee; border-color: #7cbf7c; }
+    div.uwaga { background: #fff4e5; border-color: #e0a040; }
+    blockquote.cytat { border-left: 4px solid #aaa; margin: 6px 0; padding: 2px 10px; color: #444; }
+    table.csv { border-collapse: collapse; margin: 6px 0; }
+    table.csv th, table.csv td { border: 1px solid #bbb; padding: 2px 6px; }
+    table.csv th { background: #eee; }
+    figure.img { margin: 6px 0; }
+    figure.autofit img { max-width: 100%; }
+    figcaption { font-style: italic; color: #555; }
+    div.Section { display: contents; }
+)";
+
+/// Replaces sections of the preview by ids, see StcHtmlRenderer::IncrementalRenderer::Patch
+constexpr const char *applyPatchScript = R"(
+    function applyPatch(removedIds, insertAfterId, insertedSections) {
+        const container = document.getElementById("Preview");
+        for (const id of removedIds) {
+            document.getElementById(id)?.remove();
+        }
+        const sections = document.createDocumentFragment();
+        for (const [id, html] of insertedSections) {
+            const section = document.createElement("div");
+            section.id = id;
+            section.className = "Section";
+            section.innerHTML = html;
+            sections.appendChild(section);
+        }
+        const previous = insertAfterId === null ? null : document.getElementById(insertAfterId);
+        container.insertBefore(sections, previous ? previous.nextSibling : container.firstChild);
+    }
+)";
+
+QString sectionElementId(std::uint64_t sectionId)
+{
+    return "s" + QString::number(sectionId);
+}
 } // namespace
 
 
@@ -32,13 +83,74 @@ StcPreviewWidget::StcPreviewWidget(QWidget *parent) : QWidget(parent)
 
     layout->addWidget(&webView);
 
-    // Display initial empty preview container
-    webView.setHtml("<html><body><div id='Preview'></div></body></html>", makeUrl("/"));
+    // eg. STC_PREVIEW_SERVER=http://localhost:8080 to test the remote rendering against a local stand-in of cpp0x.pl
+    if (const QString server = qEnvironmentVariable("STC_PREVIEW_SERVER"); !server.isEmpty())
+        baseUrl = QUrl(server);
+    remoteRenderer.setEndpoint(makeUrl("/stc/"));
+    connect(&remoteRenderer, &StcRemoteRenderer::rendered, this, &StcPreviewWidget::onRemoteRendered);
+    connect(&remoteRenderer, &StcRemoteRenderer::failed, this, &StcPreviewWidget::onRemoteRenderingFailed);
+
+    debounceTimer.setSingleShot(true);
+    connect(&debounceTimer, &QTimer::timeout, this, &StcPreviewWidget::scheduleTextUpdate);
+
+    connect(&webView, &QWebEngineView::loadFinished, this, &StcPreviewWidget::onPageLoaded);
+    loadLocalPage();
 
     setFocusPolicy(Qt::NoFocus);
     webView.setFocusPolicy(Qt::NoFocus);
 }
 
+void StcPreviewWidget::setRendering(Rendering newRendering)
+{
+    if (rendering == newRendering)
+        return;
+
+    rendering = newRendering;
+    isInitialized = false;
+    requestInProgress = false; // reply of the other rendering is ignored
+    remoteRenderer.reset();
+    hasPendingUpdate = !pendingText.isEmpty();
+    debounceTimer.stop();
+    stats.latencies.clear();
+
+    if (rendering == Rendering::Local)
+        loadLocalPage();
+    else if (!securityToken.isEmpty())
+        loadCssAndInitialize();
+    // otherwise the page is loaded after login
+}
+
+void StcPreviewWidget::loadLocalPage()
+{
+    const QString html = QString(R"(
+        <html><head><meta charset="utf-8"><style>%1</style><script>%2</script></head>
+        <body><div class="Preview" id="Preview"></div></body></html>
+    )").arg(localStylesheet, applyPatchScript);
+
+    // relative links and images point to the site, as they would after publishing
+    webView.setHtml(html, makeUrl("/"));
+}
+
+void StcPreviewWidget::onPageLoaded(bool ok)
+{
+    if (!ok)
+    {
+        if (rendering == Rendering::Remote)
+            emit loginFailed("Failed to load preview HTML into WebView.");
+        return;
+    }
+
+    isInitialized = true;
+    lastSentText.clear(); // the container of the new page is empty
+    requestInProgress = false;
+    remoteRenderer.reset();
+    incrementalRenderer.reset();
+    scheduleTextUpdate();
+
+    if (rendering == Rendering::Remote)
+        emit loginSucceeded();
+}
+
 void StcPreviewWidget::login(const QString &username, const QString &password) {
     // Step 1: Load login page to extract CSRF security token
     QNetworkRequest tokenRequest(makeUrl("/logowanie/"));
@@ -102,6 +214,7 @@ void StcPreviewWidget::fetchStcSecurityToken()
         }
 
         securityToken = match.captured(1);
+        remoteRenderer.setSecurityToken(securityToken);
         loadCssAndInitialize();
     });
 }
@@ -110,12 +223,17 @@ void StcPreviewWidget::loadCssAndInitialize()
 {
     // Step 3: Load and embed the main stylesheet
     QNetworkRequest req(makeUrl("/release.css"));
+    [[maybe_unused]] const auto requestStart = Tracing::Clock::now();
     QNetworkReply *reply = network.get(req);
 
     connect(reply, &QNetworkReply::finished, this, [=, this]() {
+        TRACE_ASYNC("network", "preview stylesheet request", requestStart);
         baseCss = reply->readAll();
         reply->deleteLater();
 
+        if (rendering != Rendering::Remote)
+            return;
+
         QString html = QString(R"(
             <html><head><style>%1</style></head>
             <body>
@@ -125,42 +243,38 @@ void StcPreviewWidget::loadCssAndInitialize()
             </body></html>
         )").arg(baseCss);
 
-        webView.setHtml(html, makeUrl("/"));
-
-        connect(&webView, &QWebEngineView::loadFinished, this, [this](bool ok) {
-            if (ok) {
-                isInitialized = true;
-                scheduleTextUpdate();
-
-                emit loginSucceeded();
-            } else {
-                emit loginFailed("Failed to load preview HTML into WebView.");
-            }
-        });
+        webView.setHtml(html, makeUrl("/")); // continued in onPageLoaded
     });
 }
 
 void StcPreviewWidget::updateText(const QString &text)
 {
+    HANDLER_TIMING("StcPreviewWidget::updateText");
     if (isHidden() || parentWidget()->isHidden())
     {
         return;
     }
 
-    if (!isInitialized || securityToken.isEmpty())
+    pendingText = text;
+    hasPendingUpdate = true;
+
+    if (rendering == Rendering::Remote && (!isInitialized || securityToken.isEmpty()))
     {
         emit loginFailed("Preview not ready. Not authenticated or initialized.");
         return;
     }
 
-    pendingText = text;
-    hasPendingUpdate = true;
+    if (rendering == Rendering::Remote) // edits made before the delay passes are sent in one request
+    {
+        debounceTimer.start(debounce.onEdit(PreviewTransport::AdaptiveDebounce::Clock::now()));
+        return;
+    }
     scheduleTextUpdate();
 }
 
 void StcPreviewWidget::scheduleTextUpdate()
 {
-    if (requestInProgress)
+    if (!isInitialized || requestInProgress) // the pending text is shown when the page is loaded or the current update finished
     {
         return;
     }
@@ -173,53 +287,102 @@ void StcPreviewWidget::scheduleTextUpdate()
     hasPendingUpdate = false;
     requestInProgress = true;
     lastSentText = pendingText;
-    sendTextRequest(pendingText);
+    debounceTimer.stop();
+    debounce.onSent();
+    if (rendering == Rendering::Local)
+        renderLocally(pendingText);
+    else
+        remoteRenderer.render(pendingText);
 }
 
-void StcPreviewWidget::sendTextRequest(const QString &text)
+void StcPreviewWidget::renderLocally(const QString &text)
 {
-    QUrlQuery postData;
-    postData.addQueryItem("stc", text);
-    postData.addQueryItem("ajax", "ddt");
-    postData.addQueryItem("SecurityToken", securityToken);
+    TRACE_SCOPE("preview", "StcPreviewWidget::renderLocally");
+    QElapsedTimer timer;
+    timer.start();
+
+    // only sections changed since the previous text are rendered and replaced in the page
+    const StcHtmlRenderer::IncrementalRenderer::Patch patch = incrementalRenderer.update(text.toStdString());
+    stats.localRenderCount++;
+    stats.lastLocalRenderMicroseconds = timer.nsecsElapsed() / 1000;
+    stats.lastRenderedSections = static_cast<int>(patch.inserted.size());
+    stats.sectionsCount = static_cast<int>(incrementalRenderer.sectionsCount());
+
+    // the next text is rendered when the page applied the patch, so fast typing does not queue scripts
+    const auto onPatched = [this, timer]() {
+        stats.latencies.record(std::chrono::microseconds(timer.nsecsElapsed() / 1000));
+        requestInProgress = false;
+        if (hasPendingUpdate && pendingText != lastSentText)
+        {
+            scheduleTextUpdate();
+        }
+    };
 
-    QNetworkRequest req(makeUrl("/stc/"));
-    req.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
-    QByteArray payload = postData.toString(QUrl::FullyEncoded).toUtf8();
+    if (patch.isEmpty())
+    {
+        onPatched();
+        return;
+    }
 
-    stats.bytesSent += payload.size();
-    stats.requestCount++;
+    QJsonArray removedIds;
+    for (const auto id : patch.removedIds)
+        removedIds.append(sectionElementId(id));
 
-    QNetworkReply *reply = network.post(req, payload);
+    QJsonArray insertedSections;
+    for (const auto& [id, html] : patch.inserted)
+        insertedSections.append(QJsonArray{ sectionElementId(id), QString::fromStdString(html) });
 
-    connect(reply, &QNetworkReply::finished, this, [=, this]() {
-        requestInProgress = false;
+    const QString insertAfter = patch.insertAfterId ? QString("\"%1\"").arg(sectionElementId(patch.insertAfterId)) : QString("null");
+    const QString js = QString("applyPatch(%1, %2, %3);")
+        .arg(QString::fromUtf8(QJsonDocument(removedIds).toJson(QJsonDocument::Compact)),
+             insertAfter,
+             QString::fromUtf8(QJsonDocument(insertedSections).toJson(QJsonDocument::Compact)));
 
-        QByteArray response = reply->readAll();
-        stats.bytesReceived += response.size();
+    webView.page()->runJavaScript(js, [onPatched](const QVariant &) { onPatched(); });
 
-        reply->deleteLater();
+    if (isSignalConnected(QMetaMethod::fromSignal(&StcPreviewWidget::htmlReady)))
+        emit htmlReady(QString::fromStdString(incrementalRenderer.html()));
+}
 
-        QJsonDocument doc = QJsonDocument::fromJson(response);
-        QString html = doc["html"].toString();
+void StcPreviewWidget::showHtml(const QString &html)
+{
+    QString js = QString(R"(
+        (function() {
+            let container = document.getElementById("Preview");
+            if (container) {
+                container.innerHTML = '%1';
+            }
+        })();
+    )").arg(escapeHtmlToJsString(html).replace("$", "\\$"));
 
-        QString js = QString(R"(
-            (function() {
-                let container = document.getElementById("Preview");
-                if (container) {
-                    container.innerHTML = '%1';
-                }
-            })();
-        )").arg(escapeHtmlToJsString(html).replace("$", "\\$"));
+    webView.page()->runJavaScript(js);
+    emit htmlReady(html);
+}
 
-        webView.page()->runJavaScript(js);
-        emit htmlReady(html);
+void StcPreviewWidget::onRemoteRendered(const QString &html, std::chrono::microseconds latency)
+{
+    requestInProgress = false;
+    stats.remote = remoteRenderer.getStats();
+    stats.latencies.record(latency);
+    debounce.addLatency(std::chrono::duration_cast<std::chrono::milliseconds>(latency));
 
-        if (hasPendingUpdate && pendingText != lastSentText)
-        {
-            scheduleTextUpdate();
-        }
-    });
+    showHtml(html);
+
+    if (hasPendingUpdate && pendingText != lastSentText)
+    {
+        scheduleTextUpdate();
+    }
+}
+
+void StcPreviewWidget::onRemoteRenderingFailed(const QString &reason)
+{
+    qWarning() << "STC preview rendering failed:" << reason;
+    requestInProgress = false;
+    stats.remote = remoteRenderer.getStats();
+
+    // the last rendered HTML stays, the text is sent again with the next edit
+    lastSentText.clear();
+    hasPendingUpdate = true;
 }
 
 QString StcPreviewWidget::escapeHtmlToJsString(const QString &html)
@@ -232,10 +395,25 @@ QString StcPreviewWidget::escapeHtmlToJsString(const QString &html)
 
 void StcPreviewWidget::updateStatsLabel()
 {
-    QString text = QString("Requests: %1 | Sent: %2 | Received: %3")
-        .arg(stats.requestCount)
-        .arg(humanReadableBytes(stats.bytesSent))
-        .arg(humanReadableBytes(stats.bytesReceived));
+    QString text = rendering == Rendering::Local
+        ? QString("Rendered locally: %1 times | Last render: %2 ms, %3 of %4 sections")
+            .arg(stats.localRenderCount)
+            .arg(stats.lastLocalRenderMicroseconds / 1000.0, 0, 'f', 1)
+            .arg(stats.lastRenderedSections)
+            .arg(stats.sectionsCount)
+        : QString("Requests: %1 (%2 as deltas) | Sent: %3 (%4 before compression) | Received: %5")
+            .arg(stats.remote.requestCount)
+            .arg(stats.remote.deltaRequestCount)
+            .arg(humanReadableBytes(stats.remote.bytesSent))
+            .arg(humanReadableBytes(stats.remote.bytesBeforeCompression))
+            .arg(humanReadableBytes(stats.remote.bytesReceived));
+
+    if (stats.latencies.count() > 0)
+    {
+        text += QString(" | Latency p50: %1 ms, p95: %2 ms")
+            .arg(stats.latencies.percentile(0.5).count() / 1000.0, 0, 'f', 1)
+            .arg(stats.latencies.percentile(0.95).count() / 1000.0, 0, 'f', 1);
+    }
 
     // Show the tooltip at the top of the widget (under mouse or at fixed point)
     QPoint globalPos = mapToGlobal(QPoint(width() / 2, 0));
@@ -8,12 +8,18 @@
 #include <QJsonArray>
 #include <QUrlQuery>
 #include <QRegularExpression>
+#include "utils/StcHtmlRenderer.h"
+#include "utils/PreviewTransport.h"
+#include "utils/StcRemoteRenderer.h"
 
 /**
  * @class StcPreviewWidget
- * @brief A widget that provides real-time HTML preview rendering for STC-formatted (Smart Text Converter) text using cpp0x.pl backend.
+ * @brief A widget that provides real-time HTML preview rendering for STC-formatted (Smart Text Converter) text.
  *
- * This widget allows a client application to:
+ * By default the text is rendered locally by `StcHtmlRenderer`, which takes milliseconds and needs no account.
+ * The rendering by cpp0x.pl backend (`Rendering::Remote`) shows exactly what the site would show.
+ *
+ * In the remote mode this widget allows a client application to:
  * - Authenticate with the cpp0x.pl service
  * - Send user-provided text with STC tags to the cpp0x.pl/STC endpoint
  * - Retrieve and display the resulting HTML in a QWebEngineView
@@ -26,6 +32,14 @@
  * ### Efficiency:
  * Text updates are debounced: if multiple updates are queued during an active request,
  * only the latest pending text will be sent once the current request finishes.
+ * In the remote mode edits are also coalesced for a delay adapted to the latency of the server
+ * (see `PreviewTransport::AdaptiveDebounce`). When the server announces it in its replies, requests are compressed
+ * (`Accept-Encoding: deflate`, RFC 7694) and carry only a delta against the text the server acknowledged
+ * (`X-Stc-Delta: 1`, see `StcRemoteRenderer`). When a request fails, the last rendered HTML stays in the preview.
+ * The server can be replaced by a local stand-in
+ * by the `STC_PREVIEW_SERVER` environment variable, eg. `STC_PREVIEW_SERVER=http://localhost:8080`.
+ * Rendered locally the content is kept in sections (see `StcHtmlRenderer::IncrementalRenderer`),
+ * only the sections changed by an edit are rendered and replaced in the page by their ids.
  *
  * ### Styling:
  * On successful login and token retrieval, the CSS used by cpp0x.pl is fetched
@@ -33,6 +47,7 @@
  *
  * ### Statistics:
  * For debugging or diagnostics, you can access request statistics via `getStats()`.
+ * They include a histogram of latencies from sending the text until it is shown, its p50/p95 are shown in the tooltip.
  *
  * ### Disclaimer and Permission:
  * The use of the cpp0x.pl server for rendering is based on direct permission from the user `pekfos`,
@@ -41,9 +56,9 @@
  * > "Co za różnica jakiej używasz \"przeglądarki\". Po prostu wysyłaj rozsądną ilość requestów."
  *
  * ### Notes:
- * - If the user is not logged in or the preview has not been initialized, calling `updateText` will throw.
+ * - In the remote mode, if the user is not logged in, calling `updateText` emits `loginFailed`.
  * - This widget is designed to be embedded in applications like editors or documentation tools.
- * - It requires an active internet connection.
+ * - The remote mode requires an active internet connection.
  */
 class StcPreviewWidget : public QWidget
 {
@@ -52,13 +67,31 @@ class StcPreviewWidget : public QWidget
 public:
     struct Stats
     {
-        int requestCount = 0;
-        qint64 bytesSent = 0;
-        qint64 bytesReceived = 0;
+        StcRemoteRenderer::Stats remote;
+
+        int localRenderCount = 0;
+        qint64 lastLocalRenderMicroseconds = 0;
+        int lastRenderedSections = 0;
+        int sectionsCount = 0;
+
+        PreviewTransport::LatencyHistogram latencies; // of the current rendering
+    };
+
+    enum class Rendering
+    {
+        Local,  // by StcHtmlRenderer, without network
+        Remote  // by cpp0x.pl, requires login
     };
 
     explicit StcPreviewWidget(QWidget *parent = nullptr);
 
+    /// The preview is shown again after the page for the rendering is loaded
+    void setRendering(Rendering newRendering);
+    Rendering getRendering() const
+    {
+        return rendering;
+    }
+
     void login(const QString &username, const QString &password);
     void updateText(const QString &text);
 
@@ -82,7 +115,13 @@ protected:
     void updateStatsLabel();
     void fetchStcSecurityToken();
     void loadCssAndInitialize();
-    void sendTextRequest(const QString &text);
+    void loadLocalPage();
+    void onPageLoaded(bool ok);
+    void onRemoteRendered(const QString &html, std::chrono::microseconds latency);
+    void onRemoteRenderingFailed(const QString &reason);
+    void renderLocally(const QString &text);
+    /// Replaces the whole content of the preview container
+    void showHtml(const QString &html);
     void scheduleTextUpdate();
     QString escapeHtmlToJsString(const QString &html);
 
@@ -95,15 +134,21 @@ protected:
     }
 
 private:
-    const QUrl baseUrl{"https://cpp0x.pl"};
+    QUrl baseUrl{"https://cpp0x.pl"};
 
     QWebEngineView webView;
     QNetworkAccessManager network;
+    StcRemoteRenderer remoteRenderer{ network };
     QString securityToken;
     QString baseCss;
 
+    Rendering rendering = Rendering::Local;
+    StcHtmlRenderer::IncrementalRenderer incrementalRenderer; // sections shown by the local page
+
     QString pendingText;
     QString lastSentText;
+    PreviewTransport::AdaptiveDebounce debounce;
+    QTimer debounceTimer;
     bool requestInProgress = false;
     bool isInitialized = false;
     bool hasPendingUpdate = false;
@@ -1,13 +1,15 @@
 #include <QTableWidget>
 #include <QMap>
-#include <QRegularExpression>
 #include <QShowEvent>
 #include <QTextCursor>
 #include <QTextBlock>
 #include <QHeaderView>
 #include <QTimer>
 #include "CodeEditor.h"
+#include "utils/StcDocumentModel.h"
 #include "TodosTrackerTableWidget.h"
+#include "utils/HandlerTimings.h"
+#include "utils/Tracing.h"
 
 
 namespace
@@ -41,7 +43,7 @@ void TodoTrackerTableWidget::setTextEditor(CodeEditor *newEditor)
 {
     if (textEditor)
     {
-        disconnect(textEditor->document(), &QTextDocument::contentsChange, this, &TodoTrackerTableWidget::onLineContentChanged);
+        disconnect(textEditor->getStcDocumentModel(), &StcDocumentModel::contentsChange, this, &TodoTrackerTableWidget::onLineContentChanged);
 
         disconnect(this, &TodoTrackerTableWidget::goToLineAndOffsetRequested, textEditor, &CodeEditor::goToLineAndOffset);
         disconnect(this, &TodoTrackerTableWidget::goToLineRequested, textEditor, &CodeEditor::go2LineRequested);
@@ -51,7 +53,7 @@ void TodoTrackerTableWidget::setTextEditor(CodeEditor *newEditor)
 
     if (textEditor)
     {
-        connect(textEditor->document(), &QTextDocument::contentsChange, this, &TodoTrackerTableWidget::onLineContentChanged);
+        connect(textEditor->getStcDocumentModel(), &StcDocumentModel::contentsChange, this, &TodoTrackerTableWidget::onLineContentChanged);
 
         connect(this, &TodoTrackerTableWidget::goToLineAndOffsetRequested, textEditor, &CodeEditor::goToLineAndOffset);
         connect(this, &TodoTrackerTableWidget::goToLineRequested, textEditor, &CodeEditor::go2LineRequested);
@@ -62,48 +64,46 @@ void TodoTrackerTableWidget::setTextEditor(CodeEditor *newEditor)
 
 void TodoTrackerTableWidget::onLineContentChanged(int position, int charsRemoved, int charsAdded)
 {
+    HANDLER_TIMING("TodoTrackerTableWidget::onLineContentChanged");
+    Q_UNUSED(charsRemoved);
+
     if (!textEditor)
         return;
 
-    QTextCursor cursor(textEditor->document());
-    cursor.setPosition(position);
+    const QTextDocument* doc = textEditor->document();
+    const StcDocumentModel* model = textEditor->getStcDocumentModel();
 
-    QTextBlock block = cursor.block();
-    const QString lineText = block.text();
+    const QTextBlock firstBlock = doc->findBlock(position);
+    QTextBlock lastBlock = doc->findBlock(position + charsAdded);
+    if (!lastBlock.isValid())
+        lastBlock = doc->lastBlock();
 
-    // update existing TODO or remove it
-    QRegularExpressionMatch match = todoRegex.match(lineText);
-    auto it = std::find_if(todoList.begin(), todoList.end(),
-                           [&block](const TodoInfo& info) {
-                               return info.cursor.block() == block;
-                           });
+    // TODOs of the changed lines (also of the removed ones, their cursors were moved into the changed range) are taken again from the model
+    const int firstLine = firstBlock.blockNumber();
+    const int lastLine = lastBlock.blockNumber();
+    todoList.erase(std::remove_if(todoList.begin(), todoList.end(), [firstLine, lastLine](const TodoInfo& info) {
+                       const int line = info.cursor.blockNumber();
+                       return line >= firstLine && line <= lastLine;
+                   }), todoList.end());
 
-    if (match.hasMatch())
+    for (QTextBlock block = firstBlock; block.isValid() && block.blockNumber() <= lastLine; block = block.next())
     {
-        QString todoText = match.captured(1).trimmed();
-        if (it != todoList.end())
-        {
-            it->text = todoText;
-            it->cursor.setPosition(block.position() + match.capturedStart());
-        }
-        else
+        if (auto todo = model->todoInBlock(block))
         {
             TodoInfo newTodo;
             newTodo.cursor = QTextCursor(block);
-            newTodo.text = todoText;
+            newTodo.cursor.setPosition(todo->position);
+            newTodo.text = todo->text;
             todoList.append(newTodo);
         }
     }
-    else if (it != todoList.end())
-    {
-        todoList.erase(it);
-    }
 
     refreshTable();
 }
 
 void TodoTrackerTableWidget::refreshTable()
 {
+    TRACE_SCOPE("panel", "TodoTrackerTableWidget::refreshTable");
     clearContents();
 
     QList<const TodoInfo*> sortedTodos = sortedTagsCopy(todoList);
@@ -134,21 +134,16 @@ void TodoTrackerTableWidget::showEvent(QShowEvent *event)
 
 void TodoTrackerTableWidget::scanEntireDocumentDetectingAllTodos()
 {
+    TRACE_SCOPE("panel", "TodoTrackerTableWidget::scanEntireDocumentDetectingAllTodos");
     todoList.clear();
 
-    QTextDocument* doc = textEditor->document();
-    for (QTextBlock block = doc->begin(); block != doc->end(); block = block.next())
+    for (const auto& todo : textEditor->getStcDocumentModel()->todos())
     {
-        QString lineText = block.text();
-        QRegularExpressionMatch match = todoRegex.match(lineText);
-        if (match.hasMatch())
-        {
-            TodoInfo info;
-            info.cursor = QTextCursor(block);
-            info.cursor.setPosition(block.position() + match.capturedStart());
-            info.text = match.captured(1).trimmed();
-            todoList.append(info);
-        }
+        TodoInfo info;
+        info.cursor = QTextCursor(textEditor->document());
+        info.cursor.setPosition(todo.position);
+        info.text = todo.text;
+        todoList.append(info);
     }
 
     refreshTable();    
@@ -48,6 +48,4 @@ private:
 private:
     CodeEditor* textEditor = nullptr;
     QList<TodoInfo> todoList;
-
-    static inline const QRegularExpression todoRegex{R"(\bTODO\b[:]? *(.*))", QRegularExpression::CaseInsensitiveOption};
 };